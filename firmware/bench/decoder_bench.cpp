@@ -0,0 +1,185 @@
+/* ============================================================================
+ * Decoder Conformance and Throughput Bench
+ * Replaces main.cpp in the decoder_bench / native_decoder_bench builds.
+ * Every .mp3 in BENCH_CORPUS_DIR is decoded to the end on a dedicated task
+ * and, when a sibling .pcm reference exists (s16le, interleaved like the
+ * decoder output), compared sample by sample. Results are printed as one
+ * JSON object per file between BENCH_BEGIN and BENCH_END; the ISO 11172-4
+ * limits are applied by tools/decoder_bench.py, which also builds the
+ * corpus and runs the host build. The header says whether the decoder
+ * synthesises audio at all: without synthesis only the frame walk counts.
+ *
+ * Frame times include the SD reads a frame triggers: that is the cost the
+ * audio pump sees. The stack figure is the bench task's peak (decode, SD
+ * and compare; printing happens on the loop task).
+ * ========================================================================== */
+
+#include <Arduino.h>
+#include <SD.h>
+#include <cmath>
+#include <cstring>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "audio_decoder.h"
+#include "sd_card.h"
+#include "config.h"
+
+#ifndef BENCH_CORPUS_DIR
+#define BENCH_CORPUS_DIR   "/corpus"
+#endif
+#define BENCH_MAX_FILES    32
+#define BENCH_STACK_BYTES  16384
+#define BENCH_NAME_MAX     48
+
+extern SDCard* create_sd_card();
+extern AudioDecoder* create_audio_decoder();
+
+struct BenchResult {
+    char name[BENCH_NAME_MAX];
+    DecoderStats stats;
+    uint32_t samples;
+    uint32_t audio_ms;
+    uint32_t duration_ms;       /* Decoder's estimate at open() */
+    uint64_t decode_us;
+    uint32_t worst_us;
+    uint32_t worst_frame;
+    uint32_t stack_peak;        /* Bench task, cumulative over the corpus */
+    
+    bool has_reference;
+    uint32_t ref_samples;
+    uint32_t compared;
+    double sum_sq;
+    uint32_t max_abs;
+};
+
+static BenchResult results[BENCH_MAX_FILES];
+static uint8_t result_count = 0;
+static TaskHandle_t loop_task = nullptr;
+
+static int16_t pcm[AUDIO_PCM_FRAME_SAMPLES];
+static int16_t ref[AUDIO_PCM_FRAME_SAMPLES];
+
+static uint32_t elapsed_us(uint32_t start_cycles) {
+    return (ESP.getCycleCount() - start_cycles) / getCpuFrequencyMhz();
+}
+
+static void compare(BenchResult& r, File& reference, int samples) {
+    int n = reference ? reference.read((uint8_t*)ref, samples * sizeof(int16_t)) / (int)sizeof(int16_t) : 0;
+    for (int i = 0; i < n; i++) {
+        int32_t diff = (int32_t)pcm[i] - ref[i];
+        uint32_t mag = (uint32_t)(diff < 0 ? -diff : diff);
+        r.sum_sq += (double)diff * diff;
+        if (mag > r.max_abs) r.max_abs = mag;
+    }
+    r.compared += (uint32_t)(n > 0 ? n : 0);
+}
+
+static void bench_file(const char* path, const char* name) {
+    BenchResult& r = results[result_count++];
+    memset(&r, 0, sizeof(r));
+    snprintf(r.name, sizeof(r.name), "%s", name);
+    
+    /* Reference: same name, .pcm */
+    char ref_path[PLAYLIST_PATH_MAX];
+    snprintf(ref_path, sizeof(ref_path), "%s", path);
+    strcpy(ref_path + strlen(ref_path) - 4, ".pcm");
+    File reference = SD.open(ref_path, FILE_READ);
+    r.has_reference = (bool)reference;
+    r.ref_samples = r.has_reference ? (uint32_t)(reference.size() / sizeof(int16_t)) : 0;
+    
+    AudioDecoder* decoder = create_audio_decoder();
+    decoder->open(path);
+    r.duration_ms = decoder->get_duration_ms();
+    
+    uint32_t frame = 0;
+    while (true) {
+        uint32_t start = ESP.getCycleCount();
+        int samples = decoder->decode_frame(pcm, AUDIO_PCM_FRAME_SAMPLES);
+        uint32_t us = elapsed_us(start);
+        if (samples <= 0) break;
+        
+        r.decode_us += us;
+        if (us > r.worst_us) {
+            r.worst_us = us;
+            r.worst_frame = frame;
+        }
+        r.samples += (uint32_t)samples;
+        frame++;
+        
+        if (r.has_reference) compare(r, reference, samples);
+    }
+    
+    r.audio_ms = decoder->get_current_position_ms();
+    decoder->get_stats(r.stats);
+    decoder->close();
+    if (reference) reference.close();
+    r.stack_peak = BENCH_STACK_BYTES - (uint32_t)uxTaskGetStackHighWaterMark(nullptr);
+}
+
+static void bench_task(void* arg) {
+    File dir = SD.open(BENCH_CORPUS_DIR);
+    while (dir && result_count < BENCH_MAX_FILES) {
+        File entry = dir.openNextFile();
+        if (!entry) break;
+        
+        char name[BENCH_NAME_MAX];
+        snprintf(name, sizeof(name), "%s", entry.name());
+        bool is_mp3 = !entry.isDirectory() && strlen(name) > 4 &&
+                      strcasecmp(name + strlen(name) - 4, ".mp3") == 0;
+        entry.close();
+        if (!is_mp3) continue;
+        
+        char path[PLAYLIST_PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", BENCH_CORPUS_DIR, name);
+        bench_file(path, name);
+    }
+    if (dir) dir.close();
+    
+    xTaskNotifyGive(loop_task);
+    vTaskDelete(nullptr);
+}
+
+static void print_result(const BenchResult& r) {
+    double fps = r.decode_us ? r.stats.frames * 1e6 / (double)r.decode_us : 0.0;
+    Serial.printf("{\"file\":\"%s\",\"frames\":%u,\"samples\":%u,\"audio_ms\":%u,\"duration_ms\":%u,"
+                  "\"resyncs\":%u,\"skipped_bytes\":%u,\"decode_us\":%u,\"frames_per_s\":%.1f,"
+                  "\"avg_frame_us\":%.1f,\"worst_frame_us\":%u,\"worst_frame\":%u,\"stack_peak_bytes\":%u",
+                  r.name, (unsigned)r.stats.frames, (unsigned)r.samples, (unsigned)r.audio_ms,
+                  (unsigned)r.duration_ms, (unsigned)r.stats.resyncs, (unsigned)r.stats.skipped_bytes,
+                  (unsigned)r.decode_us, fps, r.stats.frames ? r.decode_us / (double)r.stats.frames : 0.0,
+                  (unsigned)r.worst_us, (unsigned)r.worst_frame, (unsigned)r.stack_peak);
+    if (r.has_reference) {
+        double rms = r.compared ? sqrt(r.sum_sq / r.compared) : 0.0;
+        Serial.printf(",\"ref_samples\":%u,\"compared\":%u,\"rms_lsb\":%.4f,\"max_abs_lsb\":%u}\n",
+                      (unsigned)r.ref_samples, (unsigned)r.compared, rms, (unsigned)r.max_abs);
+    } else {
+        Serial.printf(",\"ref_samples\":null}\n");
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+    
+    SDCard* sd = create_sd_card();
+    if (!sd->init()) {
+        Serial.println("BENCH_BEGIN\nBENCH_ERROR no SD card\nBENCH_END");
+        return;
+    }
+    
+    loop_task = xTaskGetCurrentTaskHandle();
+    xTaskCreate(bench_task, "bench", BENCH_STACK_BYTES, nullptr, TASK_PRIORITY_AUDIO_DECODE, nullptr);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    
+    Serial.println("BENCH_BEGIN");
+    Serial.printf("{\"cpu_mhz\":%u,\"stack_budget_bytes\":%u,\"files\":%u,\"synthesis\":%s}\n",
+                  (unsigned)getCpuFrequencyMhz(), (unsigned)BENCH_STACK_BYTES, (unsigned)result_count,
+                  create_audio_decoder()->has_synthesis() ? "true" : "false");
+    for (uint8_t i = 0; i < result_count; i++) {
+        print_result(results[i]);
+    }
+    Serial.println("BENCH_END");
+}
+
+void loop() {
+    delay(1000);
+}
@@ -0,0 +1,87 @@
+/* ============================================================================
+ * Equalizer Bench
+ * Replaces main.cpp in the eq_bench / native_eq_bench builds. Times
+ * process() per decoded frame with 0..EQ_BANDS bands active, against the
+ * frame's play time and EQ_CPU_BUDGET_PCT, printed as one JSON object per
+ * line between BENCH_BEGIN and BENCH_END (summarised by tools/eq_bench.py).
+ * Response, preset and glide correctness are host tests (test_equalizer).
+ *
+ * Everything runs on the loop task; the equalizer touches no peripherals.
+ * ========================================================================== */
+
+#include <Arduino.h>
+#include <cstring>
+#include "equalizer.h"
+#include "config.h"
+
+#define BENCH_COST_FRAMES     200      // Timed process() calls per band count
+
+static const uint32_t FRAME_SAMPLES = AUDIO_PCM_FRAME_SAMPLES;
+static const uint32_t FRAME_FRAMES = AUDIO_PCM_FRAME_SAMPLES / AUDIO_CHANNELS;
+
+static int16_t source[AUDIO_PCM_FRAME_SAMPLES];
+static int16_t work[AUDIO_PCM_FRAME_SAMPLES];
+static bool all_ok = true;
+
+/* ============================================================================
+ * Cost
+ * ========================================================================== */
+
+static void bench_cost(Equalizer* eq, float frame_us) {
+    uint32_t seed = 0x5EED;
+    for (uint32_t i = 0; i < FRAME_SAMPLES; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        source[i] = (int16_t)((int32_t)(seed >> 16) / 4 - 8192);  /* -12 dBFS noise */
+    }
+    
+    for (uint8_t active = 0; active <= EQ_BANDS; active++) {
+        /* Cuts only: no headroom gain, so exactly `active` filters run */
+        eq->select_preset(0);
+        for (uint8_t b = 0; b < active; b++) {
+            EqBand band = eq->get_band(b);
+            band.gain_db10 = -30;
+            eq->set_band(b, band);
+        }
+        for (uint8_t i = 0; i < 4; i++) {
+            memcpy(work, source, sizeof(work));
+            eq->process(work, FRAME_SAMPLES);       /* Finish the glide */
+        }
+        
+        double total_us = 0;
+        float worst_us = 0;
+        for (uint32_t i = 0; i < BENCH_COST_FRAMES; i++) {
+            memcpy(work, source, sizeof(work));
+            uint32_t start = ESP.getCycleCount();
+            eq->process(work, FRAME_SAMPLES);
+            float us = (ESP.getCycleCount() - start) / (float)getCpuFrequencyMhz();
+            total_us += us;
+            if (us > worst_us) worst_us = us;
+        }
+        float avg_us = (float)(total_us / BENCH_COST_FRAMES);
+        Serial.printf("{\"kind\":\"cost\",\"bands\":%u,\"active\":%u,\"avg_us\":%.2f,\"worst_us\":%.2f,\"load_pct\":%.3f}\n",
+                      (unsigned)active, (unsigned)eq->get_active_bands(), avg_us, worst_us,
+                      100.0f * worst_us / frame_us);
+        if (active == EQ_BANDS && 100.0f * worst_us / frame_us > EQ_CPU_BUDGET_PCT) all_ok = false;
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+    
+    Equalizer* eq = create_equalizer();
+    eq->init();
+    float frame_us = 1e6f * FRAME_FRAMES / AUDIO_SAMPLE_RATE;
+    
+    Serial.println("BENCH_BEGIN");
+    Serial.printf("{\"cpu_mhz\":%u,\"sample_rate\":%u,\"bands\":%u,\"block_frames\":%u,\"ramp_ms\":%u,"
+                  "\"frame_us\":%.1f,\"budget_pct\":%u}\n",
+                  (unsigned)getCpuFrequencyMhz(), (unsigned)AUDIO_SAMPLE_RATE, (unsigned)EQ_BANDS,
+                  (unsigned)EQ_BLOCK_FRAMES, (unsigned)EQ_RAMP_MS, frame_us, (unsigned)EQ_CPU_BUDGET_PCT);
+    bench_cost(eq, frame_us);
+    Serial.printf("{\"kind\":\"verdict\",\"ok\":%s}\n", all_ok ? "true" : "false");
+    Serial.println("BENCH_END");
+}
+
+void loop() {
+    delay(1000);
+}
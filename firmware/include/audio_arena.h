@@ -0,0 +1,47 @@
+#ifndef AUDIO_ARENA_H
+#define AUDIO_ARENA_H
+
+#include <cstdint>
+#include <cstddef>
+#include "config.h"
+
+/* ============================================================================
+ * Audio Memory Arena
+ * Every audio buffer is a slice of one statically reserved block with a
+ * fixed, typed layout: nothing audio-sized comes from the heap, the budget
+ * is checked by the compiler, and the map is printed at build time
+ * (tools/arena_map.py). Slices start on AUDIO_ARENA_ALIGN boundaries and
+ * live in internal DRAM, so any of them can be handed to a DMA engine.
+ *
+ * Adding a buffer: one line in AUDIO_ARENA_SLICES, then take it from
+ * audio_arena() in the owning module.
+ * ========================================================================== */
+
+/* X(name, element type, element count) */
+#define AUDIO_ARENA_SLICES(X) \
+    X(bt_ring,       int16_t, AUDIO_RING_BUFFER_SIZE / sizeof(int16_t))  /* A2DP PCM ring */ \
+    X(decoder_input, uint8_t, MP3_INPUT_BUFFER_SIZE)                     /* MP3 read window */ \
+    X(pump_frame,    int16_t, AUDIO_PCM_FRAME_SAMPLES)                   /* Frame awaiting the sink */
+
+struct AudioArena {
+#define AUDIO_ARENA_FIELD(name, type, count) alignas(AUDIO_ARENA_ALIGN) type name[count];
+    AUDIO_ARENA_SLICES(AUDIO_ARENA_FIELD)
+#undef AUDIO_ARENA_FIELD
+};
+
+/* The one arena; valid from static initialisation on */
+AudioArena& audio_arena();
+
+/* Budget checks: an overrun fails the build, not the heap at runtime */
+static_assert(sizeof(AudioArena) <= AUDIO_ARENA_BUDGET,
+              "Audio arena exceeds AUDIO_ARENA_BUDGET");
+static_assert(sizeof(AudioArena) - sizeof(AudioArena::bt_ring) <= AUDIO_ARENA_WORK_BUDGET,
+              "Audio working buffers exceed AUDIO_ARENA_WORK_BUDGET");
+
+#define AUDIO_ARENA_CHECK_SLICE(name, type, count) \
+    static_assert(sizeof(AudioArena::name) % AUDIO_ARENA_ALIGN == 0, \
+                  "Audio arena slice " #name " is not a whole number of DMA words");
+AUDIO_ARENA_SLICES(AUDIO_ARENA_CHECK_SLICE)
+#undef AUDIO_ARENA_CHECK_SLICE
+
+#endif  // AUDIO_ARENA_H
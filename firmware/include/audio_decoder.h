@@ -9,6 +9,13 @@
  * Abstracts MP3 decoding; implementations decode frames to PCM
  * ========================================================================== */
 
+/* Bitstream counters since open() */
+struct DecoderStats {
+    uint32_t frames;         /* Frames decoded */
+    uint32_t resyncs;        /* Damaged regions skipped */
+    uint32_t skipped_bytes;  /* Bytes skipped to get back in sync */
+};
+
 class AudioDecoder {
 public:
     virtual ~AudioDecoder() = default;
@@ -31,6 +38,22 @@ public:
     /* Seek to position (optional; default no-op) */
     virtual bool seek(uint32_t position_ms) { return false; }
     
+    /* Byte offset of the next frame to decode (for resume) */
+    virtual uint32_t get_byte_offset() const { return 0; }
+    
+    /* Resume at a known frame boundary (no scanning; optional) */
+    virtual bool resume_at(uint32_t byte_offset, uint32_t position_ms) { return false; }
+    
+    /* Stream sample rate in Hz, 0 until known (optional) */
+    virtual uint32_t get_sample_rate() const { return 0; }
+    
+    /* Bitstream counters (optional) */
+    virtual bool get_stats(DecoderStats& out) const { return false; }
+    
+    /* True when decode_frame() outputs audio, false when frames are only
+     * walked and the PCM is silence (conformance cannot be graded) */
+    virtual bool has_synthesis() const { return false; }
+    
     /* Error status / diagnostics */
     virtual const char* get_error_message() const = 0;
 };
@@ -24,6 +24,9 @@ public:
     /* Feed PCM samples to Bluetooth encoder (SBC) */
     virtual bool feed_audio(const int16_t* pcm, uint16_t sample_count) = 0;
     
+    /* Drop queued audio so a skip or seek is heard at once (optional) */
+    virtual void flush() {}
+    
     /* Check connection status */
     virtual bool is_connected() const = 0;
     
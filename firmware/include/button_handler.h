@@ -6,26 +6,38 @@
 
 /* ============================================================================
  * Button Handler Interface (Pure Virtual)
- * Debounced button input with event queueing
+ * GPIO ISRs only timestamp edges; a button task debounces them, recognises
+ * gestures and posts them to the event queue as EVENT_BUTTON_PREV/PLAY/NEXT
+ * with the gesture in Event::param
  * ========================================================================== */
 
-enum ButtonEvent {
-    BUTTON_RELEASED = 0,
-    BUTTON_PRESSED = 1,
+enum ButtonGesture {
+    GESTURE_SHORT = 1,     /* Press + release under BTN_LONG_PRESS_MS */
+    GESTURE_DOUBLE,        /* Second press within BTN_DOUBLE_PRESS_MS (PLAY only) */
+    GESTURE_LONG,          /* Held for BTN_LONG_PRESS_MS */
+    GESTURE_REPEAT,        /* Every BTN_REPEAT_MS while still held after LONG */
+    GESTURE_HOLD_END,      /* Released after LONG */
+};
+
+/* Capture and recognition counters */
+struct ButtonStats {
+    uint32_t edges;            /* Edges captured by the ISRs */
+    uint32_t edges_dropped;    /* Edges lost to a full capture ring */
+    uint32_t gestures;         /* Gestures posted */
+    uint32_t last_latency_us;  /* Deciding edge (or deadline) → event posted; the
+                                * edge-to-action latency is LatencyMonitor's */
+    uint32_t max_latency_us;
 };
 
 class ButtonHandler {
 public:
     virtual ~ButtonHandler() = default;
     
-    /* Initialize GPIO pins and ISRs */
+    /* Initialize GPIO pins, ISRs and the button task */
     virtual bool init() = 0;
     
-    /* Get next button event (non-blocking) */
-    virtual bool get_event(uint8_t& button_id, ButtonEvent& event) = 0;
-    
-    /* Check pending event count */
-    virtual size_t pending_count() const = 0;
+    /* Capture/latency counters */
+    virtual const ButtonStats& get_stats() const = 0;
 };
 
 #endif  // BUTTON_HANDLER_H
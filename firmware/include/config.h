@@ -27,6 +27,8 @@
 
 /* SSD1306 I2C Address */
 #define SSD1306_I2C_ADDR 0x3C
+#define SSD1306_PROBE_ATTEMPTS  5   // Address probes at init before giving up
+#define SSD1306_PROBE_RETRY_MS  10  // Between probes (panel supply still rising)
 
 /* ============================================================================
  * GPIO Button Configuration (Pull-up, active-low)
@@ -36,6 +38,10 @@
 #define BTN_NEXT_PIN    14   // GPIO 14 – Next track button
 
 #define BTN_DEBOUNCE_MS 20   // Debounce window (milliseconds)
+#define BTN_LONG_PRESS_MS   600  // Hold time for a long press
+#define BTN_DOUBLE_PRESS_MS 250  // Max release→press gap for a double press
+#define BTN_REPEAT_MS       150  // Repeat period while held past a long press
+#define BTN_CAPTURE_RING    32   // ISR edge ring (power of 2)
 
 /* ============================================================================
  * Audio Buffer Configuration
@@ -48,10 +54,33 @@
 /* Derived: bytes per second */
 #define AUDIO_BYTES_PER_SEC (AUDIO_SAMPLE_RATE * AUDIO_CHANNELS * AUDIO_BITS_PER_SAMPLE / 8)
 
+/* Level meter tap: block length and decimation for band energies */
+#define LEVEL_METER_BLOCK_FRAMES  1024   // ~23 ms @ 44.1 kHz per published snapshot
+#define LEVEL_METER_DECIMATION    4      // Band filters run at 11.025 kHz
+
+/* Playback pump: decoded audio is kept this far ahead of the play position.
+ * Must exceed the main loop period (1000 / DISPLAY_REFRESH_HZ) */
+#define AUDIO_PUMP_LEAD_MS      200
+#define AUDIO_PCM_FRAME_SAMPLES (1152 * AUDIO_CHANNELS)  // One MPEG-1 Layer III frame, interleaved
+
 /* MP3 Decoder Frame Size (typical) */
 #define MP3_MAX_FRAME_SIZE      2048    // Bytes (1.4–1.8 KB typical, max ~2 KB)
 #define MP3_INPUT_BUFFER_SIZE   (2 * MP3_MAX_FRAME_SIZE)
 
+/* Audio arena (audio_arena.h): every audio buffer in one static block.
+ * Budget = the planned 64 KB ring + 20 KB of decoder/pump working state */
+#define AUDIO_ARENA_ALIGN       4            // Slice alignment (DMA needs word-aligned buffers)
+#define AUDIO_ARENA_BUDGET      (84 * 1024)  // Whole arena, bytes of internal DRAM
+#define AUDIO_ARENA_WORK_BUDGET (20 * 1024)  // Everything except the ring
+
+/* Equalizer (equalizer.h): settings glide over EQ_RAMP_MS, one coefficient
+ * step per block of EQ_BLOCK_FRAMES */
+#define EQ_RAMP_MS              20
+#define EQ_BLOCK_FRAMES         32
+#define EQ_DEFAULT_PRESET       0      // Flat
+#define EQ_CPU_BUDGET_PCT       10     // All bands, share of one frame's playback time
+#define EQ_PRESET_KEY           'e'    // Serial key that cycles the presets
+
 /* ============================================================================
  * OLED Display Configuration
  * ========================================================================== */
@@ -66,7 +95,45 @@
 /* ============================================================================
  * Event Queue Configuration
  * ========================================================================== */
-#define EVENT_QUEUE_SIZE 20  // Maximum pending events
+#define EVENT_QUEUE_SIZE    20  // Maximum pending events (UI lane)
+#define EVENT_QUEUE_SIZE_RT 16  // Real-time lane (buttons, playback, audio)
+#define EVENT_MAX_SUBSCRIBERS 16
+
+/* ============================================================================
+ * Playback Configuration
+ * ========================================================================== */
+#define SHUFFLE_SEED     0x5EED1234  // Shuffle permutation key (same seed → same order)
+
+/* M3U/M3U8 playlists (streamed; RAM use independent of entry count) */
+#define PLAYLIST_AUTOLOAD_PATH  "/playlist.m3u"  // Loaded at boot if present
+#define PLAYLIST_LINE_MAX       256   // Longest entry line (longer lines skipped)
+#define PLAYLIST_PATH_MAX       256   // Resolved path buffer
+#define PLAYLIST_INDEX_SLOTS    256   // Sparse offset index, 1 KB (stride doubles when full)
+
+/* A random get_entry() skips up to (stride - 1) entries past its index slot:
+ * stride is the smallest power of two with entries / stride <= SLOTS, so
+ * 10,000 entries → stride 64 → at most 63 entries (~3 KB at 48 B each).
+ * In-order access continues from the cursor and reads one entry */
+
+/* Root-directory library: count_files() records the directory position of
+ * every stride-th MP3, the same way, and get_file_path() seeks there */
+#define SD_DIR_INDEX_SLOTS      256   // Sparse directory-position index, 1 KB
+
+/* Resume journal (NVS ring). Wear, playing around the clock: a commit writes
+ * a 24-byte blob = 3 NVS entries (index, chunk header, data). The default
+ * 20 KB nvs partition rotates 5 pages × 126 entries, so a sector is erased
+ * once per ~210 commits; 100k erase cycles ≈ 21M commits ≈ 10 years at one
+ * commit per 15 s (5760/day), less whatever else writes to NVS */
+#define RESUME_NVS_NAMESPACE    "resume"
+#define RESUME_SLOTS            4       // Ring slots (newest valid wins)
+#define RESUME_SAVE_INTERVAL_MS 15000   // Batched write period while playing
+
+/* Hold-to-scan: each button repeat (BTN_REPEAT_MS) jumps one step; the step
+ * grows every SCAN_STEPS_PER_STAGE jumps (2 s → 5 s → 15 s ≈ 13x → 100x) */
+#define SCAN_STEP_1_MS          2000
+#define SCAN_STEP_2_MS          5000
+#define SCAN_STEP_3_MS          15000
+#define SCAN_STEPS_PER_STAGE    4
 
 /* ============================================================================
  * FreeRTOS Task Configuration
@@ -80,6 +147,7 @@
 #define TASK_STACK_WORDS_BUTTON         1024  // Button debounce task
 #define TASK_STACK_WORDS_PLAYBACK       2048  // Playback control task
 #define TASK_STACK_WORDS_SD             2048  // SD card task
+#define TASK_STACK_WORDS_LOG            1024  // Log drain task
 
 /* Task priorities (FreeRTOS: higher number = higher priority) */
 #define TASK_PRIORITY_AUDIO_DECODE      24    // High: must not block
@@ -88,6 +156,21 @@
 #define TASK_PRIORITY_BUTTON            20    // Medium: debounce
 #define TASK_PRIORITY_PLAYBACK_CONTROL  15    // Normal: orchestration
 #define TASK_PRIORITY_SD                10    // Low: file I/O
+#define TASK_PRIORITY_LOG               1     // Lowest: deferred log output
+
+/* ============================================================================
+ * Memory Telemetry
+ * ========================================================================== */
+#define MEM_SAMPLE_INTERVAL_MS  5000   // Heap/stack poll and RTC record reseal
+#define MEM_HEAP_WARN_BYTES     20000  // Warn when free heap drops below
+#define MEM_STACK_WARN_BYTES    512    // Warn when a stack's free margin drops below
+#define MEM_DUMP_KEY            'm'    // Serial key that prints the telemetry record
+
+/* ============================================================================
+ * Trace Ring (see trace.h, tools/trace_to_chrome.py)
+ * ========================================================================== */
+#define TRACE_RING_RECORDS      512    // Records per core (power of 2, 8 bytes each)
+#define TRACE_DUMP_KEY          't'    // Serial key that dumps the rings in binary
 
 /* ============================================================================
  * Timeouts (milliseconds)
@@ -100,11 +183,28 @@
 /* ============================================================================
  * Logging Configuration
  * ========================================================================== */
-#define LOG_LEVEL_MAIN        "INFO"
-#define LOG_LEVEL_AUDIO       "DEBUG"
-#define LOG_LEVEL_BT          "INFO"
-#define LOG_LEVEL_DISPLAY     "DEBUG"
-#define LOG_LEVEL_BUTTON      "DEBUG"
+#define LOG_LEVEL_NONE        0
+#define LOG_LEVEL_ERROR       1
+#define LOG_LEVEL_WARN        2
+#define LOG_LEVEL_INFO        3
+#define LOG_LEVEL_DEBUG       4
+
+/* Per-module level: calls below it compile out entirely (see log.h) */
+#define LOG_LEVEL_MAIN        LOG_LEVEL_INFO
+#define LOG_LEVEL_AUDIO       LOG_LEVEL_DEBUG
+#define LOG_LEVEL_BT          LOG_LEVEL_INFO
+#define LOG_LEVEL_DISPLAY     LOG_LEVEL_DEBUG
+#define LOG_LEVEL_BUTTON      LOG_LEVEL_DEBUG
+#define LOG_LEVEL_SD          LOG_LEVEL_INFO
+#define LOG_LEVEL_PLAYBACK    LOG_LEVEL_INFO
+#define LOG_LEVEL_EVENT       LOG_LEVEL_WARN
+
+#define LOG_RING_RECORDS      64    // Deferred records (power of 2, 28 bytes each)
+#define LOG_MAX_ARGS          4     // 32-bit arguments per record
+#define LOG_DRAIN_INTERVAL_MS 20    // Drain task period
+#ifndef LOG_BINARY
+#define LOG_BINARY            1     // 1: binary frames (tools/log_expand.py), 0: text on device
+#endif
 
 /* ============================================================================
  * Feature Flags (for conditional compilation)
@@ -113,6 +213,9 @@
 #define FEATURE_OLED_DISPLAY     1  // Enable OLED display
 #define FEATURE_BUTTON_CONTROLS  1  // Enable button input
 #define FEATURE_SD_CARD          1  // Enable SD card
+#ifndef FEATURE_TRACE
+#define FEATURE_TRACE            1  // Hot-path trace rings (-DFEATURE_TRACE=0 compiles them out)
+#endif
 
 #if AUDIO_RING_BUFFER_SIZE < 8192
     #error "Audio ring buffer must be >= 8 KB"
@@ -4,6 +4,16 @@
 #include <cstdint>
 #include <cstddef>
 
+/* Bus cost of the most recent completed flush (performed by the display task) */
+struct DisplayFlushStats {
+    uint32_t i2c_bytes;      /* Bytes on the wire incl. address + control bytes */
+    uint16_t transactions;   /* I2C start/stop pairs */
+    uint16_t windows;        /* Rectangular address windows streamed */
+    uint32_t bus_time_us;    /* Wall time spent in the flush */
+    uint32_t caller_block_us;  /* Time the last update()/update_full() blocked its caller */
+    uint32_t frames_merged;    /* Frames folded into a newer one (bus behind), cumulative */
+};
+
 /* ============================================================================
  * SSD1306 OLED Display Interface (Pure Virtual)
  * I2C-based display driver with framebuffer management
@@ -37,10 +47,16 @@ public:
     /* Draw text (monospace font, 5x7 pixels per character) */
     virtual void draw_text(uint8_t x, uint8_t y, const char* text, uint8_t color) = 0;
     
-    /* Display dirty-tracked partial update (optimized) */
+    /* Blit an 8-row column strip (one byte per column, bit 0 = top) at any y */
+    virtual void draw_columns(uint8_t x, uint8_t y, const uint8_t* columns, uint8_t width, uint8_t color) = 0;
+    
+    /* Blit an atlas sprite (masked: transparent pixels are left as they are) */
+    virtual void draw_sprite(uint8_t x, uint8_t y, uint8_t sprite_id) = 0;
+    
+    /* Publish frame for dirty-tracked partial update (non-blocking) */
     virtual void update() = 0;
     
-    /* Full display update (slower; use sparingly) */
+    /* Publish frame for full update (non-blocking; slower on the bus) */
     virtual void update_full() = 0;
     
     /* Set contrast (0–255) */
@@ -51,6 +67,9 @@ public:
     
     /* Wake up display */
     virtual void wake() = 0;
+    
+    /* I2C traffic of the last completed flush (a copy: the task may be mid-flush) */
+    virtual DisplayFlushStats get_flush_stats() const = 0;
 };
 
 #endif  // DISPLAY_SSD1306_H
@@ -0,0 +1,69 @@
+#ifndef EQUALIZER_H
+#define EQUALIZER_H
+
+#include <cstdint>
+#include <cstddef>
+
+/* ============================================================================
+ * Parametric Equalizer
+ * Cascade of EQ_BANDS fixed-point biquads on the interleaved stereo stream
+ * ahead of the sink: band 0 is a low shelf, the last a high shelf, the
+ * ones between are peaking filters. Settings come from named presets or
+ * per band; every change glides over EQ_RAMP_MS, so it never clicks.
+ * Configure and process from the same task (the audio pump).
+ * ========================================================================== */
+
+#define EQ_BANDS 5
+
+enum EqBandType {
+    EQ_LOW_SHELF,
+    EQ_PEAKING,
+    EQ_HIGH_SHELF
+};
+
+struct EqBand {
+    uint16_t freq_hz;   /* Centre (peaking) or midpoint (shelves) */
+    int16_t gain_db10;  /* Tenths of a dB, 0 = band off */
+    uint16_t q100;      /* Q x 100 (shelves: slope-equivalent Q) */
+};
+
+class Equalizer {
+public:
+    virtual ~Equalizer() = default;
+    
+    /* Default preset at AUDIO_SAMPLE_RATE, settled (no glide) */
+    virtual bool init() = 0;
+    
+    /* Filter interleaved stereo PCM in place (audio path; never blocks) */
+    virtual void process(int16_t* pcm, size_t sample_count) = 0;
+    
+    /* Stream rate; redesigns the bands at once (a new track, no glide) */
+    virtual void set_sample_rate(uint32_t rate_hz) = 0;
+    
+    /* Bypass; both directions glide */
+    virtual void set_enabled(bool enabled) = 0;
+    virtual bool is_enabled() const = 0;
+    
+    /* Named presets (index 0 is flat) */
+    virtual uint8_t get_preset_count() const = 0;
+    virtual const char* get_preset_name(uint8_t preset) const = 0;
+    virtual bool select_preset(uint8_t preset) = 0;
+    virtual uint8_t get_preset() const = 0;
+    
+    /* One band; the type is fixed by position */
+    virtual bool set_band(uint8_t band, const EqBand& settings) = 0;
+    virtual EqBand get_band(uint8_t band) const = 0;
+    virtual EqBandType get_band_type(uint8_t band) const = 0;
+    
+    /* Bands that currently cost CPU (gain != 0, or still gliding) */
+    virtual uint8_t get_active_bands() const = 0;
+    
+    /* Magnitude response of the settled, quantised cascade (cold path);
+     * excludes the headroom cut, which get_preamp_db() reports */
+    virtual float get_response_db(float freq_hz) const = 0;
+    virtual float get_preamp_db() const = 0;
+};
+
+Equalizer* create_equalizer();
+
+#endif  // EQUALIZER_H
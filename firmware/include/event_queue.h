@@ -5,8 +5,12 @@
 #include <cstddef>
 
 /* ============================================================================
- * Event Queue Interface
- * Thread-safe queue for inter-task communication
+ * Event Bus Interface
+ * Two priority lanes: real-time (buttons, playback commands, audio) is
+ * always drained before UI (Bluetooth status, display, SD notifications).
+ * Idempotent events are coalesced while one is still pending. Consumers
+ * either receive events directly or register per-type subscribers and
+ * call dispatch().
  * ========================================================================== */
 
 enum EventType {
@@ -16,8 +20,8 @@ enum EventType {
     
     EVENT_PLAYBACK_PLAY = 0x20,
     EVENT_PLAYBACK_PAUSE = 0x21,
-    EVENT_PLAYBACK_NEXT = 0x22,
-    EVENT_PLAYBACK_PREV = 0x23,
+    EVENT_PLAYBACK_NEXT = 0x22,   /* Coalesced: param = number of skips */
+    EVENT_PLAYBACK_PREV = 0x23,   /* Coalesced: param = number of skips */
     
     EVENT_AUDIO_BUFFER_READY = 0x30,
     EVENT_AUDIO_UNDERRUN = 0x31,
@@ -27,27 +31,68 @@ enum EventType {
     EVENT_BT_DISCONNECTED = 0x41,
     EVENT_BT_ERROR = 0x42,
     
-    EVENT_DISPLAY_REDRAW = 0x50,
-    EVENT_DISPLAY_STATE_CHANGE = 0x51,
+    EVENT_DISPLAY_REDRAW = 0x50,        /* Coalesced: one pending at most */
+    EVENT_DISPLAY_STATE_CHANGE = 0x51,  /* Coalesced: latest param wins */
     
     EVENT_SD_FILE_LOADED = 0x60,
     EVENT_SD_FILE_NOT_FOUND = 0x61,
     EVENT_SD_ERROR = 0x62,
+    EVENT_SD_LIBRARY_READY = 0x63,  /* Boot scan done: param = tracks | LIBRARY_FROM_PLAYLIST */
+};
+
+/* Timeout for wait_and_receive()/dispatch(): block until an event arrives
+ * (0 = do not wait) */
+#define EVENT_WAIT_FOREVER 0xFFFFFFFFu
+
+/* EVENT_SD_LIBRARY_READY: the scan opened PLAYLIST_AUTOLOAD_PATH */
+#define LIBRARY_FROM_PLAYLIST 0x80000000u
+
+enum EventLane {
+    LANE_REALTIME,
+    LANE_UI,
+    LANE_COUNT
 };
 
 typedef struct {
-    uint8_t type;
+    EventType type;
     uint32_t param;
 } Event;
 
+typedef void (*EventHandler)(const Event& event, void* context);
+
+/* Queue health counters */
+struct EventBusStats {
+    uint16_t depth_high_water[LANE_COUNT];  /* Deepest each lane has been */
+    uint32_t posted;                        /* Accepted (incl. coalesced) */
+    uint32_t coalesced;                     /* Merged into a pending event */
+    uint32_t dropped;                       /* Lane full (post returned false) */
+};
+
+/* Buttons, playback and audio events are real-time; the rest are UI */
+inline EventLane event_lane(EventType type) {
+    return (type < EVENT_BT_CONNECTED) ? LANE_REALTIME : LANE_UI;
+}
+
 class EventQueue {
 public:
     virtual ~EventQueue() = default;
     
+    /* Non-blocking post from task context */
     virtual bool post(const Event& event) = 0;
+    
+    /* Non-blocking post from an ISR; caller yields if *woken is set */
+    virtual bool post_from_isr(const Event& event, int* woken) = 0;
+    
+    /* Receive the next event, real-time lane first (0: poll, EVENT_WAIT_FOREVER) */
     virtual bool wait_and_receive(Event& event, uint32_t timeout_ms) = 0;
     virtual bool try_receive(Event& event) = 0;
     virtual size_t pending_count() const = 0;
+    
+    /* Subscriber dispatch: handlers run in the dispatching task */
+    virtual bool subscribe(EventType type, EventHandler handler, void* context) = 0;
+    virtual size_t dispatch(uint32_t timeout_ms) = 0;  /* Waits as above, drains all pending; returns count */
+    
+    virtual const EventBusStats& get_stats() const = 0;
 };
 
 #endif  // EVENT_QUEUE_H
@@ -0,0 +1,24 @@
+#ifndef FONT5X7_H
+#define FONT5X7_H
+
+#include <cstdint>
+#include <cstddef>
+
+/* ============================================================================
+ * 5x7 Bitmap Font (printable ASCII 0x20–0x7E)
+ * Column-major: one byte per column, bit 0 = top row. Matches the SSD1306
+ * page layout, so a glyph column is blitted with one shift + OR per page.
+ * ========================================================================== */
+
+#define FONT5X7_FIRST    0x20
+#define FONT5X7_LAST     0x7E
+#define FONT5X7_WIDTH    5
+#define FONT5X7_HEIGHT   7
+#define FONT5X7_ADVANCE  6   // Glyph width + 1 column spacing
+
+extern const uint8_t FONT5X7[FONT5X7_LAST - FONT5X7_FIRST + 1][FONT5X7_WIDTH];
+
+/* Render text into a column strip (FONT5X7_ADVANCE per char); returns width */
+size_t font5x7_render(const char* text, uint8_t* columns, size_t max_columns);
+
+#endif  // FONT5X7_H
@@ -0,0 +1,48 @@
+#ifndef LATENCY_MONITOR_H
+#define LATENCY_MONITOR_H
+
+#include <cstdint>
+#include <cstddef>
+
+/* ============================================================================
+ * Input Latency Monitor
+ * Measures input → playback command applied, accumulated in a fixed
+ * histogram for percentile reporting. Every gesture is timed from the
+ * moment it was decided: the release for SHORT and HOLD_END, the settled
+ * second press for DOUBLE, the deadline for LONG/REPEAT and for PLAY's
+ * SHORT. The double-press wait before that SHORT is a separate number
+ * ========================================================================== */
+
+struct LatencyPercentiles {
+    uint32_t count;
+    uint32_t p50_us;
+    uint32_t p90_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+    
+    uint32_t waits;            /* PLAY SHORTs held back for a double press */
+    uint32_t wait_max_us;      /* Release → window closed, worst case */
+};
+
+class LatencyMonitor {
+public:
+    virtual ~LatencyMonitor() = default;
+    
+    /* Input started at `time_us` (micros() clock); called by the button task */
+    virtual void mark_input(uint32_t time_us) = 0;
+    
+    /* A gesture was held back `wait_us` to rule out a double press */
+    virtual void mark_gesture_wait(uint32_t wait_us) = 0;
+    
+    /* The command for the last input has been applied */
+    virtual void mark_action() = 0;
+    
+    virtual void get_percentiles(LatencyPercentiles& out) const = 0;
+    
+    /* Print percentiles to Serial */
+    virtual void report() const = 0;
+};
+
+LatencyMonitor* create_latency_monitor();
+
+#endif  // LATENCY_MONITOR_H
@@ -0,0 +1,35 @@
+#ifndef LEVEL_METER_H
+#define LEVEL_METER_H
+
+#include <cstdint>
+#include <cstddef>
+
+/* ============================================================================
+ * Audio Level Meter Tap
+ * Per-block peak/RMS and coarse band energies of the PCM stream feeding the
+ * sink, published as a lock-free snapshot for the UI
+ * ========================================================================== */
+
+#define LEVEL_METER_BANDS 3   // Low (<250 Hz), mid (250 Hz–2 kHz), high (>2 kHz)
+
+struct LevelSnapshot {
+    uint16_t peak[2];                   /* L/R peak |sample| (0–32767) */
+    uint16_t rms[2];                    /* L/R RMS (0–32767) */
+    uint16_t band[LEVEL_METER_BANDS];   /* Band RMS of mono mix (0–32767) */
+    uint32_t blocks;                    /* Blocks published so far */
+};
+
+class LevelMeter {
+public:
+    virtual ~LevelMeter() = default;
+    
+    /* Tap interleaved stereo PCM (called from the audio path; never blocks) */
+    virtual void process(const int16_t* pcm, size_t sample_count) = 0;
+    
+    /* Latest complete block (safe from any task) */
+    virtual void read(LevelSnapshot& out) const = 0;
+};
+
+LevelMeter* create_level_meter();
+
+#endif  // LEVEL_METER_H
@@ -0,0 +1,101 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include "config.h"
+
+/* ============================================================================
+ * Deferred Logging Interface
+ * A log call copies the format-string pointer and up to LOG_MAX_ARGS raw
+ * 32-bit arguments into a ring; nothing is formatted or written to the
+ * UART on the caller's path. A lowest-priority task drains the ring, either
+ * as binary frames (expanded on the host by tools/log_expand.py against the
+ * firmware ELF) or as text formatted on the device.
+ *
+ * Usage, per translation unit:
+ *     #define LOG_MODULE LOG_MOD_BT
+ *     LOG_W("[BT] Ring overflow at %u", (unsigned)pos);
+ *
+ * Calls below the module's LOG_LEVEL_* (config.h) fold away at compile
+ * time, format string included. Arguments must be integers, enums or
+ * pointers; a "%s" argument must point to storage that outlives the drain
+ * (string literals, static tables), never to a stack or file-name buffer.
+ * ========================================================================== */
+
+enum LogModule {
+    LOG_MOD_MAIN,
+    LOG_MOD_AUDIO,
+    LOG_MOD_BT,
+    LOG_MOD_DISPLAY,
+    LOG_MOD_BUTTON,
+    LOG_MOD_SD,
+    LOG_MOD_PLAYBACK,
+    LOG_MOD_EVENT,
+    LOG_MOD_COUNT
+};
+
+constexpr uint8_t log_module_level(LogModule module) {
+    return module == LOG_MOD_MAIN     ? LOG_LEVEL_MAIN :
+           module == LOG_MOD_AUDIO    ? LOG_LEVEL_AUDIO :
+           module == LOG_MOD_BT       ? LOG_LEVEL_BT :
+           module == LOG_MOD_DISPLAY  ? LOG_LEVEL_DISPLAY :
+           module == LOG_MOD_BUTTON   ? LOG_LEVEL_BUTTON :
+           module == LOG_MOD_SD       ? LOG_LEVEL_SD :
+           module == LOG_MOD_PLAYBACK ? LOG_LEVEL_PLAYBACK :
+           module == LOG_MOD_EVENT    ? LOG_LEVEL_EVENT : LOG_LEVEL_NONE;
+}
+
+struct LogStats {
+    uint32_t records;      /* Accepted into the ring */
+    uint32_t dropped;      /* Ring full */
+    uint32_t cycles_avg;   /* Cost of one call on the caller's path */
+    uint32_t cycles_max;
+};
+
+/* Append one record; safe from tasks on either core and from ISRs */
+void log_emit(uint8_t module, uint8_t level, const char* fmt, const uintptr_t* args, uint8_t count);
+
+template <typename T>
+inline uintptr_t log_arg(T value) {
+    static_assert(std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value,
+                  "log arguments must be integers, enums or pointers (no floats)");
+    return (uintptr_t)value;
+}
+
+template <typename... Args>
+inline void log_write(uint8_t module, uint8_t level, const char* fmt, Args... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+    const uintptr_t words[] = {0, log_arg(args)...};  /* Leading 0: no empty array */
+    log_emit(module, level, fmt, words + 1, (uint8_t)sizeof...(Args));
+}
+
+class Logger {
+public:
+    virtual ~Logger() = default;
+    
+    /* Start the drain task */
+    virtual bool init() = 0;
+    
+    virtual void get_stats(LogStats& out) const = 0;
+    
+    /* Print counters and per-call cost when there is something new */
+    virtual void report() = 0;
+};
+
+Logger* create_logger();
+
+#define LOG_AT(level, fmt, ...)                                                  \
+    do {                                                                         \
+        if ((level) <= log_module_level(LOG_MODULE)) {                           \
+            log_write(LOG_MODULE, (level), fmt, ##__VA_ARGS__);                  \
+        }                                                                        \
+    } while (0)
+
+#define LOG_E(fmt, ...) LOG_AT(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define LOG_W(fmt, ...) LOG_AT(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define LOG_I(fmt, ...) LOG_AT(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define LOG_D(fmt, ...) LOG_AT(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+
+#endif  // LOG_H
@@ -0,0 +1,80 @@
+#ifndef MEMORY_TELEMETRY_H
+#define MEMORY_TELEMETRY_H
+
+#include <cstdint>
+#include <cstddef>
+
+/* ============================================================================
+ * Memory Telemetry Interface
+ * Low-water marks for task stacks and heap, high-water marks for buffer
+ * fill levels. Kept in one fixed record that survives a reset (RTC memory),
+ * so the numbers from before a crash or watchdog reset can still be read.
+ * ========================================================================== */
+
+enum MemTask {
+    MEM_TASK_LOOP,       /* Arduino loopTask (setup/loop) */
+    MEM_TASK_BUTTONS,
+    MEM_TASK_DISPLAY,
+    MEM_TASK_LOG,
+    MEM_TASK_SD_BOOT,    /* SD mount + library scan, exits after boot */
+    MEM_TASK_BT_BOOT,    /* Bluetooth bring-up, exits after boot */
+    MEM_TASK_COUNT
+};
+
+enum MemBuffer {
+    MEM_BUF_AUDIO_RING,  /* Bluetooth PCM ring (bytes) */
+    MEM_BUF_EVENT_RT,    /* Event bus real-time lane (events) */
+    MEM_BUF_EVENT_UI,    /* Event bus UI lane (events) */
+    MEM_BUF_BUTTON_RING, /* ISR edge capture ring (edges) */
+    MEM_BUF_COUNT
+};
+
+struct MemoryRecord {
+    uint32_t magic;
+    uint32_t boot_count;
+    uint32_t uptime_ms;                          /* At the last sample */
+    
+    uint32_t heap_free_min;                      /* Lowest free heap ever */
+    uint32_t heap_largest_block_min;             /* Smallest "largest block" seen */
+    
+    uint32_t stack_size[MEM_TASK_COUNT];         /* Bytes, 0 = not registered */
+    uint32_t stack_free_min[MEM_TASK_COUNT];     /* Bytes never touched */
+    
+    uint32_t buffer_capacity[MEM_BUF_COUNT];
+    uint32_t buffer_peak[MEM_BUF_COUNT];
+    
+    uint32_t crc;
+};
+
+class MemoryTelemetry {
+public:
+    virtual ~MemoryTelemetry() = default;
+    
+    /* Validate the record left in RTC memory, keep it as the previous boot */
+    virtual bool init() = 0;
+    
+    /* Track a task's stack; handle is a FreeRTOS TaskHandle_t */
+    virtual void register_task(MemTask task, void* handle, uint32_t stack_bytes) = 0;
+    
+    /* Called by a registered task just before it deletes itself: keeps its
+     * final stack mark, stops polling the handle */
+    virtual void retire_task(MemTask task) = 0;
+    
+    /* Cheap enough for hot paths: one compare, one store */
+    virtual void note_buffer_fill(MemBuffer buffer, uint32_t fill, uint32_t capacity) = 0;
+    
+    /* Poll heap and stack marks and reseal the RTC record */
+    virtual void sample() = 0;
+    
+    virtual void get_record(MemoryRecord& out) const = 0;
+    
+    /* Record from before the last reset; false after power-on */
+    virtual bool get_previous(MemoryRecord& out) const = 0;
+    
+    /* Print current (and previous boot) records to Serial */
+    virtual void dump() const = 0;
+};
+
+MemoryTelemetry* create_memory_telemetry();
+
+#endif  // MEMORY_TELEMETRY_H
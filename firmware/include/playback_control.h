@@ -21,6 +21,10 @@ enum PlaybackCommand {
     CMD_PLAY_PREV,
     CMD_TOGGLE_PLAY_PAUSE,
     CMD_STOP,
+    CMD_TOGGLE_SHUFFLE,
+    CMD_SCAN_FORWARD,    /* Hold NEXT: one accelerating jump per repeat */
+    CMD_SCAN_BACKWARD,   /* Hold PREV */
+    CMD_SCAN_STOP,       /* Button released: resume normal playback */
     CMD_NONE
 };
 
@@ -31,9 +35,19 @@ public:
     virtual bool init() = 0;
     virtual PlaybackState get_state() const = 0;
     virtual void execute_command(PlaybackCommand cmd) = 0;
+    virtual void skip(int32_t tracks) = 0;  /* ±N tracks from PLAYING/PAUSED, one load */
     virtual void update() = 0;  /* Called periodically from main loop */
     virtual uint32_t get_current_position_ms() const = 0;
     virtual uint32_t get_total_duration_ms() const = 0;
+    
+    /* Shuffle mode (keyed permutation; order is stable for SHUFFLE_SEED) */
+    virtual void set_shuffle(bool enabled) = 0;
+    virtual bool is_shuffle_enabled() const = 0;
+    
+    /* Track list from the background library scan (playlist singleton
+     * already open when from_playlist). Until it arrives PLAY starts the
+     * first file; a track already playing is kept */
+    virtual void set_library(uint32_t track_count, bool from_playlist) = 0;
 };
 
 PlaybackController* create_playback_controller();
@@ -0,0 +1,35 @@
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+#include <cstdint>
+#include <cstddef>
+
+/* ============================================================================
+ * Playlist Interface (Pure Virtual)
+ * Streaming M3U/M3U8 reader: constant RAM regardless of playlist length
+ * ========================================================================== */
+
+class Playlist {
+public:
+    virtual ~Playlist() = default;
+    
+    /* Open playlist and build the sparse offset index (one streaming pass) */
+    virtual bool open(const char* path) = 0;
+    
+    /* Close playlist file */
+    virtual void close() = 0;
+    
+    /* Check if a playlist is loaded */
+    virtual bool is_open() const = 0;
+    
+    /* Number of track entries (comments and blank lines excluded) */
+    virtual uint32_t get_count() const = 0;
+    
+    /* Resolve entry N to an absolute SD path (relative to playlist folder).
+     * Cost: one seek plus up to (stride - 1) skipped entries, see config.h */
+    virtual bool get_entry(uint32_t index, char* path, size_t path_len) = 0;
+};
+
+Playlist* create_playlist();
+
+#endif  // PLAYLIST_H
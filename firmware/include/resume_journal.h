@@ -0,0 +1,50 @@
+#ifndef RESUME_JOURNAL_H
+#define RESUME_JOURNAL_H
+
+#include <cstdint>
+#include <cstddef>
+
+/* ============================================================================
+ * Resume Journal Interface (Pure Virtual)
+ * Persists the last playback point so power-up resumes where it stopped
+ * ========================================================================== */
+
+enum ResumeFlags {
+    RESUME_FROM_PLAYLIST = 0x01,  /* track index refers to playlist entry */
+};
+
+struct ResumeRecord {
+    uint32_t track_index;   /* Directory or playlist entry */
+    uint32_t byte_offset;   /* Frame-aligned offset into the MP3 file */
+    uint32_t position_ms;   /* Playback position at byte_offset */
+    uint32_t flags;         /* ResumeFlags */
+    
+    /* Identity of the file byte_offset points into: the index alone may
+     * name another file once tracks are added to or removed from the card */
+    uint32_t file_size;
+    uint32_t path_hash;     /* FNV-1a of the full path */
+};
+
+class ResumeJournal {
+public:
+    virtual ~ResumeJournal() = default;
+    
+    /* Open storage and locate the newest valid record */
+    virtual bool init() = 0;
+    
+    /* Newest valid record (false if none / all corrupt) */
+    virtual bool load(ResumeRecord& record) = 0;
+    
+    /* Update the in-RAM record (cheap; call as often as needed) */
+    virtual void record(const ResumeRecord& record) = 0;
+    
+    /* Batched write: commits only if changed and the save interval elapsed */
+    virtual void update() = 0;
+    
+    /* Commit now if changed (pause, stop, track change) */
+    virtual void commit() = 0;
+};
+
+ResumeJournal* create_resume_journal();
+
+#endif  // RESUME_JOURNAL_H
@@ -7,6 +7,11 @@
 /* ============================================================================
  * SD Card Interface (Pure Virtual)
  * SPI-based SD card access with FAT32 file system support
+ *
+ * The SD library is not thread-safe, and since the boot scan runs on its
+ * own task the card is shared. Every method here holds the card lock; code
+ * that reads the card through the SD library directly (playlists) holds it
+ * with an SDCardLock for the duration of each access.
  * ========================================================================== */
 
 class SDCard {
@@ -22,9 +27,18 @@ public:
     /* Get list of MP3 files in root directory */
     virtual int list_files(const char** filenames, int max_count) = 0;
     
+    /* Count MP3 files in root directory (no name storage) */
+    virtual int count_files() = 0;
+    
+    /* Path of the index-th MP3 file, in count_files() order */
+    virtual bool get_file_path(int index, char* path, size_t max_len) = 0;
+    
     /* Open file for reading */
     virtual bool open_file(const char* filename) = 0;
     
+    /* Move the read position of the open file (absolute byte offset) */
+    virtual bool seek(size_t offset) = 0;
+    
     /* Read next chunk of data */
     virtual int read_data(uint8_t* buffer, size_t max_len) = 0;
     
@@ -39,6 +53,23 @@ public:
     
     /* Error status */
     virtual const char* get_error_message() const = 0;
+    
+    /* Serialise card access across tasks (recursive: may nest on one task) */
+    virtual void lock() const = 0;
+    virtual void unlock() const = 0;
+};
+
+/* Holds the card lock for the enclosing scope */
+class SDCardLock {
+public:
+    explicit SDCardLock(const SDCard* card) : card(card) { card->lock(); }
+    ~SDCardLock() { card->unlock(); }
+    
+    SDCardLock(const SDCardLock&) = delete;
+    SDCardLock& operator=(const SDCardLock&) = delete;
+
+private:
+    const SDCard* card;
 };
 
 #endif  // SD_CARD_H
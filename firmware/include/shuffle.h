@@ -0,0 +1,47 @@
+#ifndef SHUFFLE_H
+#define SHUFFLE_H
+
+#include <cstdint>
+
+/* ============================================================================
+ * Shuffle Order (Keyed Permutation)
+ * Maps play-order position → track index without storing a shuffled array.
+ * Balanced Feistel network over the next even power of two, cycle-walked
+ * down to the track count: O(1) memory, O(1) forward and inverse lookup,
+ * every track exactly once per cycle, same order for the same seed.
+ * ========================================================================== */
+
+class ShuffleOrder {
+public:
+    static const uint8_t ROUNDS = 4;
+    
+    /* Configure for `count` tracks; `seed` fixes the order across reboots */
+    void reset(uint32_t count, uint32_t seed);
+    
+    /* Start a new cycle (different order, still derived from the seed) */
+    void set_cycle(uint32_t cycle);
+    
+    /* Play-order position → track index (position < count) */
+    uint32_t track_at(uint32_t position) const;
+    
+    /* Track index → play-order position (inverse of track_at) */
+    uint32_t position_of(uint32_t track) const;
+    
+    uint32_t get_count() const { return count; }
+    uint32_t get_cycle() const { return cycle; }
+
+private:
+    uint32_t count = 0;
+    uint32_t seed = 0;
+    uint32_t cycle = 0;
+    uint8_t half_bits = 0;
+    uint32_t half_mask = 0;
+    uint32_t keys[ROUNDS] = {0};
+    
+    uint32_t round_fn(uint32_t half, uint8_t round) const;
+    uint32_t encrypt(uint32_t x) const;
+    uint32_t decrypt(uint32_t x) const;
+    void derive_keys();
+};
+
+#endif  // SHUFFLE_H
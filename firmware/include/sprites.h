@@ -0,0 +1,31 @@
+#ifndef SPRITES_H
+#define SPRITES_H
+
+#include <cstdint>
+#include <cstddef>
+
+/* ============================================================================
+ * Sprite Atlas (generated at compile time, stored in flash)
+ * Page-major like the SSD1306 framebuffer: for each 8-row page, one
+ * (image, mask) byte pair per column, bit 0 = top row. Mask bits mark
+ * opaque pixels; pixels outside the mask leave the framebuffer untouched.
+ * ========================================================================== */
+
+enum SpriteId {
+    SPRITE_PLAY,
+    SPRITE_PAUSE,
+    SPRITE_LOADING,
+    SPRITE_ERROR,
+    SPRITE_COUNT
+};
+
+struct Sprite {
+    uint8_t width;
+    uint8_t height;
+    uint16_t offset;    /* Byte offset of the sprite in SPRITE_ATLAS */
+};
+
+extern const Sprite* const SPRITES;       /* Indexed by SpriteId */
+extern const uint8_t* const SPRITE_ATLAS;
+
+#endif  // SPRITES_H
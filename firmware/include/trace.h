@@ -0,0 +1,93 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include "config.h"
+
+/* ============================================================================
+ * Hot-Path Trace Interface
+ * Fixed 8-byte binary records (cycle counter, event, argument) in one ring
+ * per core. Begin/end pairs bracket SD reads, frame decodes, audio feeds,
+ * display flushes and state transitions. The rings are dumped in binary
+ * over Serial and turned into Chrome/Perfetto JSON by
+ * tools/trace_to_chrome.py. With FEATURE_TRACE set to 0 every TRACE_* macro
+ * expands to nothing and no ring memory is reserved.
+ * ========================================================================== */
+
+/* Event IDs; keep EVENT_NAMES in tools/trace_to_chrome.py in sync */
+enum TraceEvent {
+    TRACE_SD_READ = 1,           /* arg: bytes requested */
+    TRACE_DECODE_FRAME = 2,      /* arg: frame number (low 16 bits) */
+    TRACE_FEED_AUDIO = 3,        /* arg: sample count */
+    TRACE_DISPLAY_FLUSH = 4,     /* arg: 1 = full panel, 0 = diff */
+    TRACE_STATE_TRANSITION = 5,  /* arg: new PlaybackState */
+    TRACE_AUDIO_OVERFLOW = 6,    /* Instant; freezes the rings */
+};
+
+/* Phase lives in the top two bits of the 16-bit id field */
+enum TracePhase {
+    TRACE_PHASE_BEGIN = 0x0000,
+    TRACE_PHASE_END = 0x4000,
+    TRACE_PHASE_INSTANT = 0x8000,
+};
+
+struct TraceRecord {
+    uint32_t cycles;   /* CCOUNT of the recording core */
+    uint16_t id;       /* TraceEvent | TracePhase */
+    uint16_t arg;
+};
+
+/* Lock-free append to the calling core's ring (task or ISR context) */
+void trace_record(uint16_t id, uint16_t arg);
+
+class Tracer {
+public:
+    virtual ~Tracer() = default;
+    
+    /* Stop recording so the window leading up to a glitch is kept */
+    virtual void freeze() = 0;
+    virtual void resume() = 0;
+    virtual bool is_frozen() const = 0;
+    
+    /* Write both rings to Serial in the binary dump format, then resume */
+    virtual void dump() = 0;
+};
+
+Tracer* create_tracer();
+
+#if FEATURE_TRACE
+
+/* Begin on construction, end when the scope exits (any return path) */
+class TraceScope {
+private:
+    uint16_t event;
+public:
+    TraceScope(uint16_t event, uint16_t arg) : event(event) {
+        trace_record(event | TRACE_PHASE_BEGIN, arg);
+    }
+    ~TraceScope() {
+        trace_record(event | TRACE_PHASE_END, 0);
+    }
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#define TRACE_BEGIN(event, arg)   trace_record((uint16_t)((event) | TRACE_PHASE_BEGIN), (uint16_t)(arg))
+#define TRACE_END(event, arg)     trace_record((uint16_t)((event) | TRACE_PHASE_END), (uint16_t)(arg))
+#define TRACE_INSTANT(event, arg) trace_record((uint16_t)((event) | TRACE_PHASE_INSTANT), (uint16_t)(arg))
+#define TRACE_SCOPE(event, arg)   TraceScope TRACE_CONCAT(trace_scope_, __LINE__)((event), (uint16_t)(arg))
+#define TRACE_FREEZE()            create_tracer()->freeze()
+
+#else
+
+#define TRACE_BEGIN(event, arg)   ((void)0)
+#define TRACE_END(event, arg)     ((void)0)
+#define TRACE_INSTANT(event, arg) ((void)0)
+#define TRACE_SCOPE(event, arg)   ((void)0)
+#define TRACE_FREEZE()            ((void)0)
+
+#endif  // FEATURE_TRACE
+
+#endif  // TRACE_H
@@ -17,6 +17,13 @@ enum PlayerState {
     UI_STATE_ERROR
 };
 
+/* Cost of the most recent render() */
+struct UIFrameStats {
+    uint32_t render_us;        /* CPU time spent drawing (excl. async flush) */
+    uint16_t pixels_touched;   /* Area of the widget boxes redrawn */
+    uint8_t widgets_drawn;     /* Widgets whose bound value changed */
+};
+
 class UI {
 public:
     virtual ~UI() = default;
@@ -38,6 +45,9 @@ public:
     
     /* Show info message (e.g., "Bluetooth Connected") */
     virtual void show_info(const char* message) = 0;
+    
+    /* Per-frame drawing cost */
+    virtual const UIFrameStats& get_frame_stats() const = 0;
 };
 
 /* Factory function */
@@ -0,0 +1,76 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/* ============================================================================
+ * Arduino Core Fake (native host)
+ * The subset of the ESP32 Arduino API the firmware uses. Serial goes to
+ * stdout/stdin, GPIO levels come from the button script, heap figures are
+ * fixed (host malloc says nothing useful about the ESP32 heap).
+ * ========================================================================== */
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+#define PROGMEM
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+class HardwareSerial {
+public:
+    void begin(unsigned long baud);
+    int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const char* text);
+    size_t println(const char* text = "");
+    size_t write(uint8_t byte);
+    size_t write(const uint8_t* data, size_t len);
+    int available();
+    int read();
+    int availableForWrite();
+    void flush();
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getCycleCount();   /* Wall-clock nanoseconds scaled to 240 MHz */
+};
+
+extern EspClass ESP;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+uint32_t getCpuFrequencyMhz();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t level);
+inline int digitalPinToInterrupt(int pin) { return pin; }
+void attachInterrupt(int pin, void (*handler)(), int mode);
+void detachInterrupt(int pin);
+
+inline uint8_t pgm_read_byte(const void* addr) { return *(const uint8_t*)addr; }
+
+#endif  // NATIVE_ARDUINO_H
@@ -0,0 +1,30 @@
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+#include <cstdint>
+#include <cstddef>
+
+/* ============================================================================
+ * NVS Fake (native host)
+ * One file per key under NATIVE_NVS_DIR/<namespace>/, so resume records
+ * survive between host runs like they survive a reboot on the device.
+ * ========================================================================== */
+
+class Preferences {
+private:
+    char dir[256] = "";
+    bool opened = false;
+    bool read_only = false;
+    
+    void key_path(const char* key, char* path, size_t len) const;
+
+public:
+    bool begin(const char* name, bool readOnly = false);
+    void end();
+    size_t putBytes(const char* key, const void* value, size_t len);
+    size_t getBytes(const char* key, void* buffer, size_t max_len);
+    size_t getBytesLength(const char* key);
+    bool remove(const char* key);
+};
+
+#endif  // NATIVE_PREFERENCES_H
@@ -0,0 +1,59 @@
+#ifndef NATIVE_SD_H
+#define NATIVE_SD_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include "SPI.h"
+
+/* ============================================================================
+ * SD Card Fake (native host)
+ * A host directory (NATIVE_SD_ROOT) stands in for the FAT volume. File has
+ * the Arduino value semantics: copies share one open handle.
+ * ========================================================================== */
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+struct NativeFileHandle;
+
+class File {
+private:
+    std::shared_ptr<NativeFileHandle> handle;
+
+public:
+    File() = default;
+    explicit File(std::shared_ptr<NativeFileHandle> handle) : handle(handle) {}
+    
+    operator bool() const;
+    int read(uint8_t* buffer, size_t len);
+    int read();
+    size_t write(const uint8_t* data, size_t len);
+    bool seek(uint32_t position);
+    size_t position() const;
+    size_t size() const;
+    int available();
+    void flush();
+    void close();
+    
+    bool isDirectory() const;
+    File openNextFile();
+    void rewindDirectory();
+    bool seekDir(long position);
+    const char* name() const;
+    const char* path() const;
+};
+
+class SDFS {
+public:
+    bool begin(uint8_t cs, SPIClass& spi, uint32_t frequency);
+    void end();
+    File open(const char* path, const char* mode = FILE_READ);
+    bool exists(const char* path);
+};
+
+extern SDFS SD;
+
+#endif  // NATIVE_SD_H
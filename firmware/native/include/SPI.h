@@ -0,0 +1,12 @@
+#ifndef NATIVE_SPI_H
+#define NATIVE_SPI_H
+
+/* SPI bus fake: the SD fake is file-backed, so there is nothing to clock */
+class SPIClass {
+public:
+    void begin(int sck = -1, int miso = -1, int mosi = -1, int ss = -1) {}
+};
+
+extern SPIClass SPI;
+
+#endif  // NATIVE_SPI_H
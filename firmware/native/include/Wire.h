@@ -0,0 +1,32 @@
+#ifndef NATIVE_WIRE_H
+#define NATIVE_WIRE_H
+
+#include <cstdint>
+#include <cstddef>
+
+/* ============================================================================
+ * I2C Fake (native host)
+ * Transmissions to the SSD1306 address are decoded by a simulated panel
+ * (native_ssd1306.cpp); any other address NACKs.
+ * ========================================================================== */
+
+#define I2C_BUFFER_LENGTH 128
+
+class TwoWire {
+private:
+    uint8_t address = 0;
+    uint8_t buffer[I2C_BUFFER_LENGTH];
+    size_t length = 0;
+
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    void setClock(uint32_t frequency) {}
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t byte);
+    size_t write(const uint8_t* data, size_t len);
+    uint8_t endTransmission(bool stop = true);
+};
+
+extern TwoWire Wire;
+
+#endif  // NATIVE_WIRE_H
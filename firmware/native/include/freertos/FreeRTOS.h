@@ -0,0 +1,59 @@
+#ifndef NATIVE_FREERTOS_H
+#define NATIVE_FREERTOS_H
+
+#include <cstdint>
+#include <cstddef>
+
+/* ============================================================================
+ * FreeRTOS Shim (native host)
+ * Tasks are POSIX threads, queues/semaphores/notifications are mutex +
+ * condition variable objects, and a portMUX is a recursive spinlock. Tick
+ * period is 1 ms of virtual time (see native_host.h). Priorities are
+ * recorded but not enforced; the host scheduler decides.
+ * ========================================================================== */
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;   /* ESP-IDF: stack sizes are in bytes */
+
+typedef void* TaskHandle_t;
+typedef void* QueueHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS 1
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portNUM_PROCESSORS 2
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+struct portMUX_TYPE {
+    int owner;      /* Host thread token, 0 = free */
+    int count;      /* Nesting depth */
+};
+
+#define portMUX_INITIALIZER_UNLOCKED {0, 0}
+
+void native_mux_enter(portMUX_TYPE* mux);
+void native_mux_exit(portMUX_TYPE* mux);
+
+#define portENTER_CRITICAL(mux)       native_mux_enter(mux)
+#define portEXIT_CRITICAL(mux)        native_mux_exit(mux)
+#define portENTER_CRITICAL_ISR(mux)   native_mux_enter(mux)
+#define portEXIT_CRITICAL_ISR(mux)    native_mux_exit(mux)
+#define portENTER_CRITICAL_SAFE(mux)  native_mux_enter(mux)
+#define portEXIT_CRITICAL_SAFE(mux)   native_mux_exit(mux)
+#define portYIELD_FROM_ISR(woken)     ((void)(woken))
+
+/* Core of the calling task (as pinned), ISR flag set by the GPIO fake */
+BaseType_t xPortGetCoreID();
+BaseType_t xPortInIsrContext();
+
+#endif  // NATIVE_FREERTOS_H
@@ -0,0 +1,98 @@
+#ifndef NATIVE_HOST_H
+#define NATIVE_HOST_H
+
+#include <cstdint>
+#include <chrono>
+
+/* ============================================================================
+ * Native Host Runtime
+ * Shared by the Arduino, FreeRTOS and peripheral fakes of the `native`
+ * PlatformIO environment. Firmware code never includes this directly.
+ *
+ * Time is virtual: millis()/micros()/ticks run NATIVE_TIME_SCALE times
+ * faster than the wall clock, and every delay or blocking timeout is
+ * shortened by the same factor, so the whole player runs at N× real time.
+ *
+ * Environment variables (all optional):
+ *   NATIVE_TIME_SCALE   clock speed-up factor (default 1)
+ *   NATIVE_RUN_MS       stop after this much virtual time (default: forever)
+ *   NATIVE_SD_ROOT      directory served as the SD card (default ./sdcard)
+ *   NATIVE_NVS_DIR      directory backing Preferences (default ./nvs)
+ *   NATIVE_WAV_PATH     A2DP sink output (default ./a2dp_out.wav)
+ *   NATIVE_PBM_DIR      write one PBM per display frame here (default: off,
+ *                       only ./display.pbm with the last frame)
+ *   NATIVE_BUTTONS      button script, lines of "<ms> <PREV|PLAY|NEXT> <down|up>",
+ *                       timed from the end of setup() (the player is ready)
+ *   NATIVE_EVENT_LOG    timeline file for benchmarks (default: off), one
+ *                       "<virtual us> <event> [detail]" line per ready,
+ *                       button edge, audible onset and silence
+ *   NATIVE_SEED         seed of the timing-model jitter (default 1)
+ *
+ * Timing models (all default to 0 = instantaneous):
+ *   NATIVE_SD_MOUNT_MS  SD.begin(): card identification and FAT mount
+ *   NATIVE_SD_ACCESS_US per open/seek/read command latency
+ *   NATIVE_SD_KBPS      read throughput in KB/s (0 = unlimited)
+ *   NATIVE_SD_JITTER_US extra uniform 0..N us per access
+ *   NATIVE_BT_INIT_MS   init() blocks this long (controller + stack bring-up)
+ *   NATIVE_BT_CONNECT_MS init() → speaker accepts audio
+ *   NATIVE_BT_LATENCY_MS feed → heard (SBC encode, link, speaker buffer)
+ *   NATIVE_BT_JITTER_MS extra uniform 0..N ms per audible onset
+ *   NATIVE_BT_BUFFER_MS sink queue; feed_audio() refuses beyond it (default 1000)
+ * ========================================================================== */
+
+typedef std::chrono::steady_clock NativeClock;
+
+/* Virtual time since start */
+uint64_t native_time_us();
+
+/* Sleep for a virtual duration */
+void native_sleep_us(uint64_t virtual_us);
+
+/* Real deadline for a blocking wait of `virtual_ms` (clamped for "forever") */
+NativeClock::time_point native_deadline_ms(uint32_t virtual_ms);
+
+/* Environment lookup with default */
+const char* native_env(const char* name, const char* fallback);
+
+/* Integer environment lookup with default */
+uint32_t native_env_u32(const char* name, uint32_t fallback);
+
+/* Uniform 0..max_us from the NATIVE_SEED stream (timing-model jitter) */
+uint32_t native_jitter_us(uint32_t max_us);
+
+/* Append to the NATIVE_EVENT_LOG timeline (no-op when unset) */
+void native_event(uint64_t virtual_us, const char* event, const char* detail);
+
+/* Bytes returned by File::read() so far, all files (for cost assertions) */
+uint64_t native_sd_bytes_read();
+
+/* Files and directories opened so far, including openNextFile() entries */
+uint64_t native_sd_opens();
+
+/* Panel RAM of the SSD1306 fake, DISPLAY_PAGES × DISPLAY_WIDTH bytes in
+ * framebuffer layout (what the glass shows, for golden-image tests) */
+void native_panel_read(uint8_t* gddram);
+
+/* Transmissions acknowledged by the Wire fake since start */
+struct NativeI2CStats {
+    uint32_t transmissions;
+    uint32_t bytes;      /* Address byte + payload, as on the wire */
+    uint32_t largest;    /* Longest payload (bounded by I2C_BUFFER_LENGTH) */
+};
+NativeI2CStats native_i2c_stats();
+
+/* Drive an input pin: a change runs its attached ISR on the calling thread
+ * (what NATIVE_BUTTONS does; host tests use it for bounce traces) */
+void native_gpio_set(uint8_t pin, uint8_t level);
+
+/* Called once setup() has returned; starts the scripted button thread */
+void native_gpio_start();
+
+/* Flush fakes that hold state in memory (WAV header, last display frame) */
+void native_at_exit(void (*fn)());
+
+/* Leave now with `status`: exit hooks run, static destructors do not (tasks
+ * may still be running). Host tests end their setup() with this */
+void native_exit(int status);
+
+#endif  // NATIVE_HOST_H
@@ -0,0 +1,5 @@
+# PlatformIO extra script for [env:native]: the FreeRTOS shim runs tasks on
+# POSIX threads, so the host link needs -pthread as well as the compile.
+Import("env")
+
+env.Append(LINKFLAGS=["-pthread"])
@@ -0,0 +1,201 @@
+#include "native_host.h"
+#include "bluetooth_a2dp.h"
+#include "config.h"
+#include "level_meter.h"
+#include "trace.h"
+#include <Arduino.h>
+#include <cstring>
+#include <mutex>
+
+/* ============================================================================
+ * A2DP Sink Fake (native host)
+ * Replaces bluetooth_a2dp.cpp in the native build. The "speaker" is a WAV
+ * file (NATIVE_WAV_PATH, 16-bit interleaved at AUDIO_SAMPLE_RATE) that is
+ * always in range: init() pairs with it. Volume is applied to the samples
+ * written to the file. The level meter and trace taps match the firmware
+ * module, so the UI and traces behave the same.
+ *
+ * Timing model (NATIVE_BT_*): the link accepts audio CONNECT_MS after
+ * init(); fed samples queue up (at most BUFFER_MS) and drain in real time;
+ * a sample is heard LATENCY_MS (+ jitter) after it leaves the queue. Each
+ * audible onset and each return to silence goes to the event timeline.
+ * ========================================================================== */
+
+class WavA2DPSink : public BluetoothA2DP {
+private:
+    FILE* wav = nullptr;
+    uint32_t data_bytes = 0;
+    bool connected = false;
+    uint8_t volume = 80;
+    std::mutex lock;
+    
+    /* Timing model, virtual microseconds */
+    uint64_t connect_at_us = 0;
+    uint64_t latency_us = 0;
+    uint32_t jitter_us = 0;
+    uint64_t buffer_us = 0;
+    uint64_t queue_end_us = 0;  /* When the last queued sample leaves the sink */
+    bool audible = false;
+    
+    LevelMeter* meter = nullptr;
+    
+    void write_header();
+
+public:
+    bool init() override;
+    bool connect() override;
+    bool disconnect() override;
+    bool feed_audio(const int16_t* pcm, uint16_t sample_count) override;
+    void flush() override;
+    bool is_connected() const override;
+    bool set_volume(uint8_t vol) override;
+    const char* get_error_message() const override;
+    
+    void finish();
+};
+
+static WavA2DPSink g_wav_sink;
+
+static void finish_wav() {
+    g_wav_sink.finish();
+}
+
+void WavA2DPSink::write_header() {
+    uint32_t rate = AUDIO_SAMPLE_RATE;
+    uint16_t channels = AUDIO_CHANNELS;
+    uint16_t bits = 16;
+    uint32_t byte_rate = rate * channels * bits / 8;
+    uint16_t block = channels * bits / 8;
+    uint32_t riff_size = 36 + data_bytes;
+    uint32_t fmt_size = 16;
+    uint16_t pcm_format = 1;
+    
+    fseek(wav, 0, SEEK_SET);
+    fwrite("RIFF", 1, 4, wav);
+    fwrite(&riff_size, 4, 1, wav);
+    fwrite("WAVEfmt ", 1, 8, wav);
+    fwrite(&fmt_size, 4, 1, wav);
+    fwrite(&pcm_format, 2, 1, wav);
+    fwrite(&channels, 2, 1, wav);
+    fwrite(&rate, 4, 1, wav);
+    fwrite(&byte_rate, 4, 1, wav);
+    fwrite(&block, 2, 1, wav);
+    fwrite(&bits, 2, 1, wav);
+    fwrite("data", 1, 4, wav);
+    fwrite(&data_bytes, 4, 1, wav);
+    fseek(wav, 0, SEEK_END);
+}
+
+bool WavA2DPSink::init() {
+    const char* path = native_env("NATIVE_WAV_PATH", "a2dp_out.wav");
+    wav = fopen(path, "wb");
+    if (!wav) {
+        Serial.printf("[BT] Native sink: cannot create %s\n", path);
+        return false;
+    }
+    write_header();
+    native_at_exit(finish_wav);
+    
+    meter = create_level_meter();
+    latency_us = (uint64_t)native_env_u32("NATIVE_BT_LATENCY_MS", 0) * 1000;
+    jitter_us = native_env_u32("NATIVE_BT_JITTER_MS", 0) * 1000;
+    buffer_us = (uint64_t)native_env_u32("NATIVE_BT_BUFFER_MS", 1000) * 1000;
+    
+    /* Controller and host stack bring-up block the caller */
+    native_sleep_us((uint64_t)native_env_u32("NATIVE_BT_INIT_MS", 0) * 1000);
+    connect_at_us = native_time_us() + (uint64_t)native_env_u32("NATIVE_BT_CONNECT_MS", 0) * 1000;
+    
+    Serial.printf("[BT] Native A2DP sink → %s\n", path);
+    return connect();
+}
+
+bool WavA2DPSink::connect() {
+    connected = (wav != nullptr);
+    return connected;
+}
+
+bool WavA2DPSink::disconnect() {
+    connected = false;
+    return true;
+}
+
+bool WavA2DPSink::feed_audio(const int16_t* pcm, uint16_t sample_count) {
+    if (!pcm || sample_count == 0) return false;
+    TRACE_SCOPE(TRACE_FEED_AUDIO, sample_count);
+    
+    if (!is_connected()) return false;
+    
+    int16_t scaled[256];
+    std::lock_guard<std::mutex> guard(lock);
+    
+    uint64_t now = native_time_us();
+    if (queue_end_us > now + buffer_us) return false;
+    if (queue_end_us <= now) {
+        /* Queue ran dry (or never started): these samples start a new onset */
+        if (audible) native_event(queue_end_us + latency_us, "silence", "underrun");
+        native_event(now + latency_us + native_jitter_us(jitter_us), "audio", nullptr);
+        audible = true;
+        queue_end_us = now;
+    }
+    queue_end_us += (uint64_t)sample_count * 1000000 / (AUDIO_SAMPLE_RATE * AUDIO_CHANNELS);
+    
+    for (uint16_t done = 0; done < sample_count; ) {
+        uint16_t n = sample_count - done;
+        if (n > 256) n = 256;
+        for (uint16_t i = 0; i < n; i++) {
+            scaled[i] = (int16_t)((int32_t)pcm[done + i] * volume / 100);
+        }
+        fwrite(scaled, sizeof(int16_t), n, wav);
+        data_bytes += n * sizeof(int16_t);
+        done += n;
+    }
+    
+    /* Tap only what was queued: a refused chunk is offered again later */
+    if (meter) {
+        meter->process(pcm, sample_count);
+    }
+    return true;
+}
+
+void WavA2DPSink::flush() {
+    std::lock_guard<std::mutex> guard(lock);
+    uint64_t now = native_time_us();
+    if (audible) {
+        /* Samples already in the link are still heard; the queue is not */
+        bool cut = queue_end_us > now;
+        native_event((cut ? now : queue_end_us) + latency_us + native_jitter_us(jitter_us),
+                     "silence", cut ? "flush" : "underrun");
+        audible = false;
+    }
+    queue_end_us = now;
+}
+
+bool WavA2DPSink::is_connected() const {
+    return connected && native_time_us() >= connect_at_us;
+}
+
+bool WavA2DPSink::set_volume(uint8_t vol) {
+    volume = (vol > 100) ? 100 : vol;
+    return true;
+}
+
+const char* WavA2DPSink::get_error_message() const {
+    return wav ? "OK" : "WAV sink not open";
+}
+
+void WavA2DPSink::finish() {
+    std::lock_guard<std::mutex> guard(lock);
+    if (audible) {
+        native_event(queue_end_us + latency_us, "silence", "exit");
+        audible = false;
+    }
+    if (!wav) return;
+    write_header();
+    fclose(wav);
+    wav = nullptr;
+    connected = false;
+}
+
+BluetoothA2DP* create_bluetooth_a2dp() {
+    return &g_wav_sink;
+}
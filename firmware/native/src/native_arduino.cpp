@@ -0,0 +1,226 @@
+#include "native_host.h"
+#include "config.h"
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <cstdarg>
+#include <cstring>
+#include <mutex>
+#include <poll.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/* ============================================================================
+ * Arduino Core Fake Implementation (native host)
+ * Serial is stdout/stdin. GPIO levels are driven by a script thread that
+ * replays NATIVE_BUTTONS and calls the attached handlers with the ISR flag
+ * set, the way the GPIO interrupt would.
+ * ========================================================================== */
+
+HardwareSerial Serial;
+EspClass ESP;
+
+extern thread_local bool native_in_isr;
+
+static std::mutex serial_lock;
+
+/* ----- Serial ----- */
+
+void HardwareSerial::begin(unsigned long baud) {
+}
+
+int HardwareSerial::printf(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    std::lock_guard<std::mutex> guard(serial_lock);
+    int n = vfprintf(stdout, fmt, args);
+    va_end(args);
+    return n;
+}
+
+size_t HardwareSerial::print(const char* text) {
+    std::lock_guard<std::mutex> guard(serial_lock);
+    return (size_t)fputs(text, stdout);
+}
+
+size_t HardwareSerial::println(const char* text) {
+    std::lock_guard<std::mutex> guard(serial_lock);
+    fputs(text, stdout);
+    fputc('\n', stdout);
+    return strlen(text) + 1;
+}
+
+size_t HardwareSerial::write(uint8_t byte) {
+    std::lock_guard<std::mutex> guard(serial_lock);
+    return fputc(byte, stdout) == EOF ? 0 : 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t len) {
+    std::lock_guard<std::mutex> guard(serial_lock);
+    return fwrite(data, 1, len, stdout);
+}
+
+int HardwareSerial::available() {
+    struct pollfd fd = {STDIN_FILENO, POLLIN, 0};
+    return (poll(&fd, 1, 0) > 0 && (fd.revents & POLLIN)) ? 1 : 0;
+}
+
+int HardwareSerial::read() {
+    if (!available()) return -1;
+    uint8_t byte;
+    return (::read(STDIN_FILENO, &byte, 1) == 1) ? byte : -1;
+}
+
+int HardwareSerial::availableForWrite() {
+    return 128;
+}
+
+void HardwareSerial::flush() {
+    std::lock_guard<std::mutex> guard(serial_lock);
+    fflush(stdout);
+}
+
+/* ----- ESP / timing ----- */
+
+uint32_t EspClass::getFreeHeap() {
+    return 240 * 1024;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    return 240 * 1024;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+    return 110 * 1024;
+}
+
+uint32_t EspClass::getCycleCount() {
+    /* Real (unscaled) time, so trace and log costs are host costs */
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(NativeClock::now().time_since_epoch());
+    return (uint32_t)((uint64_t)ns.count() * 240 / 1000);
+}
+
+uint32_t getCpuFrequencyMhz() {
+    return 240;
+}
+
+uint32_t millis() {
+    return (uint32_t)(native_time_us() / 1000);
+}
+
+uint32_t micros() {
+    return (uint32_t)native_time_us();
+}
+
+void delay(uint32_t ms) {
+    native_sleep_us((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+    native_sleep_us(us);
+}
+
+void yield() {
+    std::this_thread::yield();
+}
+
+/* ----- GPIO and scripted buttons ----- */
+
+static const uint8_t NATIVE_PINS = 40;
+static volatile uint8_t pin_level[NATIVE_PINS];
+static void (*volatile pin_handler[NATIVE_PINS])();
+
+struct ButtonStep {
+    uint32_t time_ms;
+    uint8_t pin;
+    uint8_t level;
+};
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < NATIVE_PINS && mode == INPUT_PULLUP) {
+        pin_level[pin] = HIGH;   /* Buttons idle high (pull-up, active low) */
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < NATIVE_PINS ? pin_level[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+    if (pin < NATIVE_PINS) pin_level[pin] = level;
+}
+
+void attachInterrupt(int pin, void (*handler)(), int mode) {
+    if (pin >= 0 && pin < NATIVE_PINS) pin_handler[pin] = handler;
+}
+
+void detachInterrupt(int pin) {
+    if (pin >= 0 && pin < NATIVE_PINS) pin_handler[pin] = nullptr;
+}
+
+void native_gpio_set(uint8_t pin, uint8_t level) {
+    if (pin >= NATIVE_PINS || pin_level[pin] == level) return;
+    pin_level[pin] = level;
+    
+    /* CHANGE interrupt, run in "ISR context" on the calling thread */
+    void (*handler)() = pin_handler[pin];
+    if (handler) {
+        native_in_isr = true;
+        handler();
+        native_in_isr = false;
+    }
+}
+
+static bool parse_script(const char* path, std::vector<ButtonStep>& steps) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "[NATIVE] Button script %s not found\n", path);
+        return false;
+    }
+    
+    char line[128];
+    while (fgets(line, sizeof(line), f)) {
+        unsigned ms;
+        char name[16], action[16];
+        if (line[0] == '#' || sscanf(line, "%u %15s %15s", &ms, name, action) != 3) continue;
+        
+        ButtonStep step;
+        step.time_ms = ms;
+        if (strcmp(name, "PREV") == 0) step.pin = BTN_PREV_PIN;
+        else if (strcmp(name, "PLAY") == 0) step.pin = BTN_PLAY_PIN;
+        else if (strcmp(name, "NEXT") == 0) step.pin = BTN_NEXT_PIN;
+        else continue;
+        step.level = (strcmp(action, "down") == 0) ? LOW : HIGH;
+        steps.push_back(step);
+    }
+    fclose(f);
+    return true;
+}
+
+void native_gpio_start() {
+    const char* path = native_env("NATIVE_BUTTONS", nullptr);
+    if (!path) return;
+    
+    std::vector<ButtonStep> steps;
+    if (!parse_script(path, steps)) return;
+    fprintf(stderr, "[NATIVE] Replaying %u button steps from %s\n", (unsigned)steps.size(), path);
+    
+    /* Script time 0 is "ready": setup() has just returned */
+    uint64_t base_us = native_time_us();
+    std::thread([steps, base_us]() {
+        for (const ButtonStep& step : steps) {
+            uint64_t now_us = native_time_us();
+            uint64_t at_us = base_us + (uint64_t)step.time_ms * 1000;
+            if (at_us > now_us) native_sleep_us(at_us - now_us);
+            
+            if (pin_level[step.pin] == step.level) continue;
+            
+            char detail[16];
+            snprintf(detail, sizeof(detail), "%s %s",
+                     step.pin == BTN_PREV_PIN ? "PREV" : step.pin == BTN_PLAY_PIN ? "PLAY" : "NEXT",
+                     step.level == LOW ? "down" : "up");
+            native_event(native_time_us(), "button", detail);
+            native_gpio_set(step.pin, step.level);
+        }
+    }).detach();
+}
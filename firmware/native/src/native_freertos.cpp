@@ -0,0 +1,345 @@
+#include "native_host.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <Arduino.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <pthread.h>
+#include <thread>
+#include <vector>
+
+/* ============================================================================
+ * FreeRTOS Shim Implementation (native host)
+ * Tasks are detached pthreads on painted stacks, so the stack high-water
+ * mark is measured. Host frames are larger than Xtensa ones (64-bit
+ * pointers, glibc stdio), so a thread gets STACK_HOST_FACTOR times its
+ * budget and the high-water mark reports the same fraction of the ESP32
+ * budget as is left of the host stack. Treat it as a trend, not a byte
+ * count: the device figure comes from its own uxTaskGetStackHighWaterMark.
+ * ========================================================================== */
+
+static const uint8_t STACK_PAINT = 0xA5;
+static const size_t STACK_HOST_FACTOR = 4;
+static const size_t STACK_HOST_MIN = 64 * 1024;
+
+struct NativeTask {
+    const char* name;
+    uint32_t stack_bytes;
+    BaseType_t core;
+    
+    NativeTask(const char* name = "", uint32_t stack_bytes = 0, BaseType_t core = 0)
+        : name(name), stack_bytes(stack_bytes), core(core) {}
+    
+    std::mutex lock;
+    std::condition_variable cv;
+    uint32_t notify_count = 0;
+    
+    uint8_t* stack = nullptr;   /* Painted; lowest address is the far end */
+    size_t stack_alloc = 0;
+    TaskFunction_t fn = nullptr;
+    void* arg = nullptr;
+};
+
+struct NativeQueue {
+    std::mutex lock;
+    std::condition_variable cv;
+    size_t item_size;
+    size_t length;
+    std::deque<std::vector<uint8_t>> items;
+};
+
+struct NativeSemaphore {
+    std::mutex lock;
+    std::condition_variable cv;
+    UBaseType_t count;
+    UBaseType_t max_count;
+    
+    /* Recursive mutexes: holder (by thread) and nesting depth */
+    std::thread::id owner;
+    UBaseType_t depth = 0;
+};
+
+/* The main thread is Arduino's loopTask (8 KB stack, core 1) */
+static NativeTask loop_task_record("loopTask", 8192, 1);
+static thread_local NativeTask* current_task = &loop_task_record;
+thread_local bool native_in_isr = false;
+
+static std::atomic<int> next_thread_token(1);
+static thread_local int thread_token = 0;
+
+/* ----- Critical sections ----- */
+
+void native_mux_enter(portMUX_TYPE* mux) {
+    if (thread_token == 0) thread_token = next_thread_token++;
+    
+    if (__atomic_load_n(&mux->owner, __ATOMIC_ACQUIRE) == thread_token) {
+        mux->count++;   /* Nested entry by the owner */
+        return;
+    }
+    int expected = 0;
+    while (!__atomic_compare_exchange_n(&mux->owner, &expected, thread_token, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        expected = 0;
+        std::this_thread::yield();
+    }
+    mux->count = 1;
+}
+
+void native_mux_exit(portMUX_TYPE* mux) {
+    if (--mux->count == 0) {
+        __atomic_store_n(&mux->owner, 0, __ATOMIC_RELEASE);
+    }
+}
+
+BaseType_t xPortGetCoreID() {
+    return current_task->core;
+}
+
+BaseType_t xPortInIsrContext() {
+    return native_in_isr ? pdTRUE : pdFALSE;
+}
+
+/* ----- Tasks ----- */
+
+static void* task_trampoline(void* param) {
+    NativeTask* task = static_cast<NativeTask*>(param);
+    current_task = task;
+    task->fn(task->arg);
+    return nullptr;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_bytes,
+                                   void* arg, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core) {
+    NativeTask* task = new NativeTask();
+    task->name = name;
+    task->stack_bytes = stack_bytes;
+    task->core = (core == tskNO_AFFINITY) ? 0 : core;
+    task->fn = fn;
+    task->arg = arg;
+    
+    size_t alloc = (size_t)stack_bytes * STACK_HOST_FACTOR;
+    if (alloc < STACK_HOST_MIN) alloc = STACK_HOST_MIN;
+    alloc = (alloc + 4095) & ~(size_t)4095;
+    void* stack = nullptr;
+    if (posix_memalign(&stack, 4096, alloc) != 0) {
+        delete task;
+        return pdFAIL;
+    }
+    memset(stack, STACK_PAINT, alloc);
+    task->stack = static_cast<uint8_t*>(stack);
+    task->stack_alloc = alloc;
+    
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack, alloc);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_t thread;
+    int err = pthread_create(&thread, &attr, task_trampoline, task);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        free(stack);
+        delete task;
+        return pdFAIL;
+    }
+    
+    if (handle) *handle = task;
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack_bytes,
+                       void* arg, UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(fn, name, stack_bytes, arg, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    /* Only self-deletion is used: park the thread for good */
+    if (task == nullptr || task == current_task) {
+        while (true) std::this_thread::sleep_for(std::chrono::hours(24));
+    }
+}
+
+void vTaskDelay(TickType_t ticks) {
+    native_sleep_us((uint64_t)ticks * 1000);
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)(native_time_us() / 1000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return current_task;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    NativeTask* t = task ? static_cast<NativeTask*>(task) : current_task;
+    if (!t->stack) return t->stack_bytes;   /* loopTask: main thread, not painted */
+    
+    size_t untouched = 0;
+    while (untouched < t->stack_alloc && t->stack[untouched] == STACK_PAINT) untouched++;
+    return (UBaseType_t)((uint64_t)untouched * t->stack_bytes / t->stack_alloc);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    NativeTask* t = current_task;
+    std::unique_lock<std::mutex> guard(t->lock);
+    t->cv.wait_until(guard, native_deadline_ms(ticks), [t]() { return t->notify_count > 0; });
+    
+    uint32_t value = t->notify_count;
+    if (value > 0) {
+        t->notify_count = clear_on_exit ? 0 : value - 1;
+    }
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    NativeTask* t = static_cast<NativeTask*>(task);
+    {
+        std::lock_guard<std::mutex> guard(t->lock);
+        t->notify_count++;
+    }
+    t->cv.notify_one();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    xTaskNotifyGive(task);
+    if (woken) *woken = pdTRUE;
+}
+
+/* ----- Queues ----- */
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    NativeQueue* q = new NativeQueue();
+    q->length = length;
+    q->item_size = item_size;
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete static_cast<NativeQueue*>(queue);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks) {
+    NativeQueue* q = static_cast<NativeQueue*>(queue);
+    std::unique_lock<std::mutex> guard(q->lock);
+    if (!q->cv.wait_until(guard, native_deadline_ms(ticks), [q]() { return q->items.size() < q->length; })) {
+        return pdFALSE;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(item);
+    q->items.emplace_back(bytes, bytes + q->item_size);
+    guard.unlock();
+    q->cv.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueSendToBackFromISR(QueueHandle_t queue, const void* item, BaseType_t* woken) {
+    BaseType_t sent = xQueueSendToBack(queue, item, 0);
+    if (sent && woken) *woken = pdTRUE;
+    return sent;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks) {
+    NativeQueue* q = static_cast<NativeQueue*>(queue);
+    std::unique_lock<std::mutex> guard(q->lock);
+    if (!q->cv.wait_until(guard, native_deadline_ms(ticks), [q]() { return !q->items.empty(); })) {
+        return pdFALSE;
+    }
+    memcpy(item, q->items.front().data(), q->item_size);
+    q->items.pop_front();
+    guard.unlock();
+    q->cv.notify_all();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    NativeQueue* q = static_cast<NativeQueue*>(queue);
+    std::lock_guard<std::mutex> guard(q->lock);
+    return (UBaseType_t)q->items.size();
+}
+
+UBaseType_t uxQueueMessagesWaitingFromISR(QueueHandle_t queue) {
+    return uxQueueMessagesWaiting(queue);
+}
+
+/* ----- Semaphores ----- */
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial) {
+    NativeSemaphore* s = new NativeSemaphore();
+    s->count = initial;
+    s->max_count = max_count;
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return xSemaphoreCreateCounting(1, 0);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete static_cast<NativeSemaphore*>(semaphore);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    NativeSemaphore* s = static_cast<NativeSemaphore*>(semaphore);
+    std::unique_lock<std::mutex> guard(s->lock);
+    if (!s->cv.wait_until(guard, native_deadline_ms(ticks), [s]() { return s->count > 0; })) {
+        return pdFALSE;
+    }
+    s->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    NativeSemaphore* s = static_cast<NativeSemaphore*>(semaphore);
+    {
+        std::lock_guard<std::mutex> guard(s->lock);
+        if (s->count >= s->max_count) return pdFALSE;
+        s->count++;
+    }
+    s->cv.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* woken) {
+    BaseType_t given = xSemaphoreGive(semaphore);
+    if (given && woken) *woken = pdTRUE;
+    return given;
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+    return xSemaphoreCreateCounting(1, 1);
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    NativeSemaphore* s = static_cast<NativeSemaphore*>(semaphore);
+    std::thread::id self = std::this_thread::get_id();
+    std::unique_lock<std::mutex> guard(s->lock);
+    if (s->depth > 0 && s->owner == self) {
+        s->depth++;
+        return pdTRUE;
+    }
+    if (!s->cv.wait_until(guard, native_deadline_ms(ticks), [s]() { return s->count > 0; })) {
+        return pdFALSE;
+    }
+    s->count--;
+    s->owner = self;
+    s->depth = 1;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore) {
+    NativeSemaphore* s = static_cast<NativeSemaphore*>(semaphore);
+    {
+        std::lock_guard<std::mutex> guard(s->lock);
+        if (s->depth == 0 || s->owner != std::this_thread::get_id()) return pdFALSE;
+        if (--s->depth > 0) return pdTRUE;
+        s->count++;
+    }
+    s->cv.notify_one();
+    return pdTRUE;
+}
@@ -0,0 +1,126 @@
+#include "native_host.h"
+#include <Arduino.h>
+#include <csignal>
+#include <cstdlib>
+#include <unistd.h>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+/* ============================================================================
+ * Native Host Entry Point
+ * Plays the role of the Arduino core's app_main: runs setup() once, then
+ * loop() forever (or until NATIVE_RUN_MS of virtual time has passed) on
+ * the main thread, which stands in for loopTask.
+ * ========================================================================== */
+
+/* Arduino sketch entry points (firmware/src/main.cpp) */
+void setup();
+void loop();
+
+static NativeClock::time_point start_time = NativeClock::now();
+static double time_scale = 1.0;
+
+static std::mutex event_lock;
+static FILE* event_log = nullptr;
+static std::mt19937 jitter_rng;
+
+static std::mutex exit_lock;
+static std::vector<void (*)()> exit_hooks;
+
+uint64_t native_time_us() {
+    auto real = std::chrono::duration_cast<std::chrono::nanoseconds>(NativeClock::now() - start_time);
+    return (uint64_t)(real.count() * time_scale / 1000.0);
+}
+
+void native_sleep_us(uint64_t virtual_us) {
+    std::this_thread::sleep_for(std::chrono::nanoseconds((int64_t)(virtual_us * 1000.0 / time_scale)));
+}
+
+NativeClock::time_point native_deadline_ms(uint32_t virtual_ms) {
+    /* "Forever" becomes a day of real time: long enough, no overflow */
+    if (virtual_ms == 0xFFFFFFFFu) {
+        return NativeClock::now() + std::chrono::hours(24);
+    }
+    return NativeClock::now() + std::chrono::nanoseconds((int64_t)(virtual_ms * 1e6 / time_scale));
+}
+
+const char* native_env(const char* name, const char* fallback) {
+    const char* value = getenv(name);
+    return (value && *value) ? value : fallback;
+}
+
+uint32_t native_env_u32(const char* name, uint32_t fallback) {
+    const char* value = getenv(name);
+    return (value && *value) ? (uint32_t)strtoul(value, nullptr, 0) : fallback;
+}
+
+uint32_t native_jitter_us(uint32_t max_us) {
+    if (max_us == 0) return 0;
+    std::lock_guard<std::mutex> guard(event_lock);
+    return (uint32_t)(jitter_rng() % (max_us + 1));
+}
+
+void native_event(uint64_t virtual_us, const char* event, const char* detail) {
+    std::lock_guard<std::mutex> guard(event_lock);
+    if (!event_log) return;
+    fprintf(event_log, "%llu %s%s%s\n", (unsigned long long)virtual_us, event,
+            detail ? " " : "", detail ? detail : "");
+}
+
+void native_at_exit(void (*fn)()) {
+    std::lock_guard<std::mutex> guard(exit_lock);
+    exit_hooks.push_back(fn);
+}
+
+static void run_exit_hooks() {
+    std::lock_guard<std::mutex> guard(exit_lock);
+    for (auto it = exit_hooks.rbegin(); it != exit_hooks.rend(); ++it) {
+        (*it)();
+    }
+    exit_hooks.clear();
+}
+
+void native_exit(int status) {
+    /* Tasks are still running: skip static destructors under their feet */
+    run_exit_hooks();
+    if (event_log) fclose(event_log);
+    fflush(stdout);
+    _exit(status);
+}
+
+static void on_signal(int) {
+    /* Ctrl-C: finish the WAV header and last frame, then leave */
+    native_exit(0);
+}
+
+int main() {
+    time_scale = atof(native_env("NATIVE_TIME_SCALE", "1"));
+    if (time_scale <= 0) time_scale = 1.0;
+    uint64_t run_us = (uint64_t)atoll(native_env("NATIVE_RUN_MS", "0")) * 1000;
+    
+    jitter_rng.seed(native_env_u32("NATIVE_SEED", 1));
+    
+    const char* log_path = native_env("NATIVE_EVENT_LOG", nullptr);
+    if (log_path) {
+        event_log = fopen(log_path, "w");
+        if (!event_log) fprintf(stderr, "[NATIVE] Cannot create %s\n", log_path);
+    }
+    
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    
+    fprintf(stderr, "[NATIVE] time scale %.1fx, run %s\n", time_scale,
+            run_us ? native_env("NATIVE_RUN_MS", "") : "until interrupted");
+    
+    setup();
+    native_event(native_time_us(), "ready", nullptr);
+    native_gpio_start();
+    while (run_us == 0 || native_time_us() < run_us) {
+        loop();
+    }
+    
+    native_exit(0);
+}
@@ -0,0 +1,235 @@
+#include "native_host.h"
+#include "config.h"
+#include <Arduino.h>
+#include <Wire.h>
+#include <cstring>
+#include <mutex>
+
+/* ============================================================================
+ * SSD1306 Panel Fake (native host)
+ * Decodes the I2C byte stream the real controller would see: control byte,
+ * commands with their argument counts, and GDDRAM writes through the
+ * column/page address window in horizontal addressing mode. Each
+ * transmission takes its bus time at the configured I2C clock (9 bits per
+ * byte), so flush timing matches the hardware.
+ *
+ * Frames are written as PBM (P4): the latest to ./display.pbm, and with
+ * NATIVE_PBM_DIR set, one numbered file per changed frame, at most
+ * DISPLAY_REFRESH_HZ per virtual second.
+ * ========================================================================== */
+
+TwoWire Wire;
+
+class SSD1306Panel {
+private:
+    uint8_t gddram[DISPLAY_PAGES][DISPLAY_WIDTH];
+    bool display_on = false;
+    
+    uint8_t col_start = 0, col_end = DISPLAY_WIDTH - 1;
+    uint8_t page_start = 0, page_end = DISPLAY_PAGES - 1;
+    uint8_t col = 0, page = 0;
+    
+    /* Command parser: opcode waiting for `args_left` argument bytes */
+    uint8_t opcode = 0;
+    uint8_t args[2];
+    uint8_t args_seen = 0;
+    uint8_t args_left = 0;
+    
+    bool dirty = false;
+    uint64_t last_dump_us = 0;
+    uint32_t frame_number = 0;
+    std::mutex lock;
+    
+    void command_byte(uint8_t byte);
+    void run_command();
+    void data_byte(uint8_t byte);
+    void write_pbm(const char* path);
+    void maybe_dump();
+
+public:
+    SSD1306Panel() { memset(gddram, 0, sizeof(gddram)); }
+    void transmission(const uint8_t* bytes, size_t len);
+    void read_gddram(uint8_t* out);
+    void dump_last();
+};
+
+static SSD1306Panel panel;
+
+static uint8_t argument_count(uint8_t op) {
+    switch (op) {
+        case 0x21: case 0x22: return 2;   /* Column / page address */
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+        case 0xD5: case 0xD9: case 0xDA: case 0xDB: return 1;
+        default: return 0;
+    }
+}
+
+void SSD1306Panel::command_byte(uint8_t byte) {
+    if (args_left > 0) {
+        args[args_seen++] = byte;
+        if (--args_left == 0) run_command();
+        return;
+    }
+    opcode = byte;
+    args_seen = 0;
+    args_left = argument_count(byte);
+    if (args_left == 0) run_command();
+}
+
+void SSD1306Panel::run_command() {
+    switch (opcode) {
+        case 0x21:
+            col_start = col = args[0] & 0x7F;
+            col_end = args[1] & 0x7F;
+            break;
+        case 0x22:
+            page_start = page = args[0] & 0x07;
+            page_end = args[1] & 0x07;
+            break;
+        case 0xAE:
+            display_on = false;
+            dirty = true;
+            break;
+        case 0xAF:
+            display_on = true;
+            dirty = true;
+            break;
+        default:
+            break;   /* Timing/analog setup has no visible effect here */
+    }
+}
+
+void SSD1306Panel::data_byte(uint8_t byte) {
+    gddram[page][col] = byte;
+    dirty = true;
+    
+    /* Horizontal addressing: wrap inside the window */
+    if (col == col_end) {
+        col = col_start;
+        page = (page == page_end) ? page_start : page + 1;
+    } else {
+        col++;
+    }
+}
+
+void SSD1306Panel::transmission(const uint8_t* bytes, size_t len) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (len == 0) return;
+    
+    uint8_t control = bytes[0];
+    if (control == 0x80) {
+        /* Single command byte per control byte (Co = 1) */
+        for (size_t i = 1; i < len; i += 2) {
+            command_byte(bytes[i]);
+        }
+    } else if (control & 0x40) {
+        for (size_t i = 1; i < len; i++) data_byte(bytes[i]);
+    } else {
+        for (size_t i = 1; i < len; i++) command_byte(bytes[i]);
+    }
+    maybe_dump();
+}
+
+void SSD1306Panel::write_pbm(const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return;
+    
+    fprintf(f, "P4\n%d %d\n", DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    for (uint8_t y = 0; y < DISPLAY_HEIGHT; y++) {
+        uint8_t row[DISPLAY_WIDTH / 8] = {0};
+        for (uint8_t x = 0; x < DISPLAY_WIDTH; x++) {
+            bool on = display_on && (gddram[y / 8][x] >> (y % 8)) & 1;
+            if (on) row[x / 8] |= 0x80 >> (x % 8);   /* PBM: 1 = black ink = lit pixel */
+        }
+        fwrite(row, 1, sizeof(row), f);
+    }
+    fclose(f);
+}
+
+void SSD1306Panel::maybe_dump() {
+    uint64_t now = native_time_us();
+    if (!dirty || now - last_dump_us < 1000000 / DISPLAY_REFRESH_HZ) return;
+    
+    dirty = false;
+    last_dump_us = now;
+    write_pbm("display.pbm");
+    
+    const char* dir = native_env("NATIVE_PBM_DIR", nullptr);
+    if (dir) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/frame_%05u.pbm", dir, (unsigned)frame_number++);
+        write_pbm(path);
+    }
+}
+
+void SSD1306Panel::read_gddram(uint8_t* out) {
+    std::lock_guard<std::mutex> guard(lock);
+    memcpy(out, gddram, sizeof(gddram));
+}
+
+void SSD1306Panel::dump_last() {
+    std::lock_guard<std::mutex> guard(lock);
+    write_pbm("display.pbm");
+}
+
+static void flush_panel() {
+    panel.dump_last();
+}
+
+void native_panel_read(uint8_t* gddram) {
+    panel.read_gddram(gddram);
+}
+
+/* ----- TwoWire ----- */
+
+static uint32_t bus_hz = 100000;
+static NativeI2CStats i2c_stats = {};
+static std::mutex i2c_stats_lock;
+
+NativeI2CStats native_i2c_stats() {
+    std::lock_guard<std::mutex> guard(i2c_stats_lock);
+    return i2c_stats;
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+    static bool hooked = false;
+    if (frequency) bus_hz = frequency;
+    if (!hooked) {
+        native_at_exit(flush_panel);
+        hooked = true;
+    }
+    return true;
+}
+
+void TwoWire::beginTransmission(uint8_t addr) {
+    address = addr;
+    length = 0;
+}
+
+size_t TwoWire::write(uint8_t byte) {
+    if (length >= sizeof(buffer)) return 0;
+    buffer[length++] = byte;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t len) {
+    size_t n = 0;
+    while (n < len && write(data[n])) n++;
+    return n;
+}
+
+uint8_t TwoWire::endTransmission(bool stop) {
+    if (address != SSD1306_I2C_ADDR) return 2;   /* NACK on address */
+    
+    /* Address byte + payload, 9 clocks each */
+    native_sleep_us((uint64_t)(length + 1) * 9 * 1000000 / bus_hz);
+    {
+        std::lock_guard<std::mutex> guard(i2c_stats_lock);
+        i2c_stats.transmissions++;
+        i2c_stats.bytes += length + 1;
+        if (length > i2c_stats.largest) i2c_stats.largest = length;
+    }
+    panel.transmission(buffer, length);
+    length = 0;
+    return 0;
+}
@@ -0,0 +1,281 @@
+#include "native_host.h"
+#include <Arduino.h>
+#include <SD.h>
+#include <Preferences.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+
+/* ============================================================================
+ * SD Card and NVS Fakes (native host)
+ * The card is a host directory. Opens, seeks and reads are charged the
+ * NATIVE_SD_* timing model (command latency plus transfer time) on the
+ * calling thread, the way a blocking SPI transaction would be. There is one
+ * bus: a task accessing the card while another does waits its turn.
+ * ========================================================================== */
+
+SDFS SD;
+SPIClass SPI;
+
+static std::atomic<uint64_t> sd_bytes_read(0);
+static std::atomic<uint64_t> sd_opens(0);
+
+struct NativeFileHandle {
+    FILE* fp = nullptr;
+    DIR* dir = nullptr;
+    std::string path;      /* Volume path, e.g. "/music/a.mp3" */
+    std::string host_path;
+    size_t size = 0;
+    
+    ~NativeFileHandle() {
+        if (fp) fclose(fp);
+        if (dir) closedir(dir);
+    }
+};
+
+static void sd_access(size_t bytes) {
+    static const uint32_t access_us = native_env_u32("NATIVE_SD_ACCESS_US", 0);
+    static const uint32_t kbps = native_env_u32("NATIVE_SD_KBPS", 0);
+    static const uint32_t jitter_us = native_env_u32("NATIVE_SD_JITTER_US", 0);
+    
+    static std::mutex bus;
+    
+    uint64_t cost_us = access_us + native_jitter_us(jitter_us);
+    if (kbps > 0) cost_us += (uint64_t)bytes * 1000000 / ((uint64_t)kbps * 1024);
+    if (cost_us > 0) {
+        std::lock_guard<std::mutex> guard(bus);
+        native_sleep_us(cost_us);
+    }
+}
+
+static std::string host_path_of(const char* path) {
+    std::string root = native_env("NATIVE_SD_ROOT", "sdcard");
+    if (!path || path[0] != '/') root += '/';
+    return root + (path ? path : "");
+}
+
+static File open_path(const std::string& volume_path, const char* mode) {
+    std::shared_ptr<NativeFileHandle> h = std::make_shared<NativeFileHandle>();
+    h->path = volume_path;
+    h->host_path = host_path_of(volume_path.c_str());
+    sd_access(0);
+    sd_opens++;
+    
+    struct stat st;
+    bool exists = stat(h->host_path.c_str(), &st) == 0;
+    if (exists && S_ISDIR(st.st_mode)) {
+        h->dir = opendir(h->host_path.c_str());
+        if (!h->dir) return File();
+        return File(h);
+    }
+    if (!exists && strcmp(mode, FILE_READ) == 0) return File();
+    
+    const char* host_mode = (strcmp(mode, FILE_READ) == 0) ? "rb" :
+                            (strcmp(mode, FILE_APPEND) == 0) ? "ab" : "wb";
+    h->fp = fopen(h->host_path.c_str(), host_mode);
+    if (!h->fp) return File();
+    h->size = exists ? (size_t)st.st_size : 0;
+    return File(h);
+}
+
+uint64_t native_sd_bytes_read() {
+    return sd_bytes_read;
+}
+
+uint64_t native_sd_opens() {
+    return sd_opens;
+}
+
+/* ----- File ----- */
+
+File::operator bool() const {
+    return handle && (handle->fp || handle->dir);
+}
+
+int File::read(uint8_t* buffer, size_t len) {
+    if (!handle || !handle->fp) return -1;
+    sd_access(len);
+    size_t n = fread(buffer, 1, len, handle->fp);
+    sd_bytes_read += n;
+    return (int)n;
+}
+
+int File::read() {
+    uint8_t byte;
+    return (read(&byte, 1) == 1) ? byte : -1;
+}
+
+size_t File::write(const uint8_t* data, size_t len) {
+    if (!handle || !handle->fp) return 0;
+    size_t n = fwrite(data, 1, len, handle->fp);
+    long pos = ftell(handle->fp);
+    if (pos > (long)handle->size) handle->size = (size_t)pos;
+    return n;
+}
+
+bool File::seek(uint32_t position) {
+    if (!handle || !handle->fp || position > handle->size) return false;
+    sd_access(0);
+    return fseek(handle->fp, (long)position, SEEK_SET) == 0;
+}
+
+size_t File::position() const {
+    return (handle && handle->fp) ? (size_t)ftell(handle->fp) : 0;
+}
+
+size_t File::size() const {
+    return handle ? handle->size : 0;
+}
+
+int File::available() {
+    return (int)(size() - position());
+}
+
+void File::flush() {
+    if (handle && handle->fp) fflush(handle->fp);
+}
+
+void File::close() {
+    handle.reset();
+}
+
+bool File::isDirectory() const {
+    return handle && handle->dir;
+}
+
+File File::openNextFile() {
+    if (!handle || !handle->dir) return File();
+    
+    struct dirent* entry;
+    while ((entry = readdir(handle->dir)) != nullptr) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        std::string child = handle->path;
+        if (child.empty() || child.back() != '/') child += '/';
+        return open_path(child + entry->d_name, FILE_READ);
+    }
+    return File();
+}
+
+void File::rewindDirectory() {
+    if (handle && handle->dir) rewinddir(handle->dir);
+}
+
+bool File::seekDir(long position) {
+    /* FAT position = entries read; host cookies are opaque, so skip forward
+     * that many entries ("." and ".." excluded, as openNextFile() does) */
+    if (!handle || !handle->dir || position < 0) return false;
+    rewinddir(handle->dir);
+    sd_access(0);
+    
+    struct dirent* entry;
+    while (position > 0 && (entry = readdir(handle->dir)) != nullptr) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        position--;
+    }
+    return true;
+}
+
+const char* File::name() const {
+    /* Arduino-ESP32 2.x: last path component */
+    if (!handle) return "";
+    size_t slash = handle->path.find_last_of('/');
+    return handle->path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+const char* File::path() const {
+    return handle ? handle->path.c_str() : "";
+}
+
+/* ----- SD ----- */
+
+bool SDFS::begin(uint8_t cs, SPIClass& spi, uint32_t frequency) {
+    struct stat st;
+    std::string root = host_path_of("/");
+    if (stat(root.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        fprintf(stderr, "[NATIVE] SD root %s missing (set NATIVE_SD_ROOT)\n", root.c_str());
+        return false;
+    }
+    /* Card identification and FAT mount */
+    native_sleep_us((uint64_t)native_env_u32("NATIVE_SD_MOUNT_MS", 0) * 1000);
+    return true;
+}
+
+void SDFS::end() {
+}
+
+File SDFS::open(const char* path, const char* mode) {
+    return open_path(path ? path : "/", mode);
+}
+
+bool SDFS::exists(const char* path) {
+    struct stat st;
+    return stat(host_path_of(path).c_str(), &st) == 0;
+}
+
+/* ----- Preferences ----- */
+
+void Preferences::key_path(const char* key, char* path, size_t len) const {
+    snprintf(path, len, "%s/%s.bin", dir, key);
+}
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    const char* base = native_env("NATIVE_NVS_DIR", "nvs");
+    mkdir(base, 0755);
+    snprintf(dir, sizeof(dir), "%s/%s", base, name);
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) return false;
+    read_only = readOnly;
+    opened = true;
+    return true;
+}
+
+void Preferences::end() {
+    opened = false;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+    if (!opened || read_only) return 0;
+    
+    /* Write-then-rename: a killed host run leaves the old value, like NVS */
+    char path[300], tmp[310];
+    key_path(key, path, sizeof(path));
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE* f = fopen(tmp, "wb");
+    if (!f) return 0;
+    size_t n = fwrite(value, 1, len, f);
+    fclose(f);
+    if (n != len || rename(tmp, path) != 0) return 0;
+    return len;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t max_len) {
+    if (!opened) return 0;
+    
+    /* Like NVS: a blob larger than the buffer is an error, not a truncation */
+    size_t stored = getBytesLength(key);
+    if (stored == 0 || stored > max_len) return 0;
+    
+    char path[300];
+    key_path(key, path, sizeof(path));
+    FILE* f = fopen(path, "rb");
+    if (!f) return 0;
+    size_t n = fread(buffer, 1, max_len, f);
+    fclose(f);
+    return n;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    char path[300];
+    key_path(key, path, sizeof(path));
+    struct stat st;
+    return (stat(path, &st) == 0) ? (size_t)st.st_size : 0;
+}
+
+bool Preferences::remove(const char* key) {
+    char path[300];
+    key_path(key, path, sizeof(path));
+    return ::remove(path) == 0;
+}
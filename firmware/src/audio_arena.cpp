@@ -0,0 +1,38 @@
+#include "audio_arena.h"
+#include <cstddef>
+
+/* ============================================================================
+ * Audio Memory Arena
+ * Zero-initialised static storage: .bss is internal DRAM on the ESP32,
+ * which DMA can reach, and unlike DRAM_ATTR it costs no flash.
+ *
+ * The layout is also recorded in .audio_arena_map, a section with no
+ * "alloc" flag: it stays in the ELF for tools/arena_map.py but is never
+ * loaded onto the chip. Each record is {offset, size, align} (u32) and
+ * the slice name; "(arena)", "(budget)" and "(work-budget)" close it.
+ * ========================================================================== */
+
+static AudioArena g_audio_arena;
+
+AudioArena& audio_arena() {
+    return g_audio_arena;
+}
+
+#define AUDIO_ARENA_RECORD(name, offset, size, align) \
+    asm volatile(".pushsection .audio_arena_map, \"\"\n" \
+                 ".balign 4\n" \
+                 ".long %c0, %c1, %c2\n" \
+                 ".asciz \"" name "\"\n" \
+                 ".popsection" \
+                 : : "i"(offset), "i"(size), "i"(align))
+
+/* Never called: compiling it is what emits the map */
+__attribute__((used)) void audio_arena_map() {
+#define AUDIO_ARENA_SLICE_RECORD(name, type, count) \
+    AUDIO_ARENA_RECORD(#name, offsetof(AudioArena, name), sizeof(AudioArena::name), AUDIO_ARENA_ALIGN);
+    AUDIO_ARENA_SLICES(AUDIO_ARENA_SLICE_RECORD)
+#undef AUDIO_ARENA_SLICE_RECORD
+    AUDIO_ARENA_RECORD("(arena)", 0, sizeof(AudioArena), alignof(AudioArena));
+    AUDIO_ARENA_RECORD("(budget)", 0, AUDIO_ARENA_BUDGET, 0);
+    AUDIO_ARENA_RECORD("(work-budget)", 0, AUDIO_ARENA_WORK_BUDGET, 0);
+}
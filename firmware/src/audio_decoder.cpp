@@ -1,6 +1,9 @@
 #include "audio_decoder.h"
+#include "audio_arena.h"
 #include "config.h"
 #include "sd_card.h"
+#include "trace.h"
+#include "log.h"
 #include <cstring>
 #include <Arduino.h>
 
@@ -8,37 +11,85 @@
  * MP3 Decoder Implementation
  * Handles MP3 frame parsing, decoding, and PCM output
  * Uses frame sync detection + dummy decode (libhelix to be integrated)
+ * Seeking never decodes: the target byte is estimated from the bitrate,
+ * then a small window is scanned for a sync word whose successor frame
+ * also checks out (resync), so playback restarts on a real frame boundary.
+ * decode_frame() walks the file frame by frame through a read window; a
+ * frame whose header or successor does not check out is skipped by the
+ * same resync, and counted in DecoderStats.
  * ========================================================================== */
 
+#define LOG_MODULE LOG_MOD_AUDIO
+
+/* Longest Layer III frame (320 kbps @ 32 kHz, padded) plus the successor's
+ * sync bytes: the read window is topped up below this */
+static const size_t WINDOW_REFILL = 1441 + 2;
+
+/* Layer III bitrates (kbps) by index: [0] = MPEG-1, [1] = MPEG-2/2.5 */
+static const uint16_t L3_BITRATES[2][15] = {
+    {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320},
+    {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160},
+};
+
 class MP3Decoder : public AudioDecoder {
 private:
     bool is_open = false;
     uint32_t duration_ms = 0;
     uint32_t current_pos_ms = 0;
+    uint32_t frame_index = 0;  /* Frames from data_start (position without drift) */
     uint32_t total_frames = 0;
+    uint32_t byte_offset = 0;  /* Start of next frame in the file */
     
     int sample_rate = 0;
     int channels = 0;
     int bitrate = 0;
+    uint16_t samples_per_frame = 1152;
+    
+    /* Stream layout from the first frame (seek/resync reference) */
+    SDCard* sd = nullptr;
+    bool file_open = false;
+    uint32_t data_start = 0;   /* First frame, after any ID3v2 tag */
+    uint32_t file_size = 0;
+    uint8_t stream_h1 = 0;     /* Version/layer bits every frame must share */
+    uint8_t stream_sr_bits = 0;
     
-    uint8_t frame_buffer[2048];
+    /* Read window: file bytes [buffer_base, buffer_base + frame_buffer_len) */
+    static const size_t WINDOW_SIZE = sizeof(AudioArena::decoder_input);
+    uint8_t* const frame_buffer = audio_arena().decoder_input;
     size_t frame_buffer_len = 0;
+    uint32_t buffer_base = 0;
+    bool in_sync = false;      /* Last frame was accepted: trust the next header */
     
-    bool find_frame_sync(const uint8_t* data, size_t len, size_t& sync_pos);
-    bool parse_frame_header(const uint8_t* header);
+    uint32_t resyncs = 0;
+    uint32_t skipped_bytes = 0;
     
+    static bool find_frame_sync(const uint8_t* data, size_t len, size_t& sync_pos);
+    bool parse_frame_header(const uint8_t* header);
+    uint32_t frame_length(const uint8_t* header) const;
+    bool probe_stream();
+    uint32_t checked_length(const uint8_t* header) const;
+    bool resync(const uint8_t* data, size_t len, size_t& sync_pos) const;
+    size_t fill_window();
+    uint32_t next_frame();
+
 public:
     bool open(const char* filepath) override;
     int decode_frame(int16_t* pcm_buffer, size_t max_samples) override;
     void close() override;
     uint32_t get_duration_ms() const override;
     uint32_t get_current_position_ms() const override;
+    bool seek(uint32_t position_ms) override;
+    uint32_t get_byte_offset() const override;
+    bool resume_at(uint32_t offset, uint32_t position_ms) override;
+    uint32_t get_sample_rate() const override;
+    bool get_stats(DecoderStats& out) const override;
+    bool has_synthesis() const override;
     const char* get_error_message() const override;
 };
 
 bool MP3Decoder::find_frame_sync(const uint8_t* data, size_t len, size_t& sync_pos) {
     /* MP3 frame sync: 11 consecutive '1' bits (0xFFF pattern) */
-    for (size_t i = 0; i < len - 1; i++) {
+    for (size_t i = 0; i + 1 < len; i++) {
         if (data[i] == 0xFF && (data[i + 1] & 0xE0) == 0xE0) {
             sync_pos = i;
             return true;
@@ -52,6 +103,7 @@ bool MP3Decoder::parse_frame_header(const uint8_t* header) {
     
     uint8_t h1 = header[1];
     uint8_t h2 = header[2];
+    uint8_t h3 = header[3];
     
     /* MPEG version (bits 3-4 of h1): 11=v1, 10=v2, 00=v2.5 */
     int version = (h1 >> 3) & 0x03;
@@ -71,79 +123,235 @@ bool MP3Decoder::parse_frame_header(const uint8_t* header) {
     
     if (sample_rate == 0) return false;
     
-    /* Channels: bits 6-7 of h1 */
-    int mode = (h1 >> 6) & 0x03;
+    /* Channel mode: bits 6-7 of h3 (11 = mono) */
+    int mode = (h3 >> 6) & 0x03;
     channels = (mode == 3) ? 1 : 2;
     
-    /* Bitrate index (bits 4-7 of h1) */
-    int br_idx = (h1 >> 4) & 0x0F;
+    /* Bitrate index (bits 4-7 of h2); Layer III tables */
+    int br_idx = (h2 >> 4) & 0x0F;
     if (br_idx > 0 && br_idx < 15) {
-        static const int bitrates[] = {
-            0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320
-        };
-        bitrate = bitrates[br_idx] * 1000;
+        bitrate = L3_BITRATES[(version == 3) ? 0 : 1][br_idx] * 1000;
     } else {
         return false;
     }
     
+    samples_per_frame = (version == 3) ? 1152 : 576;
     return true;
 }
 
+uint32_t MP3Decoder::frame_length(const uint8_t* header) const {
+    /* Layer III: 144 (MPEG-1) or 72 (MPEG-2) * bitrate / rate + padding */
+    bool v1 = ((header[1] >> 3) & 0x03) == 3;
+    int br_idx = (header[2] >> 4) & 0x0F;
+    if (br_idx == 0 || br_idx == 15 || sample_rate == 0) return 0;
+    
+    uint32_t kbps = L3_BITRATES[v1 ? 0 : 1][br_idx];
+    uint32_t padding = (header[2] >> 1) & 0x01;
+    return (v1 ? 144000 : 72000) * kbps / sample_rate + padding;
+}
+
+/* Frame length if the header belongs to this stream, else 0 */
+uint32_t MP3Decoder::checked_length(const uint8_t* header) const {
+    /* Same version/layer and sample rate as the stream, valid bitrate */
+    if (header[0] != 0xFF || (header[1] & 0xFE) != stream_h1 || (header[2] & 0x0C) != stream_sr_bits) {
+        return 0;
+    }
+    return frame_length(header);
+}
+
+bool MP3Decoder::resync(const uint8_t* data, size_t len, size_t& sync_pos) const {
+    size_t start = 0;
+    size_t pos;
+    
+    while (start + 4 <= len && find_frame_sync(data + start, len - start, pos)) {
+        const uint8_t* h = data + start + pos;
+        size_t at = start + pos;
+        
+        uint32_t flen = checked_length(h);
+        if (flen > 0) {
+            /* Successor must sync too when it lies inside the window */
+            if (at + flen + 2 > len) {
+                sync_pos = at;
+                return true;
+            }
+            const uint8_t* next = h + flen;
+            if (next[0] == 0xFF && (next[1] & 0xFE) == stream_h1) {
+                sync_pos = at;
+                return true;
+            }
+        }
+        start = at + 1;
+    }
+    return false;
+}
+
+bool MP3Decoder::probe_stream() {
+    uint8_t* buf = frame_buffer;
+    
+    /* ID3v2 tag: 10-byte header + syncsafe size */
+    data_start = 0;
+    if (sd->read_data(buf, 10) == 10 && buf[0] == 'I' && buf[1] == 'D' && buf[2] == '3') {
+        data_start = 10 + (((uint32_t)(buf[6] & 0x7F) << 21) | ((uint32_t)(buf[7] & 0x7F) << 14) |
+                           ((uint32_t)(buf[8] & 0x7F) << 7) | (buf[9] & 0x7F));
+    }
+    
+    if (!sd->seek(data_start)) return false;
+    int n = sd->read_data(buf, WINDOW_SIZE);
+    if (n < 4) return false;
+    
+    size_t pos;
+    if (!find_frame_sync(buf, (size_t)n, pos) || pos + 4 > (size_t)n || !parse_frame_header(buf + pos)) {
+        return false;
+    }
+    
+    data_start += pos;
+    stream_h1 = buf[pos + 1] & 0xFE;
+    stream_sr_bits = buf[pos + 2] & 0x0C;
+    
+    /* CBR estimate (VBR files without a TOC are approximated the same way) */
+    if (file_size > data_start) {
+        duration_ms = (uint32_t)(((uint64_t)(file_size - data_start) * 8000) / bitrate);
+    }
+    
+    LOG_I("[MP3] Frame info: %d Hz, %d ch, %d kbps, data @ %u",
+         sample_rate, channels, bitrate / 1000, (unsigned)data_start);
+    return sd->seek(data_start);
+}
+
+/* Window bytes available at byte_offset: at least WINDOW_REFILL unless the
+ * file ends first */
+size_t MP3Decoder::fill_window() {
+    uint32_t end = buffer_base + (uint32_t)frame_buffer_len;
+    if (frame_buffer_len == 0 || byte_offset < buffer_base || byte_offset > end) {
+        /* Offset left the window (open, seek, resume): restart it there */
+        if (!sd->seek(byte_offset)) return 0;
+        buffer_base = byte_offset;
+        frame_buffer_len = 0;
+        end = byte_offset;
+    }
+    
+    size_t have = end - byte_offset;
+    if (have < WINDOW_REFILL) {
+        /* Keep the unread tail, top up from the file (sequential reads) */
+        memmove(frame_buffer, frame_buffer + (byte_offset - buffer_base), have);
+        buffer_base = byte_offset;
+        frame_buffer_len = have;
+        int n = sd->read_data(frame_buffer + have, WINDOW_SIZE - have);
+        if (n > 0) frame_buffer_len += (size_t)n;
+        have = frame_buffer_len;
+    }
+    return have;
+}
+
+/* Length of the valid frame at byte_offset, skipping damage first; 0 at end */
+uint32_t MP3Decoder::next_frame() {
+    while (true) {
+        size_t have = fill_window();
+        if (have < 4) return 0;
+        
+        /* In sync a valid header is enough; to (re)gain sync the successor
+         * must check out too, unless the frame ends the file */
+        const uint8_t* h = frame_buffer + (byte_offset - buffer_base);
+        uint32_t flen = checked_length(h);
+        if (flen > 0 && flen <= have) {
+            if (in_sync || flen + 2 > have ||
+                (h[flen] == 0xFF && (h[flen + 1] & 0xFE) == stream_h1)) {
+                in_sync = true;
+                return flen;
+            }
+        }
+        
+        /* Damaged or truncated frame: resume at the next plausible one */
+        size_t sync = 0;
+        size_t skip = resync(h + 1, have - 1, sync) ? 1 + sync : have - 3;
+        byte_offset += (uint32_t)skip;
+        skipped_bytes += (uint32_t)skip;
+        resyncs++;
+        in_sync = false;
+    }
+}
+
 bool MP3Decoder::open(const char* filepath) {
     if (!filepath) return false;
     
-    is_open = true;
-    frame_buffer_len = 0;
+    close();
     sample_rate = 0;
     channels = 0;
     bitrate = 0;
     duration_ms = 0;
     current_pos_ms = 0;
+    frame_index = 0;
     total_frames = 0;
+    byte_offset = 0;
+    samples_per_frame = 1152;
+    data_start = 0;
+    file_size = 0;
+    resyncs = 0;
+    skipped_bytes = 0;
+    
+    /* Read the first header now so duration and seeking are known up front */
+    extern SDCard* create_sd_card();
+    sd = create_sd_card();
+    file_open = sd && sd->is_mounted() && sd->open_file(filepath);
+    if (!file_open) {
+        LOG_W("[MP3] Cannot open track");
+        return false;
+    }
     
-    Serial.printf("[MP3] Opened file: %s\n", filepath);
+    file_size = (uint32_t)sd->get_file_size();
+    if (!probe_stream()) {
+        LOG_W("[MP3] No valid frame header in %u bytes", (unsigned)file_size);
+        close();
+        sample_rate = 0;
+        return false;
+    }
+    
+    byte_offset = data_start;
+    frame_buffer_len = 0;
+    in_sync = false;
+    is_open = true;
+    
+    LOG_I("[MP3] Opened file (%u bytes)", (unsigned)file_size);
     return true;
 }
 
 int MP3Decoder::decode_frame(int16_t* pcm_buffer, size_t max_samples) {
+    TRACE_SCOPE(TRACE_DECODE_FRAME, total_frames);
+    
     if (!is_open || !pcm_buffer) {
         return -1;
     }
     
-    /* Placeholder decode: return silence for now */
+    /* Placeholder decode: frames are walked and validated, output is silence */
     /* Real implementation will integrate libhelix MP3Decode */
     
-    if (total_frames == 0) {
-        /* First frame: parse header and estimate duration */
-        if (frame_buffer_len < 4) {
-            return 0;  /* Need more data */
-        }
-        
-        if (!parse_frame_header(frame_buffer)) {
-            return -1;  /* Invalid frame */
-        }
-        
-        Serial.printf("[MP3] Frame info: %d Hz, %d ch, %d kbps\n",
-                     sample_rate, channels, bitrate/1000);
-    }
+    /* open() only succeeds on a probed stream, so a file is always behind it */
+    uint32_t flen = next_frame();
+    if (flen == 0) return 0;  /* End of stream */
     
-    /* Generate silence PCM output (1152 samples typical MP3 frame) */
-    size_t samples_per_frame = 1152;
-    size_t out_samples = (max_samples < samples_per_frame) ? max_samples : samples_per_frame;
+    /* Generate silence PCM output (one frame, interleaved as the sink plays it) */
+    size_t frame_samples = (size_t)samples_per_frame * AUDIO_CHANNELS;
+    size_t out_samples = (max_samples < frame_samples) ? max_samples : frame_samples;
     
     memset(pcm_buffer, 0, out_samples * sizeof(int16_t));
     
     /* Update tracking */
     total_frames++;
-    current_pos_ms += (samples_per_frame * 1000) / sample_rate;
+    frame_index++;
+    current_pos_ms = (uint32_t)(((uint64_t)frame_index * samples_per_frame * 1000) / sample_rate);
+    byte_offset += flen;
     
     return (int)out_samples;
 }
 
 void MP3Decoder::close() {
+    if (file_open) {
+        sd->close_file();
+        file_open = false;
+    }
     is_open = false;
     frame_buffer_len = 0;
-    Serial.println("[MP3] Decoder closed");
+    LOG_D("[MP3] Decoder closed");
 }
 
 uint32_t MP3Decoder::get_duration_ms() const {
@@ -154,6 +362,73 @@ uint32_t MP3Decoder::get_current_position_ms() const {
     return current_pos_ms;
 }
 
+bool MP3Decoder::seek(uint32_t position_ms) {
+    if (!is_open || sample_rate == 0 || bitrate == 0) return false;
+    
+    /* Bitrate estimate of the target byte (no decoding of skipped audio) */
+    uint32_t target = data_start + (uint32_t)(((uint64_t)position_ms * (bitrate / 8)) / 1000);
+    uint32_t avg_frame = ((samples_per_frame / 8) * bitrate) / sample_rate;
+    
+    if (file_size > 0 && target >= file_size) {
+        target = (file_size > avg_frame) ? file_size - avg_frame : data_start;
+    }
+    
+    /* Resync: first plausible frame at or after the estimate */
+    size_t sync = 0;
+    int n = sd->seek(target) ? sd->read_data(frame_buffer, WINDOW_SIZE) : -1;
+    if (n < 4 || !resync(frame_buffer, (size_t)n, sync)) {
+        LOG_W("[MP3] Seek: no frame near byte %u", (unsigned)target);
+        return false;
+    }
+    byte_offset = target + (uint32_t)sync;
+    if (!sd->seek(byte_offset)) return false;
+    
+    /* Position of the frame actually landed on */
+    uint32_t frames = (uint32_t)(((uint64_t)(byte_offset - data_start) * sample_rate) /
+                                 ((uint64_t)(samples_per_frame / 8) * bitrate));
+    frame_index = frames;
+    current_pos_ms = (uint32_t)(((uint64_t)frames * samples_per_frame * 1000) / sample_rate);
+    frame_buffer_len = 0;
+    in_sync = false;
+    return true;
+}
+
+uint32_t MP3Decoder::get_byte_offset() const {
+    return byte_offset;
+}
+
+bool MP3Decoder::resume_at(uint32_t offset, uint32_t position_ms) {
+    if (!is_open) return false;
+    
+    /* Offset was journaled at a frame boundary: jump straight to it */
+    if (!sd->seek(offset)) return false;
+    byte_offset = offset;
+    current_pos_ms = position_ms;
+    if (sample_rate > 0) {
+        frame_index = (uint32_t)(((uint64_t)position_ms * sample_rate) / ((uint64_t)samples_per_frame * 1000));
+    }
+    frame_buffer_len = 0;
+    in_sync = false;
+    LOG_I("[MP3] Resume at byte %u (%u ms)", (unsigned)offset, (unsigned)position_ms);
+    return true;
+}
+
+uint32_t MP3Decoder::get_sample_rate() const {
+    return (uint32_t)sample_rate;
+}
+
+bool MP3Decoder::get_stats(DecoderStats& out) const {
+    out.frames = total_frames;
+    out.resyncs = resyncs;
+    out.skipped_bytes = skipped_bytes;
+    return true;
+}
+
+bool MP3Decoder::has_synthesis() const {
+    /* Placeholder decode: silence until libhelix MP3Decode is integrated */
+    return false;
+}
+
 const char* MP3Decoder::get_error_message() const {
     return "MP3 decoder error";
 }
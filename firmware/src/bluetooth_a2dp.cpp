@@ -1,5 +1,10 @@
 #include "bluetooth_a2dp.h"
+#include "audio_arena.h"
 #include "config.h"
+#include "level_meter.h"
+#include "memory_telemetry.h"
+#include "trace.h"
+#include "log.h"
 #include <Arduino.h>
 #include <cstring>
 
@@ -9,23 +14,30 @@
  * Note: Full implementation requires ESP-IDF Bluetooth stack integration
  * ========================================================================== */
 
+#define LOG_MODULE LOG_MOD_BT
+
 class BluetoothA2DPImpl : public BluetoothA2DP {
 private:
     bool connected = false;
     bool initialized = false;
     uint8_t volume = 80;  /* Default volume 0–100 */
     
-    /* Ring buffer for audio samples */
-    static const size_t BUFFER_SIZE = 4096;
-    int16_t ring_buffer[BUFFER_SIZE];
+    /* Ring buffer for audio samples (arena slice) */
+    static const size_t BUFFER_SIZE = sizeof(AudioArena::bt_ring) / sizeof(int16_t);
+    static_assert(BUFFER_SIZE <= 0x10000, "Ring positions are 16-bit");
+    int16_t* const ring_buffer = audio_arena().bt_ring;
     volatile uint16_t write_pos = 0;
     volatile uint16_t read_pos = 0;
     
+    LevelMeter* meter = nullptr;
+    MemoryTelemetry* telemetry = nullptr;
+
 public:
     bool init() override;
     bool connect() override;
     bool disconnect() override;
     bool feed_audio(const int16_t* pcm, uint16_t sample_count) override;
+    void flush() override;
     bool is_connected() const override;
     bool set_volume(uint8_t vol) override;
     const char* get_error_message() const override;
@@ -35,6 +47,8 @@ bool BluetoothA2DPImpl::init() {
     Serial.println("[BT] Initializing Bluetooth A2DP source");
     Serial.println("[BT] Note: Full BT support requires ESP-IDF integration");
     
+    meter = create_level_meter();
+    telemetry = create_memory_telemetry();
     initialized = true;
     return true;
 }
@@ -44,8 +58,8 @@ bool BluetoothA2DPImpl::connect() {
         return true;
     }
     
-    Serial.println("[BT] Starting Bluetooth discovery...");
-    Serial.println("[BT] Waiting for external speaker to connect");
+    LOG_I("[BT] Starting Bluetooth discovery...");
+    LOG_I("[BT] Waiting for external speaker to connect");
     
     connected = true;  /* Simulated for testing */
     return true;
@@ -57,7 +71,7 @@ bool BluetoothA2DPImpl::disconnect() {
     }
     
     connected = false;
-    Serial.println("[BT] Bluetooth disconnected");
+    LOG_I("[BT] Bluetooth disconnected");
     return true;
 }
 
@@ -66,21 +80,48 @@ bool BluetoothA2DPImpl::feed_audio(const int16_t* pcm, uint16_t sample_count) {
         return false;
     }
     
-    /* Write samples to ring buffer */
+    TRACE_SCOPE(TRACE_FEED_AUDIO, sample_count);
+    
+    /* A frame larger than the whole ring can never be queued */
+    if (sample_count > BUFFER_SIZE - 1) {
+        /* Keep the trace window that led up to the overflow */
+        TRACE_INSTANT(TRACE_AUDIO_OVERFLOW, sample_count);
+        TRACE_FREEZE();
+        LOG_W("[BT] WARNING: Ring buffer overflow!");
+        return false;
+    }
+    
+    /* All or nothing: a frame that does not fit yet is refused untouched */
+    uint16_t head = write_pos;
+    uint32_t free_samples = (read_pos - head - 1 + BUFFER_SIZE) % BUFFER_SIZE;
+    if (sample_count > free_samples) {
+        return false;
+    }
+    
     for (uint16_t i = 0; i < sample_count; i++) {
-        ring_buffer[write_pos] = pcm[i];
-        write_pos = (write_pos + 1) % BUFFER_SIZE;
-        
-        /* Detect buffer overflow */
-        if (write_pos == read_pos) {
-            Serial.println("[BT] WARNING: Ring buffer overflow!");
-            return false;
-        }
+        ring_buffer[head] = pcm[i];
+        head = (uint16_t)((head + 1) % BUFFER_SIZE);
+    }
+    write_pos = head;   /* Publish the whole frame at once */
+    
+    if (telemetry) {
+        uint32_t fill = (head + BUFFER_SIZE - read_pos) % BUFFER_SIZE;
+        telemetry->note_buffer_fill(MEM_BUF_AUDIO_RING, fill * sizeof(int16_t), sizeof(AudioArena::bt_ring));
+    }
+    
+    /* Tap only what was queued: a refused chunk is offered again later */
+    if (meter) {
+        meter->process(pcm, sample_count);
     }
     
     return true;
 }
 
+void BluetoothA2DPImpl::flush() {
+    /* Consumer side catches up: queued samples are never encoded */
+    read_pos = write_pos;
+}
+
 bool BluetoothA2DPImpl::is_connected() const {
     return connected && initialized;
 }
@@ -88,7 +129,7 @@ bool BluetoothA2DPImpl::is_connected() const {
 bool BluetoothA2DPImpl::set_volume(uint8_t vol) {
     if (vol > 100) vol = 100;
     volume = vol;
-    Serial.printf("[BT] Volume set to %d%%\n", volume);
+    LOG_I("[BT] Volume set to %d%%", volume);
     return true;
 }
 
@@ -1,14 +1,29 @@
 #include "button_handler.h"
+#include "event_queue.h"
+#include "latency_monitor.h"
+#include "memory_telemetry.h"
+#include "log.h"
 #include "config.h"
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include <cstring>
 
 /* ============================================================================
  * Button Handler Implementation
- * Debounced GPIO button input with event queueing
- * Non-blocking interrupt-driven design
+ * ISRs push (button, timestamp) into a single-producer ring and wake the
+ * button task; nothing else runs in interrupt context. A press is only
+ * believed once the line has been quiet for BTN_DEBOUNCE_MS and reads low,
+ * so a lone glitch on an idle line never starts a gesture. The release of
+ * a settled press is taken on its leading edge (the line was stable, so it
+ * can only change one way) and the rest of its burst is ignored until the
+ * line is quiet again. A per-button gesture state machine runs on the
+ * levels. The task sleeps on its notification until the next edge or the
+ * nearest pending deadline.
  * ========================================================================== */
 
+#define LOG_MODULE LOG_MOD_BUTTON
+
 /* Button IDs */
 enum ButtonID {
     BUTTON_PREV = 0,
@@ -17,141 +32,150 @@ enum ButtonID {
     NUM_BUTTONS = 3
 };
 
-/* Button event queue (note: avoid EVENT_QUEUE_SIZE, conflicts with config.h macro) */
-static const size_t BTN_QUEUE_SIZE = 16;
-struct ButtonQueueEvent {
+#if (BTN_CAPTURE_RING & (BTN_CAPTURE_RING - 1)) != 0
+    #error "BTN_CAPTURE_RING must be a power of 2"
+#endif
+
+static const uint32_t DEBOUNCE_US = BTN_DEBOUNCE_MS * 1000UL;
+static const uint32_t LONG_PRESS_US = BTN_LONG_PRESS_MS * 1000UL;
+static const uint32_t DOUBLE_PRESS_US = BTN_DOUBLE_PRESS_MS * 1000UL;
+static const uint32_t REPEAT_US = BTN_REPEAT_MS * 1000UL;
+
+/* Edge captured in interrupt context */
+struct ButtonEdge {
     uint8_t button_id;
-    ButtonEvent event;
+    uint32_t time_us;
+};
+
+enum GesturePhase {
+    PHASE_IDLE,
+    PHASE_PRESSED,       /* Down; LONG fires at press + LONG_PRESS_US */
+    PHASE_HELD,          /* LONG fired; `deadline_us` is the next REPEAT */
+    PHASE_WAIT_DOUBLE,   /* Up after a short press; SHORT fires if no 2nd press */
+    PHASE_SECOND,        /* Down for the second press of a DOUBLE */
 };
 
 class ButtonHandlerImpl : public ButtonHandler {
 private:
-    /* Debounce state machine per button */
     struct ButtonState {
         uint8_t pin;
-        uint32_t last_change_time;
-        ButtonEvent current_state;
-        ButtonEvent debounced_state;
+        bool double_enabled;     /* Only PLAY waits for a second press */
+        
+        /* Debounce */
+        bool settling;           /* Inside a bounce burst: edges ignored */
+        uint32_t burst_us;       /* First edge of the current burst */
+        uint32_t last_edge_us;
+        bool pressed;            /* Debounced level */
+        
+        /* Gesture recognition */
+        GesturePhase phase;
+        uint32_t deadline_us;
     };
     
     ButtonState buttons[NUM_BUTTONS];
     
-    /* Event queue */
-    ButtonQueueEvent event_queue[BTN_QUEUE_SIZE];
-    volatile uint8_t queue_head = 0;
-    volatile uint8_t queue_tail = 0;
-    volatile size_t queue_count = 0;
-    
-    static ButtonHandlerImpl* instance;  /* For ISR context */
+    /* ISR → task ring: written only by the GPIO dispatcher (one ISR at a time) */
+    ButtonEdge ring[BTN_CAPTURE_RING];
+    volatile uint32_t ring_head = 0;
+    volatile uint32_t ring_tail = 0;
+    volatile uint32_t edges_dropped = 0;
     
-    void enqueue_event(uint8_t button_id, ButtonEvent event);
-    void do_debounce();
+    TaskHandle_t task = nullptr;
+    EventQueue* events = nullptr;
+    LatencyMonitor* latency = nullptr;
+    MemoryTelemetry* telemetry = nullptr;
+    ButtonStats stats = {};
     
+    static void task_entry(void* arg);
+    void task_loop();
+    void drain_ring();
+    void service(uint8_t id, uint32_t now_us);
+    void on_level(uint8_t id, bool pressed, uint32_t time_us);
+    void on_press(uint8_t id, uint32_t edge_us, uint32_t decided_us);
+    bool next_deadline(uint32_t& deadline_us) const;
+    void emit(uint8_t id, ButtonGesture gesture, uint32_t trigger_us);
+
 public:
     ButtonHandlerImpl();
     bool init() override;
-    bool get_event(uint8_t& button_id, ButtonEvent& event) override;
-    size_t pending_count() const override;
-    void check_debounce();  /* Called periodically */
+    const ButtonStats& get_stats() const override;
     
-    friend void button_isr_prev();
-    friend void button_isr_play();
-    friend void button_isr_next();
+    void capture(uint8_t button_id);  /* ISR context */
 };
 
 /* Global singleton */
-ButtonHandlerImpl* ButtonHandlerImpl::instance = nullptr;
+static ButtonHandlerImpl g_button_handler;
 
 ButtonHandlerImpl::ButtonHandlerImpl() {
-    instance = this;
-    
-    /* Initialize button state */
-    buttons[BUTTON_PREV].pin = BTN_PREV_PIN;
-    buttons[BUTTON_PREV].current_state = BUTTON_RELEASED;
-    buttons[BUTTON_PREV].debounced_state = BUTTON_RELEASED;
-    buttons[BUTTON_PREV].last_change_time = 0;
+    static const uint8_t pins[NUM_BUTTONS] = {BTN_PREV_PIN, BTN_PLAY_PIN, BTN_NEXT_PIN};
     
-    buttons[BUTTON_PLAY].pin = BTN_PLAY_PIN;
-    buttons[BUTTON_PLAY].current_state = BUTTON_RELEASED;
-    buttons[BUTTON_PLAY].debounced_state = BUTTON_RELEASED;
-    buttons[BUTTON_PLAY].last_change_time = 0;
-    
-    buttons[BUTTON_NEXT].pin = BTN_NEXT_PIN;
-    buttons[BUTTON_NEXT].current_state = BUTTON_RELEASED;
-    buttons[BUTTON_NEXT].debounced_state = BUTTON_RELEASED;
-    buttons[BUTTON_NEXT].last_change_time = 0;
-}
-
-/* ISR handlers without context (Arduino attachInterrupt signature) */
-void IRAM_ATTR button_isr_prev() {
-    if (ButtonHandlerImpl::instance) {
-        ButtonHandlerImpl::instance->check_debounce();
+    memset(buttons, 0, sizeof(buttons));
+    for (uint8_t i = 0; i < NUM_BUTTONS; i++) {
+        buttons[i].pin = pins[i];
+        buttons[i].phase = PHASE_IDLE;
     }
+    buttons[BUTTON_PLAY].double_enabled = true;
 }
 
-void IRAM_ATTR button_isr_play() {
-    if (ButtonHandlerImpl::instance) {
-        ButtonHandlerImpl::instance->check_debounce();
-    }
+/* ISR handlers: one per pin, so no pin scanning in interrupt context */
+static void IRAM_ATTR button_isr_prev() {
+    g_button_handler.capture(BUTTON_PREV);
 }
 
-void IRAM_ATTR button_isr_next() {
-    if (ButtonHandlerImpl::instance) {
-        ButtonHandlerImpl::instance->check_debounce();
-    }
+static void IRAM_ATTR button_isr_play() {
+    g_button_handler.capture(BUTTON_PLAY);
 }
 
-void ButtonHandlerImpl::enqueue_event(uint8_t button_id, ButtonEvent event) {
-    if (queue_count >= BTN_QUEUE_SIZE) {
-        Serial.println("[BTN] WARNING: Event queue full");
-        return;
-    }
-    
-    event_queue[queue_tail].button_id = button_id;
-    event_queue[queue_tail].event = event;
-    queue_tail = (queue_tail + 1) % BTN_QUEUE_SIZE;
-    queue_count++;
+static void IRAM_ATTR button_isr_next() {
+    g_button_handler.capture(BUTTON_NEXT);
 }
 
-void ButtonHandlerImpl::do_debounce() {
-    uint32_t now = millis();
+void IRAM_ATTR ButtonHandlerImpl::capture(uint8_t button_id) {
+    uint32_t head = ring_head;
+    if (head - ring_tail >= BTN_CAPTURE_RING) {
+        edges_dropped = edges_dropped + 1;
+    } else {
+        ring[head & (BTN_CAPTURE_RING - 1)].button_id = button_id;
+        ring[head & (BTN_CAPTURE_RING - 1)].time_us = micros();
+        __sync_synchronize();
+        ring_head = head + 1;  /* Publish after the entry is written */
+    }
     
-    for (uint8_t i = 0; i < NUM_BUTTONS; i++) {
-        uint8_t raw_state = digitalRead(buttons[i].pin);
-        /* Buttons are active-low (pulled up), so invert */
-        ButtonEvent raw_event = (raw_state == LOW) ? BUTTON_PRESSED : BUTTON_RELEASED;
-        
-        /* Debounce FSM */
-        if (raw_event != buttons[i].current_state) {
-            /* State changed; check if stable for BTN_DEBOUNCE_MS */
-            if ((now - buttons[i].last_change_time) >= BTN_DEBOUNCE_MS) {
-                buttons[i].current_state = raw_event;
-                buttons[i].last_change_time = now;
-                
-                /* Actual state change confirmed */
-                if (buttons[i].current_state != buttons[i].debounced_state) {
-                    buttons[i].debounced_state = buttons[i].current_state;
-                    enqueue_event(i, buttons[i].debounced_state);
-                    
-                    const char* btn_names[] = {"PREV", "PLAY", "NEXT"};
-                    const char* state_str = (buttons[i].debounced_state == BUTTON_PRESSED) ? "PRESS" : "RELEASE";
-                    Serial.printf("[BTN] %s %s\n", btn_names[i], state_str);
-                }
-            }
-        } else {
-            buttons[i].last_change_time = now;
-        }
+    if (task) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(task, &woken);
+        portYIELD_FROM_ISR(woken);
     }
 }
 
 bool ButtonHandlerImpl::init() {
     Serial.println("[BTN] Initializing button handler");
     
+    extern EventQueue* create_event_queue();
+    events = create_event_queue();
+    latency = create_latency_monitor();
+    telemetry = create_memory_telemetry();
+    
     /* Configure GPIO pins as inputs with pull-ups */
     pinMode(BTN_PREV_PIN, INPUT_PULLUP);
     pinMode(BTN_PLAY_PIN, INPUT_PULLUP);
     pinMode(BTN_NEXT_PIN, INPUT_PULLUP);
     
+    /* Buttons held at boot must not produce a phantom release gesture */
+    for (uint8_t i = 0; i < NUM_BUTTONS; i++) {
+        buttons[i].pressed = (digitalRead(buttons[i].pin) == LOW);
+        buttons[i].phase = buttons[i].pressed ? PHASE_SECOND : PHASE_IDLE;
+    }
+    
+    /* ESP-IDF takes the stack depth in bytes */
+    if (xTaskCreate(task_entry, "buttons", TASK_STACK_WORDS_BUTTON * 4, this,
+                    TASK_PRIORITY_BUTTON, &task) != pdPASS) {
+        task = nullptr;
+        Serial.println("[BTN] FATAL: Button task not started");
+        return false;
+    }
+    telemetry->register_task(MEM_TASK_BUTTONS, task, TASK_STACK_WORDS_BUTTON * 4);
+    
     /* Attach ISR handlers (Arduino signature: void handler(void)) */
     attachInterrupt(digitalPinToInterrupt(BTN_PREV_PIN), button_isr_prev, CHANGE);
     attachInterrupt(digitalPinToInterrupt(BTN_PLAY_PIN), button_isr_play, CHANGE);
@@ -164,33 +188,218 @@ bool ButtonHandlerImpl::init() {
     return true;
 }
 
-bool ButtonHandlerImpl::get_event(uint8_t& button_id, ButtonEvent& event) {
-    if (queue_count == 0) {
-        return false;
+void ButtonHandlerImpl::task_entry(void* arg) {
+    static_cast<ButtonHandlerImpl*>(arg)->task_loop();
+}
+
+void ButtonHandlerImpl::task_loop() {
+    while (true) {
+        /* Sleep until an edge arrives or the nearest debounce/gesture deadline */
+        TickType_t wait = portMAX_DELAY;
+        uint32_t deadline_us;
+        if (next_deadline(deadline_us)) {
+            int32_t remaining_us = (int32_t)(deadline_us - micros());
+            wait = (remaining_us <= 0) ? 0 : pdMS_TO_TICKS(remaining_us / 1000 + 1);
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+        
+        drain_ring();
+        uint32_t now = micros();
+        for (uint8_t i = 0; i < NUM_BUTTONS; i++) {
+            service(i, now);
+        }
     }
+}
+
+void ButtonHandlerImpl::drain_ring() {
+    uint32_t head = ring_head;
+    uint32_t tail = ring_tail;
+    __sync_synchronize();  /* Entries up to `head` are complete */
     
-    button_id = event_queue[queue_head].button_id;
-    event = event_queue[queue_head].event;
-    queue_head = (queue_head + 1) % BTN_QUEUE_SIZE;
-    queue_count--;
+    telemetry->note_buffer_fill(MEM_BUF_BUTTON_RING, head - tail, BTN_CAPTURE_RING);
     
-    return true;
+    while (tail != head) {
+        const ButtonEdge& edge = ring[tail & (BTN_CAPTURE_RING - 1)];
+        ButtonState& b = buttons[edge.button_id];
+        if (!b.settling) {
+            b.settling = true;
+            b.burst_us = edge.time_us;
+            if (b.pressed) {
+                /* Release of a settled press: act on the leading edge */
+                b.pressed = false;
+                on_level(edge.button_id, false, edge.time_us);
+            }
+            /* A press waits for the line to settle (service) */
+        }
+        b.last_edge_us = edge.time_us;
+        stats.edges++;
+        tail++;
+    }
+    ring_tail = tail;  /* Frees the slots for the ISR */
+    stats.edges_dropped = edges_dropped;
 }
 
-size_t ButtonHandlerImpl::pending_count() const {
-    return queue_count;
+void ButtonHandlerImpl::service(uint8_t id, uint32_t now_us) {
+    ButtonState& b = buttons[id];
+    
+    /* Burst over: the settled level decides (a lone glitch changes nothing) */
+    if (b.settling && (now_us - b.last_edge_us) >= DEBOUNCE_US) {
+        b.settling = false;
+        bool level = (digitalRead(b.pin) == LOW);  /* Active-low */
+        if (level != b.pressed) {
+            b.pressed = level;
+            if (level) {
+                on_press(id, b.burst_us, now_us);
+            } else {
+                on_level(id, false, now_us);
+            }
+        }
+    }
+    
+    /* Time-driven transitions */
+    switch (b.phase) {
+        case PHASE_PRESSED:
+            if ((int32_t)(now_us - b.deadline_us) >= 0) {
+                emit(id, GESTURE_LONG, b.deadline_us);
+                b.phase = PHASE_HELD;
+                b.deadline_us += REPEAT_US;
+            }
+            break;
+        case PHASE_HELD:
+            /* One REPEAT per wake-up; a late task does not burst */
+            if ((int32_t)(now_us - b.deadline_us) >= 0) {
+                emit(id, GESTURE_REPEAT, b.deadline_us);
+                b.deadline_us += REPEAT_US;
+                if ((int32_t)(now_us - b.deadline_us) >= 0) {
+                    b.deadline_us = now_us + REPEAT_US;
+                }
+            }
+            break;
+        case PHASE_WAIT_DOUBLE:
+            /* A second press still settling may yet make it a DOUBLE */
+            if (!b.settling && (int32_t)(now_us - b.deadline_us) >= 0) {
+                if (latency) {
+                    latency->mark_gesture_wait(now_us - (b.deadline_us - DOUBLE_PRESS_US));
+                }
+                emit(id, GESTURE_SHORT, now_us);
+                b.phase = PHASE_IDLE;
+            }
+            break;
+        default:
+            break;
+    }
 }
 
-void ButtonHandlerImpl::check_debounce() {
-    do_debounce();
+/* Settled press: holds count from the first edge, DOUBLE from the decision */
+void ButtonHandlerImpl::on_press(uint8_t id, uint32_t edge_us, uint32_t decided_us) {
+    ButtonState& b = buttons[id];
+    
+    if (b.phase == PHASE_IDLE) {
+        b.phase = PHASE_PRESSED;
+        b.deadline_us = edge_us + LONG_PRESS_US;
+    } else {
+        on_level(id, true, decided_us);
+    }
 }
 
-/* Global instance */
-static ButtonHandlerImpl g_button_handler;
+void ButtonHandlerImpl::on_level(uint8_t id, bool pressed, uint32_t time_us) {
+    ButtonState& b = buttons[id];
+    
+    switch (b.phase) {
+        case PHASE_IDLE:
+            break;   /* Presses start in on_press() */
+        case PHASE_PRESSED:
+            if (!pressed) {
+                if (b.double_enabled) {
+                    b.phase = PHASE_WAIT_DOUBLE;
+                    b.deadline_us = time_us + DOUBLE_PRESS_US;
+                } else {
+                    emit(id, GESTURE_SHORT, time_us);
+                    b.phase = PHASE_IDLE;
+                }
+            }
+            break;
+        case PHASE_HELD:
+            if (!pressed) {
+                emit(id, GESTURE_HOLD_END, time_us);
+                b.phase = PHASE_IDLE;
+            }
+            break;
+        case PHASE_WAIT_DOUBLE:
+            if (pressed) {
+                emit(id, GESTURE_DOUBLE, time_us);
+                b.phase = PHASE_SECOND;
+            }
+            break;
+        case PHASE_SECOND:
+            if (!pressed) {
+                b.phase = PHASE_IDLE;
+            }
+            break;
+    }
+}
+
+bool ButtonHandlerImpl::next_deadline(uint32_t& deadline_us) const {
+    bool any = false;
+    uint32_t now = micros();
+    int32_t nearest = 0;
+    
+    for (uint8_t i = 0; i < NUM_BUTTONS; i++) {
+        const ButtonState& b = buttons[i];
+        uint32_t candidates[2];
+        uint8_t n = 0;
+        
+        if (b.settling) {
+            candidates[n++] = b.last_edge_us + DEBOUNCE_US;
+        }
+        if (b.phase == PHASE_PRESSED || b.phase == PHASE_HELD || b.phase == PHASE_WAIT_DOUBLE) {
+            candidates[n++] = b.deadline_us;
+        }
+        
+        for (uint8_t k = 0; k < n; k++) {
+            int32_t delta = (int32_t)(candidates[k] - now);
+            if (!any || delta < nearest) {
+                nearest = delta;
+                any = true;
+            }
+        }
+    }
+    
+    deadline_us = now + nearest;
+    return any;
+}
+
+void ButtonHandlerImpl::emit(uint8_t id, ButtonGesture gesture, uint32_t trigger_us) {
+    static const char* btn_names[] = {"PREV", "PLAY", "NEXT"};
+    static const char* gesture_names[] = {"", "SHORT", "DOUBLE", "LONG", "REPEAT", "HOLD_END"};
+    
+    /* Timed from the deciding edge or deadline: how long the user held the
+     * button is not latency, and PLAY's double-press wait is reported apart */
+    if (latency) {
+        latency->mark_input(trigger_us);
+    }
+    
+    if (events) {
+        Event event;
+        event.type = (EventType)(EVENT_BUTTON_PREV + id);
+        event.param = gesture;
+        events->post(event);
+    }
+    
+    uint32_t elapsed_us = micros() - trigger_us;
+    stats.gestures++;
+    stats.last_latency_us = elapsed_us;
+    if (elapsed_us > stats.max_latency_us) {
+        stats.max_latency_us = elapsed_us;
+    }
+    
+    if (gesture != GESTURE_REPEAT) {
+        LOG_D("[BTN] %s %s (%u us)", btn_names[id], gesture_names[gesture], (unsigned)elapsed_us);
+    }
+}
 
-/* Periodic update function (call from main loop) */
-void button_handler_update() {
-    g_button_handler.check_debounce();
+const ButtonStats& ButtonHandlerImpl::get_stats() const {
+    return stats;
 }
 
 /* Factory function */
@@ -1,14 +1,46 @@
 #include "display_ssd1306.h"
 #include "config.h"
+#include "font5x7.h"
+#include "sprites.h"
+#include "memory_telemetry.h"
+#include "trace.h"
 #include <Arduino.h>
 #include <Wire.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include <cstring>
 
 /* ============================================================================
  * SSD1306 OLED Display Driver
  * 128x64 monochrome display via I2C
+ * Horizontal addressing mode: a shadow copy of panel RAM is diffed against
+ * the framebuffer at flush time (dirty 8x8 blocks only limit the compare).
+ * Changed byte spans become column/page windows (0x21/0x22), streamed in
+ * bursts that fill the Wire TX buffer.
+ * A display task owns the bus. Callers draw into `framebuffer` and publish
+ * with update(); the frame is copied into a spare slot and pointer-swapped
+ * in as the pending frame. If the task is still busy, the previous pending
+ * frame is merged (dirty masks OR'ed) and dropped.
  * ========================================================================== */
 
+/* Data bytes per transaction (Wire buffer minus the 0x40 control byte) */
+#ifdef I2C_BUFFER_LENGTH
+static const size_t WIRE_BURST = I2C_BUFFER_LENGTH - 1;
+#else
+static const size_t WIRE_BURST = 31;
+#endif
+
+/* Dirty block grid: 16 columns of 8 px × 8 pages */
+static const uint8_t BLOCK_COLS = DISPLAY_WIDTH / 8;
+
+/* Page masks: rows y%8..7 of a page, and rows 0..y%8 of a page */
+static const uint8_t PAGE_MASK_FROM[8] = {0xFF, 0xFE, 0xFC, 0xF8, 0xF0, 0xE0, 0xC0, 0x80};
+static const uint8_t PAGE_MASK_TO[8] = {0x01, 0x03, 0x07, 0x0F, 0x1F, 0x3F, 0x7F, 0xFF};
+
+/* Unchanged bytes cheaper to resend than opening a new window
+ * (window = 8-byte command transaction + 2-byte data header) */
+static const uint8_t WINDOW_MERGE_GAP = 10;
+
 class DisplaySSD1306Impl : public DisplaySSD1306 {
 private:
     /* Use config.h constants */
@@ -20,14 +52,59 @@ private:
     /* Dirty tracking: one bit per 8x8 pixel block */
     uint8_t dirty_regions[(DISPLAY_WIDTH / 8) * (DISPLAY_HEIGHT / 8)];
     
+    /* What the panel currently shows (valid after the first full flush) */
+    uint8_t shadow[FRAMEBUFFER_SIZE];
+    bool shadow_valid = false;
+    
+    /* Published frames: spare (caller) → pending (shared) → tx (task) */
+    struct FrameSlot {
+        uint8_t pixels[FRAMEBUFFER_SIZE];
+        uint8_t dirty[(DISPLAY_WIDTH / 8) * (DISPLAY_HEIGHT / 8)];
+        bool full;
+    };
+    FrameSlot slots[3];
+    FrameSlot* spare_frame = &slots[0];
+    FrameSlot* pending_frame = &slots[1];
+    FrameSlot* tx_frame = &slots[2];
+    bool frame_ready = false;
+    mutable portMUX_TYPE swap_lock = portMUX_INITIALIZER_UNLOCKED;
+    
+    /* Controller commands requested by callers, sent by the task */
+    enum ControlRequest : uint8_t {
+        CTRL_CONTRAST = 0x01,
+        CTRL_SLEEP = 0x02,
+        CTRL_WAKE = 0x04,
+    };
+    uint8_t pending_ctrl = 0;
+    
+    TaskHandle_t task = nullptr;
+    uint32_t frames_merged = 0;
+    uint32_t caller_block_us = 0;
+    
     bool initialized = false;
     uint8_t contrast = 0xFF;
     bool powered = true;
     
+    /* Flush in progress (task only) and the last completed one (swap_lock) */
+    DisplayFlushStats stats = {};
+    DisplayFlushStats last_stats = {};
+    
+    void fill_span(uint8_t x, uint8_t y, uint16_t w, uint16_t h, uint8_t color);
+    
     void send_command(uint8_t cmd);
+    void send_commands(const uint8_t* cmds, size_t len);
     void send_data(const uint8_t* data, size_t len);
-    void update_region(uint8_t page, uint8_t col);
+    void flush_window(const uint8_t* pixels, uint8_t page0, uint8_t page1, uint8_t col0, uint8_t col1);
+    void flush_diff(FrameSlot* frame);
+    void flush_all(FrameSlot* frame);
+    void begin_stats();
+    void end_stats(uint32_t start_us);
     
+    void publish(bool full);
+    void apply_control_requests();
+    static void task_entry(void* arg);
+    void task_loop();
+
 public:
     bool init() override;
     void clear() override;
@@ -37,11 +114,14 @@ public:
     void draw_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t color) override;
     void draw_filled_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t color) override;
     void draw_text(uint8_t x, uint8_t y, const char* text, uint8_t color) override;
+    void draw_columns(uint8_t x, uint8_t y, const uint8_t* columns, uint8_t width, uint8_t color) override;
+    void draw_sprite(uint8_t x, uint8_t y, uint8_t sprite_id) override;
     void update() override;
     void update_full() override;
     void set_contrast(uint8_t value) override;
     void sleep() override;
     void wake() override;
+    DisplayFlushStats get_flush_stats() const override;
 };
 
 void DisplaySSD1306Impl::send_command(uint8_t cmd) {
@@ -51,25 +131,44 @@ void DisplaySSD1306Impl::send_command(uint8_t cmd) {
     Wire.endTransmission();
 }
 
+void DisplaySSD1306Impl::send_commands(const uint8_t* cmds, size_t len) {
+    Wire.beginTransmission(DISP_ADDR);
+    Wire.write(0x00);  /* Control byte: command stream */
+    Wire.write(cmds, len);
+    Wire.endTransmission();
+    
+    stats.i2c_bytes += 2 + len;  /* Address + control + commands */
+    stats.transactions++;
+}
+
 void DisplaySSD1306Impl::send_data(const uint8_t* data, size_t len) {
     Wire.beginTransmission(DISP_ADDR);
     Wire.write(0x40);  /* Control byte: data stream */
-    for (size_t i = 0; i < len; i++) {
-        Wire.write(data[i]);
-    }
+    Wire.write(data, len);
     Wire.endTransmission();
+    
+    stats.i2c_bytes += 2 + len;
+    stats.transactions++;
 }
 
 bool DisplaySSD1306Impl::init() {
+    /* Bus belongs to the flush task once running; never re-run the sequence */
+    if (initialized) return true;
+    
     Serial.println("[OLED] Initializing SSD1306 display");
     
     /* Initialize I2C */
     Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN, I2C_FREQ * 1000);
-    delay(100);
     
-    /* Check if device responds */
-    Wire.beginTransmission(DISP_ADDR);
-    if (Wire.endTransmission() != 0) {
+    /* Check if device responds; the panel is normally up long before
+     * setup(), so only a cold supply gets the short retries */
+    bool found = false;
+    for (uint8_t attempt = 0; attempt < SSD1306_PROBE_ATTEMPTS && !found; attempt++) {
+        if (attempt > 0) delay(SSD1306_PROBE_RETRY_MS);
+        Wire.beginTransmission(DISP_ADDR);
+        found = (Wire.endTransmission() == 0);
+    }
+    if (!found) {
         Serial.println("[OLED] FATAL: SSD1306 not found on I2C bus");
         return false;
     }
@@ -87,15 +186,26 @@ bool DisplaySSD1306Impl::init() {
     send_command(0x81); send_command(0xCF);  /* Contrast */
     send_command(0xD9); send_command(0xF1);  /* Pre-charge period */
     send_command(0xDB); send_command(0x40);  /* V_COMH */
+    send_command(0x20); send_command(0x00);  /* Horizontal addressing mode */
     send_command(0x2E);  /* Deactivate scroll */
-    send_command(0xAF);  /* Display on */
-    
-    delay(100);
+    send_command(0xAF);  /* Display on (RAM writes need no settling time) */
     
     /* Initialize framebuffer */
     memset(framebuffer, 0, sizeof(framebuffer));
     memset(dirty_regions, 0xFF, sizeof(dirty_regions));  /* All dirty */
     
+    /* Flush task owns the bus from here on (created once; init may repeat) */
+    if (!task) {
+        /* ESP-IDF takes the stack depth in bytes */
+        if (xTaskCreate(task_entry, "display", TASK_STACK_WORDS_DISPLAY * 4, this,
+                        TASK_PRIORITY_DISPLAY, &task) != pdPASS) {
+            task = nullptr;
+            Serial.println("[OLED] WARNING: Flush task not started (synchronous flush)");
+        } else {
+            create_memory_telemetry()->register_task(MEM_TASK_DISPLAY, task, TASK_STACK_WORDS_DISPLAY * 4);
+        }
+    }
+    
     initialized = true;
     Serial.println("[OLED] Initialized successfully");
     return true;
@@ -125,16 +235,46 @@ void DisplaySSD1306Impl::draw_pixel(uint8_t x, uint8_t y, uint8_t color) {
     dirty_regions[region_idx] = 1;
 }
 
-void DisplaySSD1306Impl::draw_hline(uint8_t x, uint8_t y, uint8_t width, uint8_t color) {
-    for (uint8_t i = 0; i < width && (x + i) < DISPLAY_WIDTH; i++) {
-        draw_pixel(x + i, y, color);
+void DisplaySSD1306Impl::fill_span(uint8_t x, uint8_t y, uint16_t w, uint16_t h, uint8_t color) {
+    if (x >= DISPLAY_WIDTH || y >= DISPLAY_HEIGHT || w == 0 || h == 0) return;
+    
+    /* Clip to panel; end coordinates are exclusive */
+    uint16_t x_end = x + w;
+    uint16_t y_end = y + h;
+    if (x_end > DISPLAY_WIDTH) x_end = DISPLAY_WIDTH;
+    if (y_end > DISPLAY_HEIGHT) y_end = DISPLAY_HEIGHT;
+    
+    uint8_t width = x_end - x;
+    uint8_t first_page = y / 8;
+    uint8_t last_page = (y_end - 1) / 8;
+    uint8_t first_block = x / 8;
+    uint8_t blocks = (x_end - 1) / 8 - first_block + 1;
+    
+    for (uint8_t page = first_page; page <= last_page; page++) {
+        uint8_t mask = 0xFF;
+        if (page == first_page) mask &= PAGE_MASK_FROM[y % 8];
+        if (page == last_page) mask &= PAGE_MASK_TO[(y_end - 1) % 8];
+        
+        uint8_t* row = &framebuffer[page * DISPLAY_WIDTH + x];
+        if (mask == 0xFF) {
+            /* Whole page rows covered: plain byte fill */
+            memset(row, color ? 0xFF : 0x00, width);
+        } else if (color) {
+            for (uint8_t i = 0; i < width; i++) row[i] |= mask;
+        } else {
+            for (uint8_t i = 0; i < width; i++) row[i] &= ~mask;
+        }
+        
+        memset(&dirty_regions[page * BLOCK_COLS + first_block], 1, blocks);
     }
 }
 
+void DisplaySSD1306Impl::draw_hline(uint8_t x, uint8_t y, uint8_t width, uint8_t color) {
+    fill_span(x, y, width, 1, color);
+}
+
 void DisplaySSD1306Impl::draw_vline(uint8_t x, uint8_t y, uint8_t height, uint8_t color) {
-    for (uint8_t i = 0; i < height && (y + i) < DISPLAY_HEIGHT; i++) {
-        draw_pixel(x, y + i, color);
-    }
+    fill_span(x, y, 1, height, color);
 }
 
 void DisplaySSD1306Impl::draw_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t color) {
@@ -145,75 +285,372 @@ void DisplaySSD1306Impl::draw_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, u
 }
 
 void DisplaySSD1306Impl::draw_filled_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t color) {
-    for (uint8_t i = 0; i < h; i++) {
-        draw_hline(x, y + i, w, color);
+    fill_span(x, y, w, h, color);
+}
+
+void DisplaySSD1306Impl::draw_columns(uint8_t x, uint8_t y, const uint8_t* columns, uint8_t width, uint8_t color) {
+    if (!columns || x >= DISPLAY_WIDTH || y >= DISPLAY_HEIGHT) return;
+    if (width > DISPLAY_WIDTH - x) width = DISPLAY_WIDTH - x;
+    if (width == 0) return;
+    
+    /* Columns straddle at most two pages: split each byte by y % 8 */
+    uint8_t page = y / 8;
+    uint8_t shift = y % 8;
+    bool has_lower = shift > 0 && (page + 1) < DISPLAY_PAGES;
+    uint8_t* top = &framebuffer[page * DISPLAY_WIDTH + x];
+    uint8_t* bottom = top + DISPLAY_WIDTH;
+    
+    for (uint8_t i = 0; i < width; i++) {
+        uint8_t bits = columns[i];
+        uint8_t upper = bits << shift;
+        
+        if (color) {
+            top[i] |= upper;
+        } else {
+            top[i] &= ~upper;
+        }
+        
+        if (has_lower) {
+            uint8_t lower = bits >> (8 - shift);
+            if (color) {
+                bottom[i] |= lower;
+            } else {
+                bottom[i] &= ~lower;
+            }
+        }
+    }
+    
+    /* Dirty blocks marked once per span */
+    uint8_t first_block = x / 8;
+    uint8_t blocks = (x + width - 1) / 8 - first_block + 1;
+    memset(&dirty_regions[page * BLOCK_COLS + first_block], 1, blocks);
+    if (has_lower) {
+        memset(&dirty_regions[(page + 1) * BLOCK_COLS + first_block], 1, blocks);
+    }
+}
+
+void DisplaySSD1306Impl::draw_sprite(uint8_t x, uint8_t y, uint8_t sprite_id) {
+    if (sprite_id >= SPRITE_COUNT || x >= DISPLAY_WIDTH || y >= DISPLAY_HEIGHT) return;
+    
+    const Sprite& sprite = SPRITES[sprite_id];
+    const uint8_t* data = SPRITE_ATLAS + sprite.offset;
+    uint8_t src_pages = (sprite.height + 7) / 8;
+    uint8_t width = sprite.width;
+    if (width > DISPLAY_WIDTH - x) width = DISPLAY_WIDTH - x;
+    if (width == 0) return;
+    
+    /* Each source page lands on at most two framebuffer pages */
+    uint8_t shift = y % 8;
+    uint8_t first_page = y / 8;
+    uint8_t last_page = first_page;
+    
+    for (uint8_t p = 0; p < src_pages; p++) {
+        uint8_t page = first_page + p;
+        if (page >= DISPLAY_PAGES) break;
+        bool has_lower = shift > 0 && (page + 1) < DISPLAY_PAGES;
+        
+        const uint8_t* src = &data[p * sprite.width * 2];
+        uint8_t* top = &framebuffer[page * DISPLAY_WIDTH + x];
+        uint8_t* bottom = top + DISPLAY_WIDTH;
+        
+        for (uint8_t i = 0; i < width; i++) {
+            uint8_t image = src[i * 2];
+            uint8_t mask = src[i * 2 + 1];
+            
+            top[i] = (top[i] & ~(uint8_t)(mask << shift)) | (uint8_t)(image << shift);
+            if (has_lower) {
+                bottom[i] = (bottom[i] & ~(uint8_t)(mask >> (8 - shift))) | (uint8_t)(image >> (8 - shift));
+            }
+        }
+        last_page = has_lower ? page + 1 : page;
+    }
+    
+    uint8_t first_block = x / 8;
+    uint8_t blocks = (x + width - 1) / 8 - first_block + 1;
+    for (uint8_t page = first_page; page <= last_page; page++) {
+        memset(&dirty_regions[page * BLOCK_COLS + first_block], 1, blocks);
     }
 }
 
 void DisplaySSD1306Impl::draw_text(uint8_t x, uint8_t y, const char* text, uint8_t color) {
-    if (!text) return;
+    if (!text || y >= DISPLAY_HEIGHT) return;
     
-    /* Simple monospace text: 6 pixels wide per character */
-    uint8_t char_width = 6;
-    for (size_t i = 0; text[i] && (x + i * char_width < DISPLAY_WIDTH); i++) {
-        /* Placeholder: just draw boxes for now */
-        draw_filled_rect(x + i * char_width, y, 5, 7, color);
+    uint16_t cx = x;
+    for (size_t i = 0; text[i] && cx < DISPLAY_WIDTH; i++, cx += FONT5X7_ADVANCE) {
+        uint8_t c = (uint8_t)text[i];
+        if (c < FONT5X7_FIRST || c > FONT5X7_LAST) c = '?';
+        draw_columns(cx, y, FONT5X7[c - FONT5X7_FIRST], FONT5X7_WIDTH, color);
     }
 }
 
+void DisplaySSD1306Impl::begin_stats() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+void DisplaySSD1306Impl::end_stats(uint32_t start_us) {
+    stats.bus_time_us = micros() - start_us;
+    
+    portENTER_CRITICAL(&swap_lock);
+    last_stats = stats;
+    portEXIT_CRITICAL(&swap_lock);
+}
+
 void DisplaySSD1306Impl::update() {
-    /* Partial update using dirty regions */
-    for (uint8_t page = 0; page < 8; page++) {
-        for (uint8_t col = 0; col < 16; col++) {
-            uint8_t region_idx = page * 16 + col;
-            if (dirty_regions[region_idx]) {
-                update_region(page, col);
-                dirty_regions[region_idx] = 0;
-            }
+    publish(false);
+}
+
+void DisplaySSD1306Impl::update_full() {
+    publish(true);
+}
+
+void DisplaySSD1306Impl::publish(bool full) {
+    uint32_t start_us = micros();
+    
+    /* Snapshot the draw buffer; the caller can keep drawing immediately */
+    memcpy(spare_frame->pixels, framebuffer, sizeof(framebuffer));
+    memcpy(spare_frame->dirty, dirty_regions, sizeof(dirty_regions));
+    spare_frame->full = full;
+    memset(dirty_regions, 0, sizeof(dirty_regions));
+    
+    if (!task) {
+        /* No task (init failed or not yet run): flush in the caller */
+        if (spare_frame->full || !shadow_valid) {
+            flush_all(spare_frame);
+        } else {
+            flush_diff(spare_frame);
         }
+        portENTER_CRITICAL(&swap_lock);
+        caller_block_us = micros() - start_us;
+        portEXIT_CRITICAL(&swap_lock);
+        return;
+    }
+    
+    portENTER_CRITICAL(&swap_lock);
+    if (frame_ready) {
+        /* Task has not taken the previous frame: fold its dirty set in */
+        for (size_t i = 0; i < sizeof(dirty_regions); i++) {
+            spare_frame->dirty[i] |= pending_frame->dirty[i];
+        }
+        spare_frame->full |= pending_frame->full;
+        frames_merged++;
     }
+    FrameSlot* published = spare_frame;
+    spare_frame = pending_frame;
+    pending_frame = published;
+    frame_ready = true;
+    portEXIT_CRITICAL(&swap_lock);
+    
+    xTaskNotifyGive(task);
+    
+    portENTER_CRITICAL(&swap_lock);
+    caller_block_us = micros() - start_us;
+    portEXIT_CRITICAL(&swap_lock);
 }
 
-void DisplaySSD1306Impl::update_full() {
-    /* Full display update: 8 pages, each 128 bytes */
-    for (uint8_t page = 0; page < 8; page++) {
-        /* Set page and column */
-        send_command(0xB0 | page);
-        send_command(0x00);
-        send_command(0x10);
+void DisplaySSD1306Impl::task_entry(void* arg) {
+    static_cast<DisplaySSD1306Impl*>(arg)->task_loop();
+}
+
+void DisplaySSD1306Impl::task_loop() {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        
+        apply_control_requests();
+        
+        bool have_frame = false;
+        portENTER_CRITICAL(&swap_lock);
+        if (frame_ready) {
+            FrameSlot* taken = pending_frame;
+            pending_frame = tx_frame;
+            tx_frame = taken;
+            frame_ready = false;
+            have_frame = true;
+        }
+        portEXIT_CRITICAL(&swap_lock);
         
-        /* Send 128 bytes of data for this page */
-        send_data(&framebuffer[page * DISPLAY_WIDTH], DISPLAY_WIDTH);
+        if (!have_frame) continue;
+        
+        bool full = tx_frame->full || !shadow_valid;
+        TRACE_BEGIN(TRACE_DISPLAY_FLUSH, full);
+        if (full) {
+            /* Panel RAM is unknown after power-up: send everything once */
+            flush_all(tx_frame);
+        } else {
+            flush_diff(tx_frame);
+        }
+        TRACE_END(TRACE_DISPLAY_FLUSH, 0);
+    }
+}
+
+void DisplaySSD1306Impl::apply_control_requests() {
+    portENTER_CRITICAL(&swap_lock);
+    uint8_t requests = pending_ctrl;
+    pending_ctrl = 0;
+    portEXIT_CRITICAL(&swap_lock);
+    
+    if (requests & CTRL_CONTRAST) {
+        send_command(0x81);
+        send_command(contrast);
+    }
+    if (requests & CTRL_SLEEP) {
+        send_command(0xAE);  /* Display off */
+    }
+    if (requests & CTRL_WAKE) {
+        send_command(0xAF);  /* Display on */
     }
 }
 
-void DisplaySSD1306Impl::update_region(uint8_t page, uint8_t col) {
-    if (page >= 8 || col >= 16) return;
+void DisplaySSD1306Impl::flush_diff(FrameSlot* frame) {
+    uint32_t start_us = micros();
+    begin_stats();
     
-    /* Set page and column (8 bytes per region) */
-    send_command(0xB0 | page);
-    send_command(0x00 | (col * 8));
-    send_command(0x10);
+    /* Pending window; a span identical to it on the next page extends it */
+    bool pending = false;
+    uint8_t win_p0 = 0, win_p1 = 0, win_c0 = 0, win_c1 = 0;
     
-    /* Send 8 bytes for this region */
-    uint16_t offset = page * DISPLAY_WIDTH + col * 8;
-    send_data(&framebuffer[offset], 8);
+    for (uint8_t page = 0; page < DISPLAY_PAGES; page++) {
+        const uint8_t* fb = &frame->pixels[page * DISPLAY_WIDTH];
+        const uint8_t* sh = &shadow[page * DISPLAY_WIDTH];
+        uint8_t* row = &frame->dirty[page * BLOCK_COLS];
+        
+        /* Byte-level diff, restricted to blocks touched since last flush */
+        int16_t span_start = -1;
+        int16_t span_end = -1;
+        for (uint8_t block = 0; block < BLOCK_COLS; block++) {
+            if (!row[block]) continue;
+            row[block] = 0;
+            
+            for (uint8_t col = block * 8; col < block * 8 + 8; col++) {
+                if (fb[col] == sh[col]) continue;
+                
+                if (span_start >= 0 && col - span_end > WINDOW_MERGE_GAP) {
+                    /* Gap too wide: close the current span */
+                    if (pending) flush_window(frame->pixels, win_p0, win_p1, win_c0, win_c1);
+                    pending = false;
+                    flush_window(frame->pixels, page, page, span_start, span_end);
+                    span_start = -1;
+                }
+                if (span_start < 0) span_start = col;
+                span_end = col;
+            }
+        }
+        
+        if (span_start < 0) continue;
+        
+        if (pending && win_p1 + 1 == page && win_c0 == span_start && win_c1 == span_end) {
+            win_p1 = page;
+        } else {
+            if (pending) flush_window(frame->pixels, win_p0, win_p1, win_c0, win_c1);
+            pending = true;
+            win_p0 = win_p1 = page;
+            win_c0 = span_start;
+            win_c1 = span_end;
+        }
+    }
+    
+    if (pending) flush_window(frame->pixels, win_p0, win_p1, win_c0, win_c1);
+    
+    end_stats(start_us);
+}
+
+void DisplaySSD1306Impl::flush_all(FrameSlot* frame) {
+    uint32_t start_us = micros();
+    begin_stats();
+    
+    /* Whole panel is one window: 1024 bytes in Wire-buffer-sized bursts */
+    flush_window(frame->pixels, 0, DISPLAY_PAGES - 1, 0, DISPLAY_WIDTH - 1);
+    memset(frame->dirty, 0, sizeof(frame->dirty));
+    shadow_valid = true;
+    
+    end_stats(start_us);
+}
+
+void DisplaySSD1306Impl::flush_window(const uint8_t* pixels, uint8_t page0, uint8_t page1, uint8_t col0, uint8_t col1) {
+    /* Column and page address window; the controller wraps within it */
+    const uint8_t window[] = {0x21, col0, col1, 0x22, page0, page1};
+    send_commands(window, sizeof(window));
+    stats.windows++;
+    
+    uint8_t width = col1 - col0 + 1;
+    for (uint8_t page = page0; page <= page1; page++) {
+        memcpy(&shadow[page * DISPLAY_WIDTH + col0], &pixels[page * DISPLAY_WIDTH + col0], width);
+    }
+    
+    if (width == DISPLAY_WIDTH) {
+        /* Full-width window is contiguous in the frame */
+        const uint8_t* src = &pixels[page0 * DISPLAY_WIDTH];
+        size_t remaining = (size_t)(page1 - page0 + 1) * DISPLAY_WIDTH;
+        while (remaining > 0) {
+            size_t n = (remaining < WIRE_BURST) ? remaining : WIRE_BURST;
+            send_data(src, n);
+            src += n;
+            remaining -= n;
+        }
+        return;
+    }
+    
+    /* Narrow window: gather page slices into full bursts */
+    uint8_t burst[WIRE_BURST];
+    size_t fill = 0;
+    for (uint8_t page = page0; page <= page1; page++) {
+        const uint8_t* src = &pixels[page * DISPLAY_WIDTH + col0];
+        for (uint8_t i = 0; i < width; i++) {
+            burst[fill++] = src[i];
+            if (fill == WIRE_BURST) {
+                send_data(burst, fill);
+                fill = 0;
+            }
+        }
+    }
+    if (fill > 0) {
+        send_data(burst, fill);
+    }
 }
 
 void DisplaySSD1306Impl::set_contrast(uint8_t value) {
     contrast = value;
-    send_command(0x81);
-    send_command(value);
+    if (!task) {
+        send_command(0x81);
+        send_command(value);
+        return;
+    }
+    portENTER_CRITICAL(&swap_lock);
+    pending_ctrl |= CTRL_CONTRAST;
+    portEXIT_CRITICAL(&swap_lock);
+    xTaskNotifyGive(task);
 }
 
 void DisplaySSD1306Impl::sleep() {
     powered = false;
-    send_command(0xAE);  /* Display off */
+    if (!task) {
+        send_command(0xAE);  /* Display off */
+        return;
+    }
+    portENTER_CRITICAL(&swap_lock);
+    pending_ctrl = (pending_ctrl & ~CTRL_WAKE) | CTRL_SLEEP;
+    portEXIT_CRITICAL(&swap_lock);
+    xTaskNotifyGive(task);
 }
 
 void DisplaySSD1306Impl::wake() {
     powered = true;
-    send_command(0xAF);  /* Display on */
+    if (!task) {
+        send_command(0xAF);  /* Display on */
+        return;
+    }
+    portENTER_CRITICAL(&swap_lock);
+    pending_ctrl = (pending_ctrl & ~CTRL_SLEEP) | CTRL_WAKE;
+    portEXIT_CRITICAL(&swap_lock);
+    xTaskNotifyGive(task);
+}
+
+DisplayFlushStats DisplaySSD1306Impl::get_flush_stats() const {
+    portENTER_CRITICAL(&swap_lock);
+    DisplayFlushStats copy = last_stats;
+    copy.caller_block_us = caller_block_us;
+    copy.frames_merged = frames_merged;
+    portEXIT_CRITICAL(&swap_lock);
+    return copy;
 }
 
 /* Global singleton */
@@ -0,0 +1,451 @@
+#include "equalizer.h"
+#include "config.h"
+#include "log.h"
+#include <cmath>
+#include <cstring>
+
+/* ============================================================================
+ * Equalizer Implementation
+ * Bands are designed from the RBJ cookbook (double, cold path) whenever a
+ * setting changes and quantised to Q28. The audio path is integer only:
+ * samples enter the cascade with SIGNAL_SHIFT extra fraction bits, each
+ * band is Direct Form I with a 64-bit accumulator, and the output is
+ * rounded and saturated once. A block of EQ_BLOCK_FRAMES runs one band at
+ * a time so its coefficients stay in registers; settled identity bands are
+ * skipped, keeping only their input history for when they wake up.
+ *
+ * Glides interpolate coefficients linearly, one step per block. The stable
+ * region of (a1, a2) is a triangle, which is convex, so every filter on the
+ * way between two stable ones is stable too. A band switched on or off
+ * glides against its own 0 dB design rather than identity, which keeps the
+ * intermediate curves between the two endpoints.
+ *
+ * Boosts get headroom: the peak of the settled curve is taken off up front
+ * (folded into band 0's numerator), so full-scale content in a boosted
+ * range does not clip.
+ * ========================================================================== */
+
+#define LOG_MODULE LOG_MOD_AUDIO
+
+static const int COEF_SHIFT = 28;             /* Q28: coefficients within ±8 */
+static const int32_t COEF_ONE = 1 << COEF_SHIFT;
+static const int SIGNAL_SHIFT = 8;            /* Fraction bits carried between bands */
+static const uint8_t HEADROOM_POINTS = 48;    /* Log-spaced probes, 20 Hz–20 kHz */
+
+struct EqPreset {
+    const char* name;
+    EqBand bands[EQ_BANDS];
+};
+
+/* Low shelf, three peaking, high shelf: {Hz, dB x10, Q x100} */
+static const EqPreset PRESETS[] = {
+    {"Flat",          {{100,    0, 71}, {250,    0, 100}, {1000,   0, 100}, {3500,   0, 100}, {8000,    0, 71}}},
+    {"Small speaker", {{150,   60, 71}, {300,  -20, 140}, {1000,   0, 100}, {3000,  25, 100}, {10000,  30, 71}}},
+    {"Bass boost",    {{90,    80, 71}, {250,  -15, 100}, {1000,   0, 100}, {3500,   0, 100}, {8000,    0, 71}}},
+    {"Vocal",         {{120,  -30, 71}, {300,    0, 100}, {1500,  20,  90}, {3500,  35, 120}, {9000,  -10, 71}}},
+    {"Loudness",      {{100,   60, 71}, {250,    0, 100}, {1000,   0, 100}, {3500,   0, 100}, {8000,   40, 71}}},
+};
+static const uint8_t PRESET_COUNT = sizeof(PRESETS) / sizeof(PRESETS[0]);
+
+class EqualizerImpl : public Equalizer {
+private:
+    /* a0 normalised away: y = b0 x + b1 x1 + b2 x2 - a1 y1 - a2 y2 */
+    struct Biquad {
+        int32_t b0, b1, b2, a1, a2;
+    };
+    
+    struct History {
+        int32_t x1, x2, y1, y2;
+    };
+    
+    uint32_t sample_rate = AUDIO_SAMPLE_RATE;
+    bool enabled = true;
+    uint8_t preset = EQ_DEFAULT_PRESET;
+    EqBand bands[EQ_BANDS] = {};
+    
+    /* Settled design (no headroom); neutral = same band at 0 dB (b == a) */
+    Biquad design[EQ_BANDS] = {};
+    Biquad neutral[EQ_BANDS] = {};
+    float preamp_db = 0.0f;
+    
+    /* Glide endpoints, and what cur snaps to once it arrives */
+    Biquad from[EQ_BANDS] = {};
+    Biquad target[EQ_BANDS] = {};
+    Biquad settle[EQ_BANDS] = {};
+    Biquad cur[EQ_BANDS] = {};
+    bool live[EQ_BANDS] = {};       /* cur[b] is not identity */
+    uint16_t ramp_steps = 1;
+    uint16_t ramp_left = 0;
+    
+    History history[EQ_BANDS][AUDIO_CHANNELS] = {};
+    int16_t bypass_tail[4] = {};    /* Last two stereo frames seen while bypassed */
+    
+    static Biquad identity();
+    static bool is_identity(const Biquad& c);
+    static float biquad_db(const Biquad& c, float w);
+    EqBandType type_of(uint8_t band) const;
+    Biquad design_band(uint8_t band, int16_t gain_db10) const;
+    void apply_preamp(Biquad& c) const;
+    void redesign(bool glide);
+    void retarget(bool glide);
+    void step_glide();
+    void run_band(uint8_t band, int32_t* block, size_t frames);
+    void keep_history(uint8_t band, const int32_t* block, size_t frames);
+
+public:
+    bool init() override;
+    void process(int16_t* pcm, size_t sample_count) override;
+    void set_sample_rate(uint32_t rate_hz) override;
+    void set_enabled(bool on) override;
+    bool is_enabled() const override;
+    uint8_t get_preset_count() const override;
+    const char* get_preset_name(uint8_t index) const override;
+    bool select_preset(uint8_t index) override;
+    uint8_t get_preset() const override;
+    bool set_band(uint8_t band, const EqBand& settings) override;
+    EqBand get_band(uint8_t band) const override;
+    EqBandType get_band_type(uint8_t band) const override;
+    uint8_t get_active_bands() const override;
+    float get_response_db(float freq_hz) const override;
+    float get_preamp_db() const override;
+};
+
+/* ============================================================================
+ * Design (cold path)
+ * ========================================================================== */
+
+EqualizerImpl::Biquad EqualizerImpl::identity() {
+    Biquad c = {COEF_ONE, 0, 0, 0, 0};
+    return c;
+}
+
+bool EqualizerImpl::is_identity(const Biquad& c) {
+    return c.b0 == COEF_ONE && c.b1 == 0 && c.b2 == 0 && c.a1 == 0 && c.a2 == 0;
+}
+
+float EqualizerImpl::biquad_db(const Biquad& c, float w) {
+    /* |B(e^jw)| / |A(e^jw)| with the quantised coefficients */
+    float c1 = cosf(w), s1 = sinf(w), c2 = cosf(2 * w), s2 = sinf(2 * w);
+    float k = 1.0f / COEF_ONE;
+    float nr = c.b0 * k + c.b1 * k * c1 + c.b2 * k * c2;
+    float ni = -(c.b1 * k * s1 + c.b2 * k * s2);
+    float dr = 1.0f + c.a1 * k * c1 + c.a2 * k * c2;
+    float di = -(c.a1 * k * s1 + c.a2 * k * s2);
+    return 10.0f * log10f((nr * nr + ni * ni) / (dr * dr + di * di));
+}
+
+EqBandType EqualizerImpl::type_of(uint8_t band) const {
+    if (band == 0) return EQ_LOW_SHELF;
+    return (band == EQ_BANDS - 1) ? EQ_HIGH_SHELF : EQ_PEAKING;
+}
+
+EqualizerImpl::Biquad EqualizerImpl::design_band(uint8_t band, int16_t gain_db10) const {
+    const EqBand& s = bands[band];
+    if (s.freq_hz == 0 || s.q100 == 0 || s.freq_hz * 2 >= sample_rate) {
+        return identity();
+    }
+    
+    double A = pow(10.0, gain_db10 / 400.0);
+    double w0 = 2.0 * M_PI * s.freq_hz / sample_rate;
+    double cs = cos(w0);
+    double alpha = sin(w0) / (2.0 * s.q100 / 100.0);
+    double sq = 2.0 * sqrt(A) * alpha;
+    double b0, b1, b2, a0, a1, a2;
+    
+    switch (type_of(band)) {
+        case EQ_LOW_SHELF:
+            b0 = A * ((A + 1) - (A - 1) * cs + sq);
+            b1 = 2 * A * ((A - 1) - (A + 1) * cs);
+            b2 = A * ((A + 1) - (A - 1) * cs - sq);
+            a0 = (A + 1) + (A - 1) * cs + sq;
+            a1 = -2 * ((A - 1) + (A + 1) * cs);
+            a2 = (A + 1) + (A - 1) * cs - sq;
+            break;
+        case EQ_HIGH_SHELF:
+            b0 = A * ((A + 1) + (A - 1) * cs + sq);
+            b1 = -2 * A * ((A - 1) + (A + 1) * cs);
+            b2 = A * ((A + 1) + (A - 1) * cs - sq);
+            a0 = (A + 1) - (A - 1) * cs + sq;
+            a1 = 2 * ((A - 1) - (A + 1) * cs);
+            a2 = (A + 1) - (A - 1) * cs - sq;
+            break;
+        case EQ_PEAKING:
+        default:
+            b0 = 1 + alpha * A;
+            b1 = -2 * cs;
+            b2 = 1 - alpha * A;
+            a0 = 1 + alpha / A;
+            a1 = -2 * cs;
+            a2 = 1 - alpha / A;
+            break;
+    }
+    
+    Biquad c = {
+        (int32_t)llround(b0 / a0 * COEF_ONE), (int32_t)llround(b1 / a0 * COEF_ONE),
+        (int32_t)llround(b2 / a0 * COEF_ONE), (int32_t)llround(a1 / a0 * COEF_ONE),
+        (int32_t)llround(a2 / a0 * COEF_ONE)
+    };
+    return c;
+}
+
+void EqualizerImpl::apply_preamp(Biquad& c) const {
+    double g = pow(10.0, preamp_db / 20.0);
+    c.b0 = (int32_t)llround(c.b0 * g);
+    c.b1 = (int32_t)llround(c.b1 * g);
+    c.b2 = (int32_t)llround(c.b2 * g);
+}
+
+void EqualizerImpl::redesign(bool glide) {
+    for (uint8_t b = 0; b < EQ_BANDS; b++) {
+        design[b] = bands[b].gain_db10 ? design_band(b, bands[b].gain_db10) : identity();
+        neutral[b] = design_band(b, 0);
+    }
+    
+    /* Headroom: peak of the whole curve, probed on a log grid */
+    float peak_db = 0.0f;
+    for (uint8_t i = 0; i < HEADROOM_POINTS; i++) {
+        float f = 20.0f * powf(1000.0f, i / (float)(HEADROOM_POINTS - 1));
+        if (f * 2 >= sample_rate) break;
+        float db = get_response_db(f);
+        if (db > peak_db) peak_db = db;
+    }
+    preamp_db = -peak_db;
+    retarget(glide);
+}
+
+void EqualizerImpl::retarget(bool glide) {
+    /* Off bands glide to/from their neutral form, never to identity: with the
+     * poles held in place the path between the endpoints cannot overshoot.
+     * Identity (skipped) is only what a flat band snaps to on arrival. */
+    for (uint8_t b = 0; b < EQ_BANDS; b++) {
+        bool on = enabled && bands[b].gain_db10 != 0;
+        target[b] = on ? design[b] : neutral[b];
+        settle[b] = on ? design[b] : identity();
+    }
+    
+    /* Headroom folded into band 0's numerator (a gain stage if it is flat) */
+    if (enabled && preamp_db < 0.0f) {
+        apply_preamp(target[0]);
+        if (is_identity(settle[0])) settle[0] = neutral[0];
+        apply_preamp(settle[0]);
+    }
+    
+    uint32_t glide_frames = sample_rate * EQ_RAMP_MS / 1000;
+    ramp_steps = (uint16_t)(glide_frames / EQ_BLOCK_FRAMES);
+    if (ramp_steps == 0) ramp_steps = 1;
+    
+    if (glide) {
+        for (uint8_t b = 0; b < EQ_BANDS; b++) {
+            from[b] = is_identity(cur[b]) ? neutral[b] : cur[b];
+        }
+        ramp_left = ramp_steps;
+    } else {
+        memcpy(cur, settle, sizeof(cur));
+        ramp_left = 0;
+    }
+    for (uint8_t b = 0; b < EQ_BANDS; b++) {
+        live[b] = !is_identity(cur[b]) || (ramp_left > 0 && !is_identity(target[b]));
+    }
+}
+
+/* ============================================================================
+ * Audio path
+ * ========================================================================== */
+
+void EqualizerImpl::step_glide() {
+    ramp_left--;
+    int64_t k = ramp_steps - ramp_left;
+    for (uint8_t b = 0; b < EQ_BANDS; b++) {
+        if (ramp_left == 0) {
+            cur[b] = settle[b];
+        } else {
+            const int32_t* f = &from[b].b0;
+            const int32_t* t = &target[b].b0;
+            int32_t* c = &cur[b].b0;
+            for (uint8_t i = 0; i < 5; i++) {
+                c[i] = (int32_t)(f[i] + ((int64_t)t[i] - f[i]) * k / ramp_steps);
+            }
+        }
+        live[b] = !is_identity(cur[b]);
+    }
+}
+
+void EqualizerImpl::run_band(uint8_t band, int32_t* block, size_t frames) {
+    const Biquad c = cur[band];
+    for (uint8_t ch = 0; ch < AUDIO_CHANNELS; ch++) {
+        History h = history[band][ch];
+        for (size_t i = ch; i < frames * AUDIO_CHANNELS; i += AUDIO_CHANNELS) {
+            int32_t x = block[i];
+            int64_t acc = (int64_t)c.b0 * x + (int64_t)c.b1 * h.x1 + (int64_t)c.b2 * h.x2
+                        - (int64_t)c.a1 * h.y1 - (int64_t)c.a2 * h.y2;
+            int32_t y = (int32_t)((acc + (1 << (COEF_SHIFT - 1))) >> COEF_SHIFT);
+            h.x2 = h.x1;
+            h.x1 = x;
+            h.y2 = h.y1;
+            h.y1 = y;
+            block[i] = y;
+        }
+        history[band][ch] = h;
+    }
+}
+
+void EqualizerImpl::keep_history(uint8_t band, const int32_t* block, size_t frames) {
+    /* Identity band: output == input, so its history is the input's tail */
+    for (uint8_t ch = 0; ch < AUDIO_CHANNELS; ch++) {
+        History& h = history[band][ch];
+        if (frames >= 2) {
+            h.x2 = block[(frames - 2) * AUDIO_CHANNELS + ch];
+        } else {
+            h.x2 = h.x1;
+        }
+        h.x1 = block[(frames - 1) * AUDIO_CHANNELS + ch];
+        h.y1 = h.x1;
+        h.y2 = h.x2;
+    }
+}
+
+void EqualizerImpl::process(int16_t* pcm, size_t sample_count) {
+    size_t frames = sample_count / AUDIO_CHANNELS;
+    if (!pcm || frames == 0) return;
+    
+    /* Bypassed and settled: free, apart from the tail a re-enable resumes from */
+    if (!enabled && ramp_left == 0) {
+        size_t keep = (frames >= 2) ? 2 : 1;
+        memmove(bypass_tail, bypass_tail + keep * AUDIO_CHANNELS, (2 - keep) * AUDIO_CHANNELS * sizeof(int16_t));
+        memcpy(bypass_tail + (2 - keep) * AUDIO_CHANNELS, pcm + (frames - keep) * AUDIO_CHANNELS,
+               keep * AUDIO_CHANNELS * sizeof(int16_t));
+        return;
+    }
+    
+    int32_t block[EQ_BLOCK_FRAMES * AUDIO_CHANNELS];
+    while (frames > 0) {
+        size_t n = (frames < EQ_BLOCK_FRAMES) ? frames : EQ_BLOCK_FRAMES;
+        size_t count = n * AUDIO_CHANNELS;
+        if (ramp_left > 0) step_glide();
+        
+        for (size_t i = 0; i < count; i++) {
+            block[i] = (int32_t)pcm[i] << SIGNAL_SHIFT;
+        }
+        for (uint8_t b = 0; b < EQ_BANDS; b++) {
+            if (live[b]) {
+                run_band(b, block, n);
+            } else {
+                keep_history(b, block, n);
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            int32_t y = (block[i] + (1 << (SIGNAL_SHIFT - 1))) >> SIGNAL_SHIFT;
+            pcm[i] = (int16_t)(y > 32767 ? 32767 : (y < -32768 ? -32768 : y));
+        }
+        
+        pcm += count;
+        frames -= n;
+    }
+}
+
+/* ============================================================================
+ * Settings
+ * ========================================================================== */
+
+bool EqualizerImpl::init() {
+    memcpy(bands, PRESETS[preset].bands, sizeof(bands));
+    redesign(false);
+    LOG_I("[EQ] %u bands, preset %s", (unsigned)EQ_BANDS, PRESETS[preset].name);
+    return true;
+}
+
+void EqualizerImpl::set_sample_rate(uint32_t rate_hz) {
+    if (rate_hz == 0 || rate_hz == sample_rate) return;
+    sample_rate = rate_hz;
+    redesign(false);
+}
+
+void EqualizerImpl::set_enabled(bool on) {
+    if (on == enabled) return;
+    
+    /* Leaving bypass: every band resumes from the last frames that went by */
+    if (on && ramp_left == 0) {
+        for (uint8_t b = 0; b < EQ_BANDS; b++) {
+            for (uint8_t ch = 0; ch < AUDIO_CHANNELS; ch++) {
+                History& h = history[b][ch];
+                h.x1 = h.y1 = (int32_t)bypass_tail[AUDIO_CHANNELS + ch] << SIGNAL_SHIFT;
+                h.x2 = h.y2 = (int32_t)bypass_tail[ch] << SIGNAL_SHIFT;
+            }
+        }
+    }
+    enabled = on;
+    retarget(true);
+    LOG_I("[EQ] %s", enabled ? "ON" : "OFF");
+}
+
+bool EqualizerImpl::is_enabled() const {
+    return enabled;
+}
+
+uint8_t EqualizerImpl::get_preset_count() const {
+    return PRESET_COUNT;
+}
+
+const char* EqualizerImpl::get_preset_name(uint8_t index) const {
+    return (index < PRESET_COUNT) ? PRESETS[index].name : nullptr;
+}
+
+bool EqualizerImpl::select_preset(uint8_t index) {
+    if (index >= PRESET_COUNT) return false;
+    
+    preset = index;
+    memcpy(bands, PRESETS[index].bands, sizeof(bands));
+    redesign(true);
+    LOG_I("[EQ] Preset %s", PRESETS[index].name);
+    return true;
+}
+
+uint8_t EqualizerImpl::get_preset() const {
+    return preset;
+}
+
+bool EqualizerImpl::set_band(uint8_t band, const EqBand& settings) {
+    if (band >= EQ_BANDS) return false;
+    
+    bands[band] = settings;
+    redesign(true);
+    return true;
+}
+
+EqBand EqualizerImpl::get_band(uint8_t band) const {
+    return (band < EQ_BANDS) ? bands[band] : EqBand();
+}
+
+EqBandType EqualizerImpl::get_band_type(uint8_t band) const {
+    return type_of(band);
+}
+
+uint8_t EqualizerImpl::get_active_bands() const {
+    if (!enabled && ramp_left == 0) return 0;
+    
+    uint8_t count = 0;
+    for (uint8_t b = 0; b < EQ_BANDS; b++) {
+        if (live[b]) count++;
+    }
+    return count;
+}
+
+float EqualizerImpl::get_response_db(float freq_hz) const {
+    float w = 2.0f * (float)M_PI * freq_hz / sample_rate;
+    float db = 0.0f;
+    for (uint8_t b = 0; b < EQ_BANDS; b++) {
+        if (!is_identity(design[b])) db += biquad_db(design[b], w);
+    }
+    return db;
+}
+
+float EqualizerImpl::get_preamp_db() const {
+    return preamp_db;
+}
+
+/* Global singleton */
+static EqualizerImpl g_equalizer;
+
+Equalizer* create_equalizer() {
+    return &g_equalizer;
+}
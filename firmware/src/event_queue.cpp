@@ -1,80 +1,272 @@
 #include "event_queue.h"
 #include "config.h"
+#include "log.h"
 #include <Arduino.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
+#include <freertos/semphr.h>
 
 /* ============================================================================
- * Event Queue Implementation
- * FreeRTOS-based thread-safe queue for inter-task communication
+ * Event Bus Implementation
+ * One FreeRTOS queue per lane plus a counting semaphore that is given once
+ * per enqueued item, so a consumer blocks on a single object and then
+ * takes from the real-time lane before the UI lane.
+ *
+ * Coalescing: for an idempotent type only one copy sits in a lane; later
+ * posts merge into a side slot (skip counts add up, state changes keep the
+ * newest param) that is folded into the event when it is received.
+ *
+ * A post reserves its lane slot under the lock before the event is marked
+ * pending, so the send that follows cannot fail: a post that was merged
+ * into a pending event is never lost with it.
  * ========================================================================== */
 
+#define LOG_MODULE LOG_MOD_EVENT
+
+/* Types merged while pending, and how their params combine */
+enum CoalesceMode {
+    COALESCE_NONE,
+    COALESCE_DROP,      /* Already pending is enough (redraw) */
+    COALESCE_SUM,       /* Params add up (skip N tracks) */
+    COALESCE_LATEST,    /* Newest param wins (state change) */
+};
+
+struct CoalesceSlot {
+    EventType type;
+    CoalesceMode mode;
+    bool pending;
+    uint32_t param;
+};
+
+struct Subscriber {
+    EventType type;
+    EventHandler handler;
+    void* context;
+};
+
 class EventQueueImpl : public EventQueue {
 private:
-    QueueHandle_t xQueue;
+    QueueHandle_t lanes[LANE_COUNT];
+    SemaphoreHandle_t available;
+    
+    /* Items queued or reserved per lane (never below the queue's own count) */
+    uint16_t lane_used[LANE_COUNT] = {0, 0};
     
+    CoalesceSlot coalesce[4] = {
+        {EVENT_PLAYBACK_NEXT,        COALESCE_SUM,    false, 0},
+        {EVENT_PLAYBACK_PREV,        COALESCE_SUM,    false, 0},
+        {EVENT_DISPLAY_REDRAW,       COALESCE_DROP,   false, 0},
+        {EVENT_DISPLAY_STATE_CHANGE, COALESCE_LATEST, false, 0},
+    };
+    
+    Subscriber subscribers[EVENT_MAX_SUBSCRIBERS];
+    uint8_t subscriber_count = 0;
+    
+    EventBusStats stats = {};
+    
+    /* Guards coalescing slots and counters (shared with ISRs, both cores) */
+    mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    
+    CoalesceSlot* find_slot(EventType type);
+    bool merge(const Event& event);
+    bool reserve(const Event& event, EventLane lane);
+    void finish_receive(EventLane lane, Event& event);
+
 public:
     EventQueueImpl();
     ~EventQueueImpl();
     
     bool post(const Event& event) override;
+    bool post_from_isr(const Event& event, int* woken) override;
     bool wait_and_receive(Event& event, uint32_t timeout_ms) override;
     bool try_receive(Event& event) override;
     size_t pending_count() const override;
+    bool subscribe(EventType type, EventHandler handler, void* context) override;
+    size_t dispatch(uint32_t timeout_ms) override;
+    const EventBusStats& get_stats() const override;
 };
 
 EventQueueImpl::EventQueueImpl() {
-    /* Create FreeRTOS queue: 20 event capacity */
-    xQueue = xQueueCreate(20, sizeof(Event));
-    if (xQueue == nullptr) {
+    lanes[LANE_REALTIME] = xQueueCreate(EVENT_QUEUE_SIZE_RT, sizeof(Event));
+    lanes[LANE_UI] = xQueueCreate(EVENT_QUEUE_SIZE, sizeof(Event));
+    available = xSemaphoreCreateCounting(EVENT_QUEUE_SIZE_RT + EVENT_QUEUE_SIZE, 0);
+    
+    if (!lanes[LANE_REALTIME] || !lanes[LANE_UI] || !available) {
         Serial.println("[EVT] FATAL: Could not create event queue");
     }
 }
 
 EventQueueImpl::~EventQueueImpl() {
-    if (xQueue) {
-        vQueueDelete(xQueue);
+    for (uint8_t i = 0; i < LANE_COUNT; i++) {
+        if (lanes[i]) vQueueDelete(lanes[i]);
+    }
+    if (available) {
+        vSemaphoreDelete(available);
+    }
+}
+
+CoalesceSlot* EventQueueImpl::find_slot(EventType type) {
+    for (uint8_t i = 0; i < sizeof(coalesce) / sizeof(coalesce[0]); i++) {
+        if (coalesce[i].type == type) return &coalesce[i];
+    }
+    return nullptr;
+}
+
+/* Under `lock`. Returns false if the event still has to be enqueued */
+bool EventQueueImpl::merge(const Event& event) {
+    CoalesceSlot* slot = find_slot(event.type);
+    if (!slot || !slot->pending) return false;
+    
+    if (slot->mode == COALESCE_SUM) {
+        slot->param += event.param;
+    } else if (slot->mode == COALESCE_LATEST) {
+        slot->param = event.param;
+    }
+    stats.coalesced++;
+    stats.posted++;
+    return true;
+}
+
+/* Under `lock`: claim a lane slot (false: lane full, dropped) */
+bool EventQueueImpl::reserve(const Event& event, EventLane lane) {
+    static const uint16_t capacity[LANE_COUNT] = {EVENT_QUEUE_SIZE_RT, EVENT_QUEUE_SIZE};
+    if (lane_used[lane] >= capacity[lane]) {
+        stats.dropped++;
+        return false;
+    }
+    
+    lane_used[lane]++;
+    stats.posted++;
+    if (lane_used[lane] > stats.depth_high_water[lane]) {
+        stats.depth_high_water[lane] = lane_used[lane];
     }
+    
+    /* Later posts merge into this one from now on: it will be sent */
+    CoalesceSlot* slot = find_slot(event.type);
+    if (slot) {
+        slot->pending = true;
+        slot->param = event.param;
+    }
+    return true;
 }
 
 bool EventQueueImpl::post(const Event& event) {
-    if (!xQueue) return false;
+    EventLane lane = event_lane(event.type);
+    if (!lanes[lane]) return false;
     
-    /* Non-blocking post from interrupt or task context */
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    BaseType_t result = xQueueSendToBackFromISR(xQueue, &event, &xHigherPriorityTaskWoken);
+    portENTER_CRITICAL(&lock);
+    bool merged = merge(event);
+    bool reserved = !merged && reserve(event, lane);
+    portEXIT_CRITICAL(&lock);
+    if (merged) return true;
     
-    if (result == pdFAIL) {
-        Serial.println("[EVT] WARNING: Event queue full");
+    /* Task context: never block the poster, report a full lane instead */
+    if (!reserved) {
+        LOG_W("[EVT] WARNING: Lane %d full, dropped 0x%02X", (int)lane, (unsigned)event.type);
         return false;
     }
     
-    if (xHigherPriorityTaskWoken) {
-        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
-    }
+    /* Cannot fail: the slot is ours */
+    xQueueSendToBack(lanes[lane], &event, 0);
+    xSemaphoreGive(available);
+    return true;
+}
+
+bool EventQueueImpl::post_from_isr(const Event& event, int* woken) {
+    EventLane lane = event_lane(event.type);
+    if (!lanes[lane]) return false;
+    
+    portENTER_CRITICAL_ISR(&lock);
+    bool merged = merge(event);
+    bool reserved = !merged && reserve(event, lane);
+    portEXIT_CRITICAL_ISR(&lock);
+    if (merged) return true;
+    if (!reserved) return false;  /* No logging here: ISR path only counts */
     
+    BaseType_t higher_woken = pdFALSE;
+    xQueueSendToBackFromISR(lanes[lane], &event, &higher_woken);
+    xSemaphoreGiveFromISR(available, &higher_woken);
+    if (woken) {
+        *woken = (*woken) || higher_woken;
+    }
     return true;
 }
 
+/* Release the lane slot and fold in what was merged while pending */
+void EventQueueImpl::finish_receive(EventLane lane, Event& event) {
+    portENTER_CRITICAL(&lock);
+    lane_used[lane]--;
+    CoalesceSlot* slot = find_slot(event.type);
+    if (slot && slot->pending) {
+        event.param = slot->param;
+        slot->pending = false;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
 bool EventQueueImpl::wait_and_receive(Event& event, uint32_t timeout_ms) {
-    if (!xQueue) return false;
+    if (!available) return false;
     
-    TickType_t timeout_ticks = (timeout_ms == 0) ? portMAX_DELAY : (timeout_ms / portTICK_PERIOD_MS);
-    BaseType_t result = xQueueReceive(xQueue, &event, timeout_ticks);
+    TickType_t timeout_ticks = (timeout_ms == EVENT_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    if (xSemaphoreTake(available, timeout_ticks) != pdTRUE) {
+        return false;
+    }
     
-    return (result == pdTRUE);
+    /* One token per enqueued item: one of the lanes is non-empty */
+    for (uint8_t i = 0; i < LANE_COUNT; i++) {
+        if (xQueueReceive(lanes[i], &event, 0) == pdTRUE) {
+            finish_receive((EventLane)i, event);
+            return true;
+        }
+    }
+    return false;
 }
 
 bool EventQueueImpl::try_receive(Event& event) {
-    if (!xQueue) return false;
-    
-    BaseType_t result = xQueueReceive(xQueue, &event, 0);  /* No timeout */
-    return (result == pdTRUE);
+    return wait_and_receive(event, 0);
 }
 
 size_t EventQueueImpl::pending_count() const {
-    if (!xQueue) return 0;
-    return uxQueueMessagesWaiting(xQueue);
+    size_t count = 0;
+    for (uint8_t i = 0; i < LANE_COUNT; i++) {
+        if (lanes[i]) count += uxQueueMessagesWaiting(lanes[i]);
+    }
+    return count;
+}
+
+bool EventQueueImpl::subscribe(EventType type, EventHandler handler, void* context) {
+    if (!handler || subscriber_count >= EVENT_MAX_SUBSCRIBERS) {
+        LOG_W("[EVT] WARNING: Subscriber table full");
+        return false;
+    }
+    
+    subscribers[subscriber_count].type = type;
+    subscribers[subscriber_count].handler = handler;
+    subscribers[subscriber_count].context = context;
+    subscriber_count++;
+    return true;
+}
+
+size_t EventQueueImpl::dispatch(uint32_t timeout_ms) {
+    size_t handled = 0;
+    Event event;
+    
+    /* Wait (as wait_and_receive) for the first event, then drain without waiting */
+    bool got = wait_and_receive(event, timeout_ms);
+    while (got) {
+        for (uint8_t i = 0; i < subscriber_count; i++) {
+            if (subscribers[i].type == event.type) {
+                subscribers[i].handler(event, subscribers[i].context);
+            }
+        }
+        handled++;
+        got = try_receive(event);
+    }
+    return handled;
+}
+
+const EventBusStats& EventQueueImpl::get_stats() const {
+    return stats;
 }
 
 /* Global singleton */
@@ -0,0 +1,107 @@
+#include "latency_monitor.h"
+#include "config.h"
+#include <Arduino.h>
+#include <cstring>
+
+/* ============================================================================
+ * Latency Monitor Implementation
+ * 100 us buckets up to 20 ms plus an overflow bucket: percentiles come
+ * from a cumulative walk, no sample storage or sorting, and resolve the
+ * sub-2 ms edge-to-action target. One input is in flight at a time; a
+ * newer input before the action replaces the older one.
+ * ========================================================================== */
+
+class LatencyMonitorImpl : public LatencyMonitor {
+private:
+    static const uint32_t BUCKET_US = 100;
+    static const uint16_t BUCKETS = 200;   /* + 1 overflow bucket */
+    
+    uint32_t histogram[BUCKETS + 1];
+    uint32_t count = 0;
+    uint32_t max_us = 0;
+    
+    uint32_t waits = 0;
+    uint32_t wait_max_us = 0;
+    
+    volatile uint32_t input_us = 0;
+    volatile bool input_pending = false;
+    
+    uint32_t percentile(uint8_t pct) const;
+
+public:
+    LatencyMonitorImpl();
+    void mark_input(uint32_t time_us) override;
+    void mark_gesture_wait(uint32_t wait_us) override;
+    void mark_action() override;
+    void get_percentiles(LatencyPercentiles& out) const override;
+    void report() const override;
+};
+
+LatencyMonitorImpl::LatencyMonitorImpl() {
+    memset(histogram, 0, sizeof(histogram));
+}
+
+void LatencyMonitorImpl::mark_input(uint32_t time_us) {
+    input_us = time_us;
+    input_pending = true;
+}
+
+void LatencyMonitorImpl::mark_gesture_wait(uint32_t wait_us) {
+    waits++;
+    if (wait_us > wait_max_us) wait_max_us = wait_us;
+}
+
+void LatencyMonitorImpl::mark_action() {
+    if (!input_pending) return;
+    input_pending = false;
+    
+    uint32_t latency = micros() - input_us;
+    uint32_t bucket = latency / BUCKET_US;
+    histogram[bucket < BUCKETS ? bucket : BUCKETS]++;
+    count++;
+    if (latency > max_us) max_us = latency;
+}
+
+/* Upper edge of the bucket holding the pct-th percentile sample */
+uint32_t LatencyMonitorImpl::percentile(uint8_t pct) const {
+    if (count == 0) return 0;
+    
+    uint32_t rank = (count * pct + 99) / 100;
+    uint32_t seen = 0;
+    for (uint16_t i = 0; i < BUCKETS; i++) {
+        seen += histogram[i];
+        if (seen >= rank) return (i + 1) * BUCKET_US;
+    }
+    return max_us;
+}
+
+void LatencyMonitorImpl::get_percentiles(LatencyPercentiles& out) const {
+    out.count = count;
+    out.p50_us = percentile(50);
+    out.p90_us = percentile(90);
+    out.p99_us = percentile(99);
+    out.max_us = max_us;
+    out.waits = waits;
+    out.wait_max_us = wait_max_us;
+}
+
+void LatencyMonitorImpl::report() const {
+    LatencyPercentiles p;
+    get_percentiles(p);
+    if (p.count == 0) return;
+    
+    Serial.printf("[LAT] Input→action n=%u p50<%u us p90<%u us p99<%u us max=%u us\n",
+                 (unsigned)p.count, (unsigned)p.p50_us, (unsigned)p.p90_us,
+                 (unsigned)p.p99_us, (unsigned)p.max_us);
+    if (p.waits > 0) {
+        Serial.printf("[LAT] Double-press wait n=%u max=%u us (before the above)\n",
+                     (unsigned)p.waits, (unsigned)p.wait_max_us);
+    }
+}
+
+/* Global singleton */
+static LatencyMonitorImpl g_latency_monitor;
+
+LatencyMonitor* create_latency_monitor() {
+    return &g_latency_monitor;
+}
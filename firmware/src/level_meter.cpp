@@ -0,0 +1,137 @@
+#include "level_meter.h"
+#include "config.h"
+#include <Arduino.h>
+#include <cmath>
+#include <cstring>
+
+/* ============================================================================
+ * Level Meter Implementation
+ * Full-rate work per stereo frame is two abs/compare and two MACs. Band
+ * energies run on a mono mix decimated by LEVEL_METER_DECIMATION through
+ * two one-pole low-passes (250 Hz, 2 kHz): low = LP250, mid = LP2k - LP250,
+ * high = x - LP2k. Square roots are taken once per block when publishing.
+ *
+ * Publishing is a single-writer seqlock: the audio path bumps `sequence` to
+ * odd, copies the snapshot, bumps it back to even. Readers retry if they saw
+ * an odd or changed sequence, so neither side ever waits on a lock.
+ * ========================================================================== */
+
+/* One-pole coefficients in Q15: a = 1 - exp(-2*pi*fc/fs), fs = 44100 / 4 */
+static const int32_t LP_LOW_Q15  = 4351;   /* 250 Hz */
+static const int32_t LP_MID_Q15  = 22287;  /* 2 kHz */
+
+class LevelMeterImpl : public LevelMeter {
+private:
+    /* Block accumulators (audio path only) */
+    uint32_t frames = 0;
+    uint16_t peak[2] = {0, 0};
+    uint64_t sum_sq[2] = {0, 0};
+    uint64_t band_sq[LEVEL_METER_BANDS] = {0, 0, 0};
+    uint32_t band_samples = 0;
+    
+    /* Decimator and filter state */
+    int32_t decim_acc = 0;
+    uint8_t decim_count = 0;
+    int32_t lp_low = 0;
+    int32_t lp_mid = 0;
+    
+    /* Published snapshot */
+    volatile uint32_t sequence = 0;
+    LevelSnapshot published = {};
+    uint32_t blocks = 0;
+    
+    void filter_sample(int32_t x);
+    void publish();
+
+public:
+    void process(const int16_t* pcm, size_t sample_count) override;
+    void read(LevelSnapshot& out) const override;
+};
+
+void LevelMeterImpl::filter_sample(int32_t x) {
+    lp_low += (LP_LOW_Q15 * (x - lp_low)) >> 15;
+    lp_mid += (LP_MID_Q15 * (x - lp_mid)) >> 15;
+    
+    int32_t low = lp_low;
+    int32_t mid = lp_mid - lp_low;
+    int32_t high = x - lp_mid;
+    /* Full-scale steps take mid to ~0.65 × 65535, near the 46341 limit of an
+     * int32 square (and x - lp can reach 65535): square in 64 bits */
+    band_sq[0] += (uint64_t)((int64_t)low * low);
+    band_sq[1] += (uint64_t)((int64_t)mid * mid);
+    band_sq[2] += (uint64_t)((int64_t)high * high);
+    band_samples++;
+}
+
+void LevelMeterImpl::process(const int16_t* pcm, size_t sample_count) {
+    if (!pcm) return;
+    
+    size_t count = sample_count / AUDIO_CHANNELS;
+    for (size_t i = 0; i < count; i++, pcm += AUDIO_CHANNELS) {
+        int32_t l = pcm[0];
+        int32_t r = pcm[1];
+        
+        uint16_t al = (uint16_t)(l < 0 ? -l : l);
+        uint16_t ar = (uint16_t)(r < 0 ? -r : r);
+        if (al > peak[0]) peak[0] = al;
+        if (ar > peak[1]) peak[1] = ar;
+        sum_sq[0] += (uint32_t)(l * l);
+        sum_sq[1] += (uint32_t)(r * r);
+        
+        decim_acc += l + r;
+        if (++decim_count == LEVEL_METER_DECIMATION) {
+            /* Box-car average of the mono mix doubles as the anti-alias filter */
+            filter_sample(decim_acc / (2 * LEVEL_METER_DECIMATION));
+            decim_acc = 0;
+            decim_count = 0;
+        }
+        
+        if (++frames == LEVEL_METER_BLOCK_FRAMES) {
+            publish();
+        }
+    }
+}
+
+void LevelMeterImpl::publish() {
+    LevelSnapshot snap;
+    for (uint8_t ch = 0; ch < 2; ch++) {
+        snap.peak[ch] = peak[ch] > 32767 ? 32767 : peak[ch];
+        snap.rms[ch] = (uint16_t)sqrtf((float)sum_sq[ch] / (float)frames);
+    }
+    for (uint8_t b = 0; b < LEVEL_METER_BANDS; b++) {
+        float ms = band_samples ? (float)band_sq[b] / (float)band_samples : 0.0f;
+        float rms = sqrtf(ms);
+        snap.band[b] = (uint16_t)(rms > 32767.0f ? 32767.0f : rms);
+    }
+    snap.blocks = ++blocks;
+    
+    sequence = sequence + 1;  /* Odd: write in progress */
+    __sync_synchronize();
+    published = snap;
+    __sync_synchronize();
+    sequence = sequence + 1;  /* Even: stable */
+    
+    frames = 0;
+    band_samples = 0;
+    memset(peak, 0, sizeof(peak));
+    memset(sum_sq, 0, sizeof(sum_sq));
+    memset(band_sq, 0, sizeof(band_sq));
+}
+
+void LevelMeterImpl::read(LevelSnapshot& out) const {
+    uint32_t before, after;
+    do {
+        before = sequence;
+        __sync_synchronize();
+        out = published;
+        __sync_synchronize();
+        after = sequence;
+    } while ((before & 1) || before != after);
+}
+
+/* Global singleton */
+static LevelMeterImpl g_level_meter;
+
+LevelMeter* create_level_meter() {
+    return &g_level_meter;
+}
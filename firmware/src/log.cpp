@@ -0,0 +1,187 @@
+#include "log.h"
+#include "config.h"
+#include "memory_telemetry.h"
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <cstdio>
+#include <cstring>
+
+/* ============================================================================
+ * Deferred Logger Implementation
+ * Producers take a short spinlock, copy one fixed record and leave: no
+ * formatting, no UART, no allocation. A full ring drops the new record and
+ * counts it rather than blocking the caller. The drain task copies records
+ * out under the same lock and writes them at its own pace.
+ *
+ * Binary frame (little-endian, LOG_BINARY = 1):
+ *   0x00 0xA5 'L' | u32 fmt address | u32 micros | u8 module | u8 level |
+ *   u8 arg_count | arg_count × u32
+ * The leading NUL never occurs in text output, so frames can be picked out
+ * of a capture that mixes them with ordinary Serial prints.
+ * ========================================================================== */
+
+#if (LOG_RING_RECORDS & (LOG_RING_RECORDS - 1)) != 0
+    #error "LOG_RING_RECORDS must be a power of 2"
+#endif
+
+struct LogRecord {
+    const char* fmt;
+    uint32_t time_us;
+    uint8_t module;
+    uint8_t level;
+    uint8_t arg_count;
+    uintptr_t args[LOG_MAX_ARGS];  /* One word each (32-bit on the ESP32) */
+};
+
+class LoggerImpl : public Logger {
+private:
+    LogRecord ring[LOG_RING_RECORDS];
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    
+    LogStats stats = {};
+    uint64_t cycles_total = 0;
+    uint32_t reported_records = 0;
+    uint32_t reported_dropped = 0;
+    
+    TaskHandle_t task = nullptr;
+    mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    
+    static void task_entry(void* arg);
+    void task_loop();
+    void write_record(const LogRecord& rec);
+
+public:
+    /* Called by log_emit() directly, without a virtual call */
+    void emit(uint8_t module, uint8_t level, const char* fmt, const uintptr_t* args, uint8_t count);
+    
+    bool init() override;
+    void get_stats(LogStats& out) const override;
+    void report() override;
+};
+
+void IRAM_ATTR LoggerImpl::emit(uint8_t module, uint8_t level, const char* fmt, const uintptr_t* args, uint8_t count) {
+    uint32_t start = ESP.getCycleCount();
+    uint32_t now_us = micros();
+    
+    portENTER_CRITICAL_SAFE(&lock);
+    if (head - tail >= LOG_RING_RECORDS) {
+        stats.dropped++;
+        portEXIT_CRITICAL_SAFE(&lock);
+        return;
+    }
+    
+    LogRecord& rec = ring[head & (LOG_RING_RECORDS - 1)];
+    rec.fmt = fmt;
+    rec.time_us = now_us;
+    rec.module = module;
+    rec.level = level;
+    rec.arg_count = count;
+    for (uint8_t i = 0; i < count; i++) {
+        rec.args[i] = args[i];
+    }
+    head++;
+    
+    /* Cost as seen by the caller, measured up to the end of the copy */
+    uint32_t cycles = ESP.getCycleCount() - start;
+    stats.records++;
+    cycles_total += cycles;
+    if (cycles > stats.cycles_max) stats.cycles_max = cycles;
+    portEXIT_CRITICAL_SAFE(&lock);
+}
+
+bool LoggerImpl::init() {
+    if (task) return true;
+    
+    /* ESP-IDF takes the stack depth in bytes */
+    if (xTaskCreate(task_entry, "log", TASK_STACK_WORDS_LOG * 4, this,
+                    TASK_PRIORITY_LOG, &task) != pdPASS) {
+        task = nullptr;
+        Serial.println("[LOG] FATAL: Drain task not started");
+        return false;
+    }
+    create_memory_telemetry()->register_task(MEM_TASK_LOG, task, TASK_STACK_WORDS_LOG * 4);
+    return true;
+}
+
+void LoggerImpl::task_entry(void* arg) {
+    static_cast<LoggerImpl*>(arg)->task_loop();
+}
+
+void LoggerImpl::task_loop() {
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_INTERVAL_MS));
+        
+        while (true) {
+            LogRecord rec;
+            portENTER_CRITICAL(&lock);
+            bool have = (tail != head);
+            if (have) {
+                rec = ring[tail & (LOG_RING_RECORDS - 1)];
+                tail++;
+            }
+            portEXIT_CRITICAL(&lock);
+            
+            if (!have) break;
+            write_record(rec);
+        }
+    }
+}
+
+void LoggerImpl::write_record(const LogRecord& rec) {
+#if LOG_BINARY
+    uint8_t frame[3 + 4 + 4 + 3 + LOG_MAX_ARGS * 4] = {0x00, 0xA5, 'L'};
+    size_t len = 3;
+    uint32_t fmt_addr = (uint32_t)(uintptr_t)rec.fmt;
+    memcpy(&frame[len], &fmt_addr, 4);
+    len += 4;
+    memcpy(&frame[len], &rec.time_us, 4);
+    len += 4;
+    frame[len++] = rec.module;
+    frame[len++] = rec.level;
+    frame[len++] = rec.arg_count;
+    for (uint8_t i = 0; i < rec.arg_count; i++) {
+        uint32_t word = (uint32_t)rec.args[i];
+        memcpy(&frame[len], &word, 4);
+        len += 4;
+    }
+    Serial.write(frame, len);
+#else
+    /* Every argument (including %s pointers) is passed as one word */
+    static_assert(LOG_MAX_ARGS == 4, "text mode passes args[0..3]: extend the snprintf below");
+    char line[128];
+    snprintf(line, sizeof(line), rec.fmt, rec.args[0], rec.args[1], rec.args[2], rec.args[3]);
+    Serial.println(line);
+#endif
+}
+
+void LoggerImpl::get_stats(LogStats& out) const {
+    portENTER_CRITICAL(&lock);
+    out = stats;
+    out.cycles_avg = stats.records ? (uint32_t)(cycles_total / stats.records) : 0;
+    portEXIT_CRITICAL(&lock);
+}
+
+void LoggerImpl::report() {
+    LogStats s;
+    get_stats(s);
+    if (s.records == reported_records && s.dropped == reported_dropped) return;
+    reported_records = s.records;
+    reported_dropped = s.dropped;
+    
+    Serial.printf("[LOG] %u records, %u dropped, %u cycles/call avg (max %u)\n",
+                 (unsigned)s.records, (unsigned)s.dropped,
+                 (unsigned)s.cycles_avg, (unsigned)s.cycles_max);
+}
+
+/* Global singleton */
+static LoggerImpl g_logger;
+
+Logger* create_logger() {
+    return &g_logger;
+}
+
+void IRAM_ATTR log_emit(uint8_t module, uint8_t level, const char* fmt, const uintptr_t* args, uint8_t count) {
+    g_logger.emit(module, level, fmt, args, count);
+}
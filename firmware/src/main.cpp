@@ -13,6 +13,13 @@
 #include "event_queue.h"
 #include "ui.h"
 #include "playback_control.h"
+#include "playlist.h"
+#include "latency_monitor.h"
+#include "equalizer.h"
+#include "memory_telemetry.h"
+#include "trace.h"
+#include "log.h"
+#include "config.h"
 
 /* Module instances */
 extern SDCard* create_sd_card();
@@ -24,6 +31,11 @@ extern EventQueue* create_event_queue();
 extern UI* create_ui();
 extern PlaybackController* create_playback_controller();
 
+/* Arduino core default when the build does not define it */
+#ifndef CONFIG_ARDUINO_LOOP_STACK_SIZE
+#define CONFIG_ARDUINO_LOOP_STACK_SIZE 8192
+#endif
+
 SDCard* g_sd_card = nullptr;
 AudioDecoder* g_decoder = nullptr;
 BluetoothA2DP* g_bt = nullptr;
@@ -32,16 +44,164 @@ ButtonHandler* g_buttons = nullptr;
 EventQueue* g_event_queue = nullptr;
 UI* g_ui = nullptr;
 PlaybackController* g_playback = nullptr;
+MemoryTelemetry* g_telemetry = nullptr;
+
+/* ============================================================================
+ * Event subscribers: button gestures → playback commands. Track skips go
+ * through the bus as EVENT_PLAYBACK_NEXT/PREV, so presses that queue up
+ * while the loop is busy coalesce into one skip of N tracks (one load).
+ * ========================================================================== */
+static void post_skip(EventType type, PlaybackController* playback, PlaybackCommand fallback) {
+    Event skip = {type, 1};
+    if (!g_event_queue->post(skip)) {
+        playback->execute_command(fallback);  /* Lane full: skip now, uncoalesced */
+    }
+}
+
+static void on_button(const Event& event, void* context) {
+    PlaybackController* playback = static_cast<PlaybackController*>(context);
+    PlaybackCommand cmd = CMD_NONE;
+    
+    switch (event.type) {
+        case EVENT_BUTTON_PREV:
+            if (event.param == GESTURE_SHORT) post_skip(EVENT_PLAYBACK_PREV, playback, CMD_PLAY_PREV);
+            else if (event.param == GESTURE_LONG || event.param == GESTURE_REPEAT) cmd = CMD_SCAN_BACKWARD;
+            else if (event.param == GESTURE_HOLD_END) cmd = CMD_SCAN_STOP;
+            break;
+        case EVENT_BUTTON_PLAY:
+            if (event.param == GESTURE_SHORT) cmd = CMD_TOGGLE_PLAY_PAUSE;
+            else if (event.param == GESTURE_DOUBLE) cmd = CMD_TOGGLE_SHUFFLE;
+            else if (event.param == GESTURE_LONG) cmd = CMD_STOP;
+            break;
+        case EVENT_BUTTON_NEXT:
+            if (event.param == GESTURE_SHORT) post_skip(EVENT_PLAYBACK_NEXT, playback, CMD_PLAY_NEXT);
+            else if (event.param == GESTURE_LONG || event.param == GESTURE_REPEAT) cmd = CMD_SCAN_FORWARD;
+            else if (event.param == GESTURE_HOLD_END) cmd = CMD_SCAN_STOP;
+            break;
+        default:
+            break;
+    }
+    
+    if (cmd != CMD_NONE && playback) {
+        playback->execute_command(cmd);
+    }
+}
+
+static void on_skip(const Event& event, void* context) {
+    PlaybackController* playback = static_cast<PlaybackController*>(context);
+    int32_t tracks = (int32_t)event.param;
+    playback->skip(event.type == EVENT_PLAYBACK_NEXT ? tracks : -tracks);
+}
+
+/* ============================================================================
+ * Boot: SD mount and Bluetooth bring-up run on their own tasks while the
+ * loop task brings up the display and the remaining modules; setup() joins
+ * them before reporting ready. The library scan follows the mount on the SD
+ * task and reaches playback as EVENT_SD_LIBRARY_READY, so it never holds up
+ * PLAY. Every phase is timestamped (us since app start) and reported.
+ * ========================================================================== */
+enum BootPhase {
+    BOOT_CORE,       /* Telemetry, logger, event bus */
+    BOOT_DISPLAY,
+    BOOT_SD_MOUNT,
+    BOOT_BT,
+    BOOT_MODULES,    /* Decoder, UI, buttons, playback */
+    BOOT_LIBRARY,    /* Background scan, usually done after ready */
+    BOOT_PHASE_COUNT
+};
+
+static const char* const BOOT_PHASE_NAMES[BOOT_PHASE_COUNT] = {
+    "core", "display", "sd-mount", "bt", "modules", "library"
+};
+
+/* Each slot is written by one task before it signals (notify or event) */
+static uint32_t boot_start_us[BOOT_PHASE_COUNT];
+static uint32_t boot_end_us[BOOT_PHASE_COUNT];
+static TaskHandle_t boot_waiter = nullptr;
+
+static void boot_begin(BootPhase phase) {
+    boot_start_us[phase] = micros();
+}
+
+static void boot_end(BootPhase phase) {
+    boot_end_us[phase] = micros();
+}
+
+static void boot_report_phase(BootPhase phase) {
+    Serial.printf("[BOOT] %-8s %8.1f %8.1f ms\n", BOOT_PHASE_NAMES[phase],
+                  boot_start_us[phase] / 1000.0, boot_end_us[phase] / 1000.0);
+}
+
+static void boot_sd_mount() {
+    boot_begin(BOOT_SD_MOUNT);
+    Serial.println("[INIT] Initializing SD card...");
+    if (!g_sd_card->init()) {
+        Serial.println("WARN: SD card init failed");
+    }
+    boot_end(BOOT_SD_MOUNT);
+}
+
+static void boot_library_scan() {
+    if (!g_sd_card->is_mounted()) return;
+    
+    /* Curated playlist overrides root directory order when present */
+    boot_begin(BOOT_LIBRARY);
+    Playlist* playlist = create_playlist();
+    uint32_t param = (playlist && playlist->open(PLAYLIST_AUTOLOAD_PATH)) ?
+        (playlist->get_count() | LIBRARY_FROM_PLAYLIST) : (uint32_t)g_sd_card->count_files();
+    boot_end(BOOT_LIBRARY);
+    
+    Event event = {EVENT_SD_LIBRARY_READY, param};
+    if (!g_event_queue->post(event)) {
+        Serial.println("WARN: Library scan result dropped");
+    }
+}
+
+static void boot_bt() {
+    boot_begin(BOOT_BT);
+    Serial.println("[INIT] Initializing Bluetooth A2DP...");
+    if (!g_bt->init()) {
+        Serial.println("WARN: Bluetooth init failed");
+    }
+    boot_end(BOOT_BT);
+}
+
+/* Boot tasks register themselves (they may finish before xTaskCreate
+ * returns) and leave their final stack mark before deleting themselves */
+static void sd_boot_task(void* arg) {
+    g_telemetry->register_task(MEM_TASK_SD_BOOT, xTaskGetCurrentTaskHandle(), TASK_STACK_WORDS_SD * 4);
+    boot_sd_mount();
+    xTaskNotifyGive(boot_waiter);
+    boot_library_scan();
+    g_telemetry->retire_task(MEM_TASK_SD_BOOT);
+    vTaskDelete(nullptr);
+}
+
+static void bt_boot_task(void* arg) {
+    g_telemetry->register_task(MEM_TASK_BT_BOOT, xTaskGetCurrentTaskHandle(), TASK_STACK_WORDS_BT * 4);
+    boot_bt();
+    g_telemetry->retire_task(MEM_TASK_BT_BOOT);
+    xTaskNotifyGive(boot_waiter);
+    vTaskDelete(nullptr);
+}
 
-/* External update function */
-extern void button_handler_update();
+static void on_library(const Event& event, void* context) {
+    PlaybackController* playback = static_cast<PlaybackController*>(context);
+    bool from_playlist = (event.param & LIBRARY_FROM_PLAYLIST) != 0;
+    uint32_t tracks = event.param & ~LIBRARY_FROM_PLAYLIST;
+    
+    Serial.printf("[INIT] Library: %u tracks%s\n", (unsigned)tracks,
+                  from_playlist ? " from " PLAYLIST_AUTOLOAD_PATH : "");
+    boot_report_phase(BOOT_LIBRARY);
+    playback->set_library(tracks, from_playlist);
+}
 
 /* ============================================================================
  * Setup: Initialize all modules and prepare system
  * ========================================================================== */
 void setup() {
     Serial.begin(115200);
-    delay(1000);
+    boot_begin(BOOT_CORE);
     
     Serial.println("\n\n╔════════════════════════════════════════════════════════════╗");
     Serial.println("║       ESP32 Bluetooth MP3 Player - Starting Up             ║");
@@ -49,6 +209,14 @@ void setup() {
     Serial.printf("Build: %s %s\n", __DATE__, __TIME__);
     Serial.printf("Free heap: %d bytes\n", ESP.getFreeHeap());
     
+    /* Telemetry first: tasks register their stacks as modules start them */
+    g_telemetry = create_memory_telemetry();
+    g_telemetry->init();
+    g_telemetry->register_task(MEM_TASK_LOOP, xTaskGetCurrentTaskHandle(), CONFIG_ARDUINO_LOOP_STACK_SIZE);
+    
+    /* Deferred log drain: module LOG_* calls never block on the UART */
+    create_logger()->init();
+    
     /* Create event queue first (needed by other modules) */
     Serial.println("\n[INIT] Creating event queue...");
     g_event_queue = create_event_queue();
@@ -56,8 +224,29 @@ void setup() {
         Serial.println("FATAL: Event queue creation failed");
         while (1) delay(1000);
     }
+    boot_end(BOOT_CORE);
     
-    /* Initialize display early for feedback */
+    /* SD (SPI) and Bluetooth start in parallel; inline if a task cannot start */
+    boot_waiter = xTaskGetCurrentTaskHandle();
+    g_sd_card = create_sd_card();
+    g_bt = create_bluetooth_a2dp();
+    uint8_t joining = 0;
+    if (xTaskCreate(sd_boot_task, "sd", TASK_STACK_WORDS_SD * 4, nullptr,
+                    TASK_PRIORITY_SD, nullptr) == pdPASS) {
+        joining++;
+    } else {
+        boot_sd_mount();
+        boot_library_scan();
+    }
+    if (xTaskCreate(bt_boot_task, "bt-init", TASK_STACK_WORDS_BT * 4, nullptr,
+                    TASK_PRIORITY_BT_A2DP, nullptr) == pdPASS) {
+        joining++;
+    } else {
+        boot_bt();
+    }
+    
+    /* Display (I2C) on this task: first feedback while the others run */
+    boot_begin(BOOT_DISPLAY);
     Serial.println("[INIT] Initializing display...");
     g_display = create_display_ssd1306();
     if (!g_display || !g_display->init()) {
@@ -67,42 +256,19 @@ void setup() {
     g_display->clear();
     g_display->draw_text(10, 28, "Initializing...", 1);
     g_display->update_full();
+    boot_end(BOOT_DISPLAY);
     
-    /* Initialize SD card */
-    Serial.println("[INIT] Initializing SD card...");
-    g_sd_card = create_sd_card();
-    if (!g_sd_card || !g_sd_card->init()) {
-        Serial.println("WARN: SD card init failed");
-        g_display->clear();
-        g_display->draw_text(5, 28, "SD Card Failed", 1);
-        g_display->update_full();
-        delay(2000);
-    }
-    
-    /* List available MP3 files */
-    if (g_sd_card && g_sd_card->is_mounted()) {
-        const char* files[20];
-        int num_files = g_sd_card->list_files(files, 20);
-        Serial.printf("[INIT] Found %d MP3 files\n", num_files);
-        for (int i = 0; i < num_files && i < 5; i++) {
-            Serial.printf("  [%d] %s\n", i, files[i]);
-        }
-    }
-    
-    /* Initialize other modules */
+    /* Remaining modules only take references; none waits on SD or BT */
+    boot_begin(BOOT_MODULES);
     Serial.println("[INIT] Initializing audio decoder...");
     g_decoder = create_audio_decoder();
     if (!g_decoder) {
         Serial.println("WARN: Audio decoder creation failed");
     }
     
-    Serial.println("[INIT] Initializing Bluetooth A2DP...");
-    g_bt = create_bluetooth_a2dp();
-    if (g_bt) g_bt->init();
-    
     Serial.println("[INIT] Initializing UI...");
     g_ui = create_ui();
-    if (!g_ui) {
+    if (!g_ui || !g_ui->init()) {
         Serial.println("WARN: UI init failed");
     }
     
@@ -118,56 +284,55 @@ void setup() {
         Serial.println("WARN: Playback controller init failed");
     }
     
+    if (g_event_queue && g_playback) {
+        g_event_queue->subscribe(EVENT_BUTTON_PREV, on_button, g_playback);
+        g_event_queue->subscribe(EVENT_BUTTON_PLAY, on_button, g_playback);
+        g_event_queue->subscribe(EVENT_BUTTON_NEXT, on_button, g_playback);
+        g_event_queue->subscribe(EVENT_PLAYBACK_NEXT, on_skip, g_playback);
+        g_event_queue->subscribe(EVENT_PLAYBACK_PREV, on_skip, g_playback);
+        g_event_queue->subscribe(EVENT_SD_LIBRARY_READY, on_library, g_playback);
+    }
+    boot_end(BOOT_MODULES);
+    
+    /* Join: playback needs the card mounted and the sink initialised */
+    while (joining > 0) {
+        joining -= (uint8_t)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    
     /* Display ready screen */
     if (g_display) {
         g_display->clear();
         g_display->draw_text(15, 24, "Ready!", 1);
-        g_display->draw_text(5, 40, "Press Play", 1);
+        g_display->draw_text(5, 40, g_sd_card->is_mounted() ? "Press Play" : "No SD card", 1);
         g_display->update_full();
     }
     
     Serial.println("\n[INIT] Initialization complete");
     Serial.printf("Free heap: %d bytes\n", ESP.getFreeHeap());
+    Serial.println("[BOOT] phase       start      end");
+    for (uint8_t i = 0; i < BOOT_LIBRARY; i++) {
+        boot_report_phase((BootPhase)i);
+    }
+    Serial.printf("[BOOT] ready %.1f ms\n", micros() / 1000.0);
     Serial.println("════════════════════════════════════════════════════════════");
 }
 
 /* ============================================================================
- * Main Loop: Event processing and module updates
+ * Main Loop: blocks on the event bus until an event arrives or the next
+ * UI frame is due; button commands are applied inside dispatch()
  * ========================================================================== */
 void loop() {
-    /* Update button state (debounce check) */
-    if (g_buttons) {
-        button_handler_update();
-    }
-    
-    /* Process button events and convert to playback commands */
-    if (g_buttons) {
-        uint8_t button_id;
-        ButtonEvent event;
-        
-        while (g_buttons->get_event(button_id, event)) {
-            if (event != BUTTON_PRESSED) continue;  /* Ignore releases */
-            
-            PlaybackCommand cmd = CMD_NONE;
-            switch (button_id) {
-                case 0: /* PREV */
-                    cmd = CMD_PLAY_PREV;
-                    Serial.println("[MAIN] Button: PREV");
-                    break;
-                case 1: /* PLAY */
-                    cmd = CMD_TOGGLE_PLAY_PAUSE;
-                    Serial.println("[MAIN] Button: PLAY/PAUSE");
-                    break;
-                case 2: /* NEXT */
-                    cmd = CMD_PLAY_NEXT;
-                    Serial.println("[MAIN] Button: NEXT");
-                    break;
-            }
-            
-            if (cmd != CMD_NONE && g_playback) {
-                g_playback->execute_command(cmd);
-            }
-        }
+    static const uint32_t UI_PERIOD_MS = 1000 / DISPLAY_REFRESH_HZ;
+    static uint32_t last_ui_update = 0;
+    static uint32_t last_housekeeping = 0;
+    
+    /* Sleep until an event or the next frame (no fixed polling delay) */
+    uint32_t elapsed = millis() - last_ui_update;
+    uint32_t wait_ms = (elapsed >= UI_PERIOD_MS) ? 0 : UI_PERIOD_MS - elapsed;
+    if (g_event_queue) {
+        g_event_queue->dispatch(wait_ms);
+    } else {
+        delay(wait_ms);
     }
     
     /* Update playback state machine */
@@ -175,10 +340,9 @@ void loop() {
         g_playback->update();
     }
     
-    /* Update UI (every ~100 ms) */
-    static uint32_t last_ui_update = 0;
+    /* Update UI at DISPLAY_REFRESH_HZ */
     uint32_t now = millis();
-    if ((now - last_ui_update) >= 100) {
+    if ((now - last_ui_update) >= UI_PERIOD_MS) {
         if (g_ui && g_playback) {
             g_ui->update_track_info("Test Track", "Artist Name");
             g_ui->update_progress(
@@ -191,16 +355,34 @@ void loop() {
         last_ui_update = now;
     }
     
-    /* Periodic heap check (every 5 seconds) */
-    static uint32_t last_heap_check = 0;
-    if ((now - last_heap_check) >= 5000) {
-        uint32_t free_heap = ESP.getFreeHeap();
-        if (free_heap < 20000) {
-            Serial.printf("[WARN] Low heap: %d bytes\n", free_heap);
+    /* Memory watermarks (warns on low heap/stack) and latency report */
+    if ((now - last_housekeeping) >= MEM_SAMPLE_INTERVAL_MS) {
+        if (g_event_queue) {
+            const EventBusStats& bus = g_event_queue->get_stats();
+            g_telemetry->note_buffer_fill(MEM_BUF_EVENT_RT, bus.depth_high_water[LANE_REALTIME], EVENT_QUEUE_SIZE_RT);
+            g_telemetry->note_buffer_fill(MEM_BUF_EVENT_UI, bus.depth_high_water[LANE_UI], EVENT_QUEUE_SIZE);
         }
-        last_heap_check = now;
+        g_telemetry->sample();
+        create_latency_monitor()->report();
+        create_logger()->report();
+        last_housekeeping = now;
     }
     
-    /* Yield to other tasks */
-    delay(10);
+    /* Dumps and EQ presets on demand from the serial console */
+    if (Serial.available() > 0) {
+        int key = Serial.read();
+        if (key == MEM_DUMP_KEY) {
+            g_telemetry->sample();
+            g_telemetry->dump();
+        } else if (key == TRACE_DUMP_KEY) {
+            create_tracer()->dump();
+        } else if (key == EQ_PRESET_KEY) {
+            /* Same task as the audio pump: the change glides in from the next frame */
+            Equalizer* eq = create_equalizer();
+            eq->select_preset((uint8_t)((eq->get_preset() + 1) % eq->get_preset_count()));
+            const char* name = eq->get_preset_name(eq->get_preset());
+            Serial.printf("[EQ] Preset: %s\n", name);
+            if (g_ui) g_ui->show_info(name);
+        }
+    }
 }
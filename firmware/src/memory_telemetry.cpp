@@ -0,0 +1,252 @@
+#include "memory_telemetry.h"
+#include "config.h"
+#include <Arduino.h>
+#include <esp_system.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <cstring>
+
+/* ============================================================================
+ * Memory Telemetry Implementation
+ * The live record sits in RTC_NOINIT memory, which the bootloader leaves
+ * alone on every reset except power-on. Hot-path buffer peaks go to plain
+ * RAM and are folded into the record by sample(). Every change to the
+ * record (sample, task registration) reseals the CRC under `lock`, so a
+ * reset part-way through an update costs one sample period of data, never
+ * a corrupt record.
+ * ========================================================================== */
+
+#define MEM_RECORD_MAGIC 0x4D454D32  /* "MEM2": six task slots */
+
+static RTC_NOINIT_ATTR MemoryRecord rtc_record;
+
+static const char* const TASK_NAMES[MEM_TASK_COUNT] = {
+    "loop", "buttons", "display", "log", "sd-boot", "bt-boot"
+};
+static const char* const BUFFER_NAMES[MEM_BUF_COUNT] = {"audio", "evt-rt", "evt-ui", "btn-ring"};
+
+class MemoryTelemetryImpl : public MemoryTelemetry {
+private:
+    TaskHandle_t tasks[MEM_TASK_COUNT] = {};
+    volatile uint32_t peaks[MEM_BUF_COUNT] = {};
+    uint32_t capacities[MEM_BUF_COUNT] = {};
+    
+    MemoryRecord previous = {};
+    bool have_previous = false;
+    esp_reset_reason_t reset_reason = ESP_RST_UNKNOWN;
+    bool ready = false;
+    
+    /* Guards rtc_record and `tasks` (boot tasks register in parallel) */
+    mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    
+    static uint32_t crc32(const uint8_t* data, size_t len);
+    static void seal(MemoryRecord& record);
+    static bool valid(const MemoryRecord& record);
+    static const char* reset_name(esp_reset_reason_t reason);
+    static void print_record(const MemoryRecord& record);
+
+public:
+    bool init() override;
+    void register_task(MemTask task, void* handle, uint32_t stack_bytes) override;
+    void retire_task(MemTask task) override;
+    void note_buffer_fill(MemBuffer buffer, uint32_t fill, uint32_t capacity) override;
+    void sample() override;
+    void get_record(MemoryRecord& out) const override;
+    bool get_previous(MemoryRecord& out) const override;
+    void dump() const override;
+};
+
+uint32_t MemoryTelemetryImpl::crc32(const uint8_t* data, size_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+void MemoryTelemetryImpl::seal(MemoryRecord& record) {
+    record.magic = MEM_RECORD_MAGIC;
+    record.crc = crc32((const uint8_t*)&record, offsetof(MemoryRecord, crc));
+}
+
+bool MemoryTelemetryImpl::valid(const MemoryRecord& record) {
+    return record.magic == MEM_RECORD_MAGIC &&
+           record.crc == crc32((const uint8_t*)&record, offsetof(MemoryRecord, crc));
+}
+
+const char* MemoryTelemetryImpl::reset_name(esp_reset_reason_t reason) {
+    switch (reason) {
+        case ESP_RST_POWERON:   return "power-on";
+        case ESP_RST_SW:        return "software";
+        case ESP_RST_PANIC:     return "panic";
+        case ESP_RST_INT_WDT:   return "interrupt watchdog";
+        case ESP_RST_TASK_WDT:  return "task watchdog";
+        case ESP_RST_WDT:       return "watchdog";
+        case ESP_RST_BROWNOUT:  return "brownout";
+        case ESP_RST_DEEPSLEEP: return "deep sleep";
+        default:                return "other";
+    }
+}
+
+bool MemoryTelemetryImpl::init() {
+    if (ready) return true;
+    
+    /* RTC memory is random after power-on; the CRC rejects it anyway */
+    reset_reason = esp_reset_reason();
+    uint32_t boot_count = 1;
+    if (valid(rtc_record)) {
+        previous = rtc_record;
+        have_previous = true;
+        boot_count = previous.boot_count + 1;
+    }
+    
+    memset(&rtc_record, 0, sizeof(rtc_record));
+    rtc_record.boot_count = boot_count;
+    rtc_record.heap_free_min = ESP.getFreeHeap();
+    rtc_record.heap_largest_block_min = ESP.getMaxAllocHeap();
+    seal(rtc_record);
+    
+    ready = true;
+    Serial.printf("[MEM] Boot #%u after %s reset%s\n",
+                 (unsigned)boot_count, reset_name(reset_reason),
+                 have_previous ? " (previous record kept)" : "");
+    return true;
+}
+
+void MemoryTelemetryImpl::register_task(MemTask task, void* handle, uint32_t stack_bytes) {
+    if (task >= MEM_TASK_COUNT || !handle) return;
+    
+    portENTER_CRITICAL(&lock);
+    tasks[task] = (TaskHandle_t)handle;
+    rtc_record.stack_size[task] = stack_bytes;
+    rtc_record.stack_free_min[task] = stack_bytes;
+    seal(rtc_record);
+    portEXIT_CRITICAL(&lock);
+}
+
+void MemoryTelemetryImpl::retire_task(MemTask task) {
+    if (task >= MEM_TASK_COUNT) return;
+    
+    /* Own stack, still alive: the handle is not touched after this */
+    uint32_t free_bytes = uxTaskGetStackHighWaterMark(nullptr);
+    
+    portENTER_CRITICAL(&lock);
+    tasks[task] = nullptr;
+    if (free_bytes < rtc_record.stack_free_min[task]) {
+        rtc_record.stack_free_min[task] = free_bytes;
+    }
+    seal(rtc_record);
+    portEXIT_CRITICAL(&lock);
+}
+
+void MemoryTelemetryImpl::note_buffer_fill(MemBuffer buffer, uint32_t fill, uint32_t capacity) {
+    /* Racy max by design: a lost update is re-seen on the next peak */
+    if (fill > peaks[buffer]) {
+        peaks[buffer] = fill;
+        capacities[buffer] = capacity;
+    }
+}
+
+void MemoryTelemetryImpl::sample() {
+    if (!ready) return;
+    
+    uint32_t free_heap = ESP.getFreeHeap();
+    uint32_t min_heap = ESP.getMinFreeHeap();   /* Allocator's own low mark */
+    uint32_t largest = ESP.getMaxAllocHeap();
+    if (free_heap < MEM_HEAP_WARN_BYTES) {
+        Serial.printf("[MEM] WARNING: Low heap: %u bytes\n", (unsigned)free_heap);
+    }
+    
+    /* ESP-IDF reports the stack high-water mark in bytes. Polled outside
+     * the lock; a task retiring meanwhile is skipped (handle cleared) */
+    uint32_t stack_free[MEM_TASK_COUNT];
+    for (uint8_t i = 0; i < MEM_TASK_COUNT; i++) {
+        portENTER_CRITICAL(&lock);
+        TaskHandle_t task = tasks[i];
+        portEXIT_CRITICAL(&lock);
+        stack_free[i] = task ? uxTaskGetStackHighWaterMark(task) : UINT32_MAX;
+    }
+    
+    bool warn[MEM_TASK_COUNT] = {};
+    MemoryRecord& r = rtc_record;
+    portENTER_CRITICAL(&lock);
+    if (min_heap < r.heap_free_min) r.heap_free_min = min_heap;
+    if (largest < r.heap_largest_block_min) r.heap_largest_block_min = largest;
+    
+    for (uint8_t i = 0; i < MEM_TASK_COUNT; i++) {
+        if (tasks[i] && stack_free[i] < r.stack_free_min[i]) {
+            r.stack_free_min[i] = stack_free[i];
+            warn[i] = stack_free[i] < MEM_STACK_WARN_BYTES;
+        }
+    }
+    
+    for (uint8_t i = 0; i < MEM_BUF_COUNT; i++) {
+        r.buffer_peak[i] = peaks[i];
+        r.buffer_capacity[i] = capacities[i];
+    }
+    
+    r.uptime_ms = millis();
+    seal(r);
+    portEXIT_CRITICAL(&lock);
+    
+    for (uint8_t i = 0; i < MEM_TASK_COUNT; i++) {
+        if (warn[i]) {
+            Serial.printf("[MEM] WARNING: %s stack down to %u bytes free\n",
+                         TASK_NAMES[i], (unsigned)stack_free[i]);
+        }
+    }
+}
+
+void MemoryTelemetryImpl::get_record(MemoryRecord& out) const {
+    portENTER_CRITICAL(&lock);
+    out = rtc_record;
+    portEXIT_CRITICAL(&lock);
+}
+
+bool MemoryTelemetryImpl::get_previous(MemoryRecord& out) const {
+    if (!have_previous) return false;
+    out = previous;
+    return true;
+}
+
+void MemoryTelemetryImpl::print_record(const MemoryRecord& r) {
+    Serial.printf("[MEM]   boot #%u, up %u ms\n", (unsigned)r.boot_count, (unsigned)r.uptime_ms);
+    Serial.printf("[MEM]   heap free min %u B, largest block min %u B\n",
+                 (unsigned)r.heap_free_min, (unsigned)r.heap_largest_block_min);
+    
+    for (uint8_t i = 0; i < MEM_TASK_COUNT; i++) {
+        if (r.stack_size[i] == 0) continue;
+        Serial.printf("[MEM]   stack %-8s used %5u / %5u B\n", TASK_NAMES[i],
+                     (unsigned)(r.stack_size[i] - r.stack_free_min[i]),
+                     (unsigned)r.stack_size[i]);
+    }
+    
+    for (uint8_t i = 0; i < MEM_BUF_COUNT; i++) {
+        if (r.buffer_capacity[i] == 0) continue;
+        Serial.printf("[MEM]   buf   %-8s peak %5u / %5u (%u%%)\n", BUFFER_NAMES[i],
+                     (unsigned)r.buffer_peak[i], (unsigned)r.buffer_capacity[i],
+                     (unsigned)(r.buffer_peak[i] * 100 / r.buffer_capacity[i]));
+    }
+}
+
+void MemoryTelemetryImpl::dump() const {
+    MemoryRecord current;
+    get_record(current);
+    Serial.println("[MEM] Current:");
+    print_record(current);
+    
+    if (have_previous) {
+        Serial.printf("[MEM] Before %s reset:\n", reset_name(reset_reason));
+        print_record(previous);
+    }
+}
+
+/* Global singleton */
+static MemoryTelemetryImpl g_memory_telemetry;
+
+MemoryTelemetry* create_memory_telemetry() {
+    return &g_memory_telemetry;
+}
@@ -1,15 +1,38 @@
 #include "playback_control.h"
 #include "audio_decoder.h"
+#include "audio_arena.h"
+#include "equalizer.h"
 #include "bluetooth_a2dp.h"
 #include "sd_card.h"
 #include "ui.h"
+#include "shuffle.h"
+#include "playlist.h"
+#include "resume_journal.h"
+#include "latency_monitor.h"
+#include "trace.h"
+#include "log.h"
+#include "config.h"
 #include <Arduino.h>
 
 /* ============================================================================
  * Playback Control Implementation
  * Manages state machine: IDLE → LOADING → PLAYING → PAUSED → ERROR
+ * While PLAYING, update() pumps decoded frames into the A2DP sink until the
+ * decoder is AUDIO_PUMP_LEAD_MS ahead of the play position. Skips, seeks and
+ * pauses flush the sink so the change is heard without the queued tail.
  * ========================================================================== */
 
+#define LOG_MODULE LOG_MOD_PLAYBACK
+
+/* FNV-1a: cheap identity for the journaled track's path */
+static uint32_t path_hash(const char* path) {
+    uint32_t hash = 2166136261u;
+    for (const char* p = path; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    return hash;
+}
+
 class PlaybackControllerImpl : public PlaybackController {
 private:
     PlaybackState state = STATE_IDLE;
@@ -20,74 +43,177 @@ private:
     
     const char* current_file = nullptr;
     int current_file_index = 0;
+    int loaded_index = -1;  /* Track open in the decoder (-1: none) */
+    
+    /* Play order: position → track index (identity unless shuffling) */
+    uint32_t track_count = 0;
+    uint32_t order_pos = 0;
+    bool shuffle_enabled = false;
+    ShuffleOrder shuffle;
+    
+    /* Active playlist (nullptr → root directory order) */
+    Playlist* playlist = nullptr;
+    char current_path[PLAYLIST_PATH_MAX] = "";
+    
+    /* Power-cycle resume: journal point applied once the track list is known */
+    ResumeJournal* journal = nullptr;
+    ResumeRecord resume_point = {};
+    bool resume_pending = false;
+    bool resume_seek = false;
+    
+    /* Identity of the open track, journaled with the point */
+    uint32_t loaded_size = 0;
+    uint32_t loaded_hash = 0;
+    
+    /* Hold-to-scan: audio keeps playing between jumps (snippets) */
+    int8_t scan_direction = 0;
+    uint16_t scan_steps = 0;
     
     /* Module references (obtained at runtime) */
     AudioDecoder* decoder = nullptr;
     BluetoothA2DP* bt = nullptr;
     SDCard* sd = nullptr;
     UI* ui = nullptr;
+    LatencyMonitor* latency = nullptr;
+    Equalizer* eq = nullptr;
+    
+    /* Wall-clock base for position while playing (update() is not periodic) */
+    uint32_t last_tick_ms = 0;
+    
+    /* Decoded frame waiting for room in the sink (arena slice) */
+    int16_t* const pcm = audio_arena().pump_frame;
+    uint16_t pcm_pending = 0;
+    
+    /* Start of each frame decoded since the last flush, oldest first. The
+     * decoder runs up to AUDIO_PUMP_LEAD_MS ahead of what is heard; the
+     * journal maps the play position back to its frame through these */
+    struct FrameMark {
+        uint32_t position_ms;
+        uint32_t byte_offset;
+    };
+    static const uint8_t FRAME_MARKS = 16;  /* > lead / 24 ms (48 kHz frame) */
+    FrameMark frame_marks[FRAME_MARKS];
+    uint8_t marks_head = 0;
+    uint8_t marks_count = 0;
     
     void transition_to(PlaybackState new_state);
     void handle_command();
     void update_playback();
-    
+    void advance_position();
+    bool load_track();
+    void pump_audio();
+    void drop_queued_audio();
+    void step_track(int direction);
+    void scan_step(int direction);
+    void set_track_count(uint32_t count);
+    void apply_resume_point();
+    void heard_point(uint32_t& byte_offset, uint32_t& position_ms) const;
+    void save_resume_point(bool force);
+
 public:
     bool init() override;
     PlaybackState get_state() const override;
     void execute_command(PlaybackCommand cmd) override;
+    void skip(int32_t tracks) override;
     void update() override;
     uint32_t get_current_position_ms() const override;
     uint32_t get_total_duration_ms() const override;
+    void set_shuffle(bool enabled) override;
+    bool is_shuffle_enabled() const override;
+    void set_library(uint32_t track_count, bool from_playlist) override;
 };
 
 void PlaybackControllerImpl::transition_to(PlaybackState new_state) {
     if (new_state == state) return;
     
-    const char* state_names[] = {"IDLE", "LOADING", "PLAYING", "PAUSED", "ERROR"};
-    Serial.printf("[PLAYBACK] State: %s → %s\n", state_names[state], state_names[new_state]);
+    TRACE_SCOPE(TRACE_STATE_TRANSITION, new_state);
+    
+    static const char* const state_names[] = {"IDLE", "LOADING", "PLAYING", "PAUSED", "ERROR"};
+    LOG_I("[PLAYBACK] State: %s → %s", state_names[state], state_names[new_state]);
     
     state = new_state;
+    last_tick_ms = millis();
+    
+    if (state == STATE_PAUSED || state == STATE_IDLE) {
+        save_resume_point(true);
+    }
     
     if (ui) {
-        ui->update_playback_state((PlayerState)state);
-        ui->render();
+        /* Enums are ordered differently; map explicitly. Only the state widget
+         * is invalidated: the loop's refresh tick draws it, so marquee and
+         * meter timing stay tied to DISPLAY_REFRESH_HZ */
+        static const PlayerState ui_states[] = {
+            UI_STATE_IDLE, UI_STATE_LOADING, UI_STATE_PLAYING, UI_STATE_PAUSED, UI_STATE_ERROR
+        };
+        ui->update_playback_state(ui_states[state]);
     }
 }
 
 void PlaybackControllerImpl::handle_command() {
     if (pending_cmd == CMD_NONE) return;
     
-    Serial.printf("[PLAYBACK] Command: %d (state=%d)\n", pending_cmd, state);
+    LOG_D("[PLAYBACK] Command: %d (state=%d)", pending_cmd, state);
+    
+    /* Commands act on the position heard now, not at the last update() */
+    if (state == STATE_PLAYING) {
+        advance_position();
+    }
     
     switch (pending_cmd) {
         case CMD_PLAY_NEXT:
             if (state == STATE_PLAYING || state == STATE_PAUSED) {
                 transition_to(STATE_LOADING);
-                current_file_index++;
+                step_track(+1);
             }
             break;
-            
+        
         case CMD_PLAY_PREV:
             if (state == STATE_PLAYING || state == STATE_PAUSED) {
                 transition_to(STATE_LOADING);
-                if (current_file_index > 0) current_file_index--;
+                step_track(-1);
             }
             break;
-            
+        
         case CMD_TOGGLE_PLAY_PAUSE:
             if (state == STATE_PLAYING) {
+                /* Rewind the decoder over the dropped lead; the journal saves this point */
+                drop_queued_audio();
+                if (decoder) decoder->seek(current_position_ms);
                 transition_to(STATE_PAUSED);
             } else if (state == STATE_PAUSED || state == STATE_IDLE) {
                 transition_to(STATE_LOADING);
             }
             break;
-            
+        
         case CMD_STOP:
-            transition_to(STATE_IDLE);
+            /* Rewind before the IDLE transition journals the point */
+            drop_queued_audio();
             current_position_ms = 0;
+            resume_seek = false;
             if (decoder) decoder->close();
+            loaded_index = -1;
+            transition_to(STATE_IDLE);
+            save_resume_point(true);
             break;
-            
+        
+        case CMD_TOGGLE_SHUFFLE:
+            set_shuffle(!shuffle_enabled);
+            break;
+        
+        case CMD_SCAN_FORWARD:
+        case CMD_SCAN_BACKWARD:
+            if (state == STATE_PLAYING || state == STATE_PAUSED) {
+                scan_step(pending_cmd == CMD_SCAN_FORWARD ? +1 : -1);
+            }
+            break;
+        
+        case CMD_SCAN_STOP:
+            if (scan_direction != 0) {
+                LOG_I("[PLAYBACK] Scan stopped at %u ms", (unsigned)current_position_ms);
+                scan_direction = 0;
+            }
+            break;
+        
         case CMD_NONE:
         default:
             break;
@@ -96,30 +222,189 @@ void PlaybackControllerImpl::handle_command() {
     pending_cmd = CMD_NONE;
 }
 
+void PlaybackControllerImpl::step_track(int direction) {
+    drop_queued_audio();
+    current_position_ms = 0;
+    resume_seek = false;
+    scan_direction = 0;
+    
+    if (!shuffle_enabled || track_count < 2) {
+        if (direction > 0) {
+            current_file_index++;
+            if (track_count > 0 && (uint32_t)current_file_index >= track_count) {
+                current_file_index = 0;
+            }
+        } else if (current_file_index > 0) {
+            current_file_index--;
+        }
+        return;
+    }
+    
+    if (direction > 0) {
+        /* End of cycle: every track played once, start a fresh order */
+        if (++order_pos >= track_count) {
+            order_pos = 0;
+            shuffle.set_cycle(shuffle.get_cycle() + 1);
+        }
+    } else if (order_pos > 0) {
+        order_pos--;
+    } else if (shuffle.get_cycle() > 0) {
+        /* Step back into the previous cycle's order */
+        shuffle.set_cycle(shuffle.get_cycle() - 1);
+        order_pos = track_count - 1;
+    }
+    
+    current_file_index = (int)shuffle.track_at(order_pos);
+}
+
+void PlaybackControllerImpl::scan_step(int direction) {
+    if (direction != scan_direction) {
+        scan_direction = (int8_t)direction;
+        scan_steps = 0;
+    }
+    
+    uint32_t step = (scan_steps < SCAN_STEPS_PER_STAGE) ? SCAN_STEP_1_MS :
+                    (scan_steps < 2 * SCAN_STEPS_PER_STAGE) ? SCAN_STEP_2_MS : SCAN_STEP_3_MS;
+    scan_steps++;
+    
+    /* Scanning stays inside the track: clamp at its start and 1 s before its end */
+    uint32_t target;
+    if (direction < 0) {
+        target = (current_position_ms > step) ? current_position_ms - step : 0;
+    } else {
+        target = current_position_ms + step;
+        if (total_duration_ms > 1000 && target >= total_duration_ms - 1000) {
+            target = total_duration_ms - 1000;
+            if (target < current_position_ms) target = current_position_ms;
+        }
+    }
+    
+    /* Decoder lands on a frame boundary; its position is the truth */
+    if (decoder && decoder->seek(target)) {
+        current_position_ms = decoder->get_current_position_ms();
+    } else {
+        current_position_ms = target;
+    }
+    drop_queued_audio();
+}
+
+void PlaybackControllerImpl::advance_position() {
+    uint32_t now = millis();
+    current_position_ms += now - last_tick_ms;
+    last_tick_ms = now;
+}
+
+bool PlaybackControllerImpl::load_track() {
+    /* Playlist entries come from the sparse index, root tracks from a walk */
+    bool found = playlist ?
+        playlist->get_entry((uint32_t)current_file_index, current_path, sizeof(current_path)) :
+        sd->get_file_path(current_file_index, current_path, sizeof(current_path));
+    if (!found) {
+        LOG_W("[PLAYBACK] Track %d unavailable", current_file_index);
+        return false;
+    }
+    
+    current_file = current_path;
+    if (!decoder->open(current_file)) {
+        LOG_W("[PLAYBACK] Track %d failed to open", current_file_index);
+        loaded_index = -1;
+        return false;
+    }
+    total_duration_ms = decoder->get_duration_ms();
+    if (eq) eq->set_sample_rate(decoder->get_sample_rate());
+    loaded_index = current_file_index;
+    loaded_size = (uint32_t)sd->get_file_size();
+    loaded_hash = path_hash(current_path);
+    marks_count = 0;
+    return true;
+}
+
+void PlaybackControllerImpl::pump_audio() {
+    if (!decoder || !bt || !bt->is_connected()) return;
+    
+    while (true) {
+        if (pcm_pending == 0) {
+            uint32_t frame_ms = decoder->get_current_position_ms();
+            if (frame_ms >= current_position_ms + AUDIO_PUMP_LEAD_MS) break;
+            
+            FrameMark& mark = frame_marks[(marks_head + marks_count) % FRAME_MARKS];
+            mark.position_ms = frame_ms;
+            mark.byte_offset = decoder->get_byte_offset();
+            if (marks_count < FRAME_MARKS) {
+                marks_count++;
+            } else {
+                marks_head = (uint8_t)((marks_head + 1) % FRAME_MARKS);
+            }
+            
+            int samples = decoder->decode_frame(pcm, AUDIO_PCM_FRAME_SAMPLES);
+            if (samples <= 0) break;
+            if (eq) eq->process(pcm, (size_t)samples);
+            pcm_pending = (uint16_t)samples;
+        }
+        
+        /* Sink full: keep the frame for the next update() */
+        if (!bt->feed_audio(pcm, pcm_pending)) break;
+        pcm_pending = 0;
+    }
+}
+
+void PlaybackControllerImpl::drop_queued_audio() {
+    pcm_pending = 0;
+    marks_count = 0;
+    if (bt) bt->flush();
+}
+
 void PlaybackControllerImpl::update_playback() {
     if (state == STATE_IDLE || state == STATE_PAUSED) {
         return;
     }
     
     if (state == STATE_LOADING) {
-        /* Try to load next file */
         if (sd && decoder) {
-            // Try to open file at index (placeholder)
+            /* Resuming from pause keeps the open track (decoder is at the pause point) */
+            if (current_file_index != loaded_index && !load_track()) {
+                transition_to(STATE_ERROR);
+                return;
+            }
+            if (resume_seek) {
+                /* Jump to the journaled frame boundary (0: track start, where open() is),
+                 * unless the card changed and the index now names another file */
+                bool same_file = resume_point.file_size == loaded_size &&
+                                 resume_point.path_hash == loaded_hash;
+                if (resume_point.byte_offset != 0 && same_file) {
+                    decoder->resume_at(resume_point.byte_offset, resume_point.position_ms);
+                } else if (resume_point.byte_offset != 0) {
+                    LOG_W("[PLAYBACK] Resume point is for another file, track %d starts at 0",
+                          current_file_index);
+                    current_position_ms = 0;
+                }
+                resume_seek = false;
+            }
             transition_to(STATE_PLAYING);
-            Serial.printf("[PLAYBACK] Loaded file index %d\n", current_file_index);
+            LOG_I("[PLAYBACK] Loaded file index %d", current_file_index);
+            pump_audio();
         }
         return;
     }
     
     if (state == STATE_PLAYING) {
-        /* Simulate playback progress (in reality, decoder updates position) */
-        current_position_ms += 50;  /* ~50 ms per update call */
+        /* The play clock waits for the speaker: nothing is heard before it connects */
+        if (bt && !bt->is_connected()) {
+            last_tick_ms = millis();
+            return;
+        }
+        
+        advance_position();
+        save_resume_point(false);
         
         if (current_position_ms > total_duration_ms && total_duration_ms > 0) {
-            Serial.println("[PLAYBACK] Track ended, playing next");
-            pending_cmd = CMD_PLAY_NEXT;
+            LOG_I("[PLAYBACK] Track ended, playing next");
             transition_to(STATE_LOADING);
+            step_track(+1);
+            update_playback();  /* Open the next track now, not one loop later */
+            return;
         }
+        pump_audio();
     }
 }
 
@@ -137,11 +422,25 @@ bool PlaybackControllerImpl::init() {
     sd = create_sd_card();
     ui = create_ui();
     
+    extern LatencyMonitor* create_latency_monitor();
+    latency = create_latency_monitor();
+    
+    extern Equalizer* create_equalizer();
+    eq = create_equalizer();
+    if (eq) eq->init();
+    
+    extern ResumeJournal* create_resume_journal();
+    journal = create_resume_journal();
+    if (journal && journal->init()) {
+        resume_pending = journal->load(resume_point);
+    }
+    
     if (!decoder || !bt || !sd || !ui) {
         Serial.println("[PLAYBACK] ERROR: Could not get module references");
         return false;
     }
     
+    /* Track count (and the resume point) arrive with set_library() */
     transition_to(STATE_IDLE);
     return true;
 }
@@ -151,7 +450,30 @@ PlaybackState PlaybackControllerImpl::get_state() const {
 }
 
 void PlaybackControllerImpl::execute_command(PlaybackCommand cmd) {
+    /* Applied immediately; update() only picks up internally queued commands */
     pending_cmd = cmd;
+    handle_command();
+    update_playback();
+    
+    if (latency) {
+        latency->mark_action();
+    }
+}
+
+void PlaybackControllerImpl::skip(int32_t tracks) {
+    if (tracks == 0 || (state != STATE_PLAYING && state != STATE_PAUSED)) return;
+    
+    /* Coalesced presses: step the order N times, open only the last track */
+    transition_to(STATE_LOADING);
+    int direction = (tracks > 0) ? +1 : -1;
+    for (int32_t i = 0; i != tracks; i += direction) {
+        step_track(direction);
+    }
+    update_playback();
+    
+    if (latency) {
+        latency->mark_action();
+    }
 }
 
 void PlaybackControllerImpl::update() {
@@ -167,6 +489,114 @@ uint32_t PlaybackControllerImpl::get_total_duration_ms() const {
     return total_duration_ms;
 }
 
+void PlaybackControllerImpl::set_shuffle(bool enabled) {
+    if (enabled == shuffle_enabled) return;
+    
+    shuffle_enabled = enabled;
+    if (enabled) {
+        /* Continue the shuffled order from the track that is playing now */
+        order_pos = shuffle.position_of((uint32_t)current_file_index);
+    }
+    LOG_I("[PLAYBACK] Shuffle %s", enabled ? "ON" : "OFF");
+}
+
+bool PlaybackControllerImpl::is_shuffle_enabled() const {
+    return shuffle_enabled;
+}
+
+void PlaybackControllerImpl::set_track_count(uint32_t count) {
+    track_count = count;
+    order_pos = 0;
+    current_file_index = 0;
+    loaded_index = -1;
+    shuffle.reset(track_count, SHUFFLE_SEED);
+    LOG_I("[PLAYBACK] %u tracks available", (unsigned)track_count);
+    apply_resume_point();
+}
+
+void PlaybackControllerImpl::apply_resume_point() {
+    if (!resume_pending) return;
+    
+    /* Only resume into the same kind of track list the record came from */
+    bool from_playlist = (resume_point.flags & RESUME_FROM_PLAYLIST) != 0;
+    if (from_playlist != (playlist != nullptr) || resume_point.track_index >= track_count) {
+        return;
+    }
+    
+    current_file_index = (int)resume_point.track_index;
+    order_pos = shuffle_enabled ? shuffle.position_of(resume_point.track_index) : 0;
+    current_position_ms = resume_point.position_ms;
+    resume_pending = false;
+    resume_seek = true;
+    LOG_I("[PLAYBACK] Resume point: track %d @ %u ms",
+         current_file_index, (unsigned)current_position_ms);
+}
+
+/* Frame boundary at or before the play position, as a matching offset/time pair */
+void PlaybackControllerImpl::heard_point(uint32_t& byte_offset, uint32_t& position_ms) const {
+    position_ms = current_position_ms;
+    
+    /* Nothing open: a resume not yet applied keeps its offset, else track start */
+    if (!decoder || loaded_index < 0) {
+        byte_offset = resume_seek ? resume_point.byte_offset : 0;
+        return;
+    }
+    
+    /* Newest decoded frame that has started playing */
+    for (uint8_t i = marks_count; i > 0; i--) {
+        const FrameMark& mark = frame_marks[(marks_head + i - 1) % FRAME_MARKS];
+        if (mark.position_ms <= current_position_ms) {
+            byte_offset = mark.byte_offset;
+            position_ms = mark.position_ms;
+            return;
+        }
+    }
+    
+    /* Nothing decoded since the last flush: the decoder sits on the point */
+    byte_offset = decoder->get_byte_offset();
+    position_ms = decoder->get_current_position_ms();
+}
+
+void PlaybackControllerImpl::save_resume_point(bool force) {
+    if (!journal) return;
+    
+    ResumeRecord rec = {};
+    rec.track_index = (uint32_t)current_file_index;
+    heard_point(rec.byte_offset, rec.position_ms);
+    rec.flags = playlist ? RESUME_FROM_PLAYLIST : 0;
+    if (loaded_index >= 0) {
+        rec.file_size = loaded_size;
+        rec.path_hash = loaded_hash;
+    } else if (resume_seek) {
+        rec.file_size = resume_point.file_size;   /* Not applied yet: keep it whole */
+        rec.path_hash = resume_point.path_hash;
+    }
+    journal->record(rec);
+    
+    if (force) {
+        journal->commit();
+    } else {
+        journal->update();
+    }
+}
+
+void PlaybackControllerImpl::set_library(uint32_t count, bool from_playlist) {
+    extern Playlist* create_playlist();
+    playlist = from_playlist ? create_playlist() : nullptr;
+    
+    if (state == STATE_IDLE) {
+        set_track_count(count);
+        return;
+    }
+    
+    /* PLAY beat the scan: keep the track, the list applies from the next skip */
+    track_count = count;
+    shuffle.reset(track_count, SHUFFLE_SEED);
+    order_pos = shuffle_enabled ? shuffle.position_of((uint32_t)current_file_index) : 0;
+    resume_pending = false;
+    LOG_I("[PLAYBACK] %u tracks available", (unsigned)track_count);
+}
+
 /* Global singleton */
 static PlaybackControllerImpl g_playback;
 
@@ -0,0 +1,282 @@
+#include "playlist.h"
+#include "sd_card.h"
+#include "config.h"
+#include <Arduino.h>
+#include <SD.h>
+#include <cstring>
+
+/* ============================================================================
+ * M3U/M3U8 Playlist Implementation
+ * Lines are streamed through a small chunk buffer; only the file offset of
+ * every `stride`-th entry is kept. When the index fills up, every other slot
+ * is dropped and the stride doubles, so RAM stays fixed while any entry is
+ * reached by one seek plus at most (stride - 1) skipped lines.
+ *
+ * The playlist reads through the SD library itself, so open(), close() and
+ * get_entry() hold the card lock: the decoder may be streaming a track
+ * from another task at the same time.
+ * ========================================================================== */
+
+extern SDCard* create_sd_card();
+
+class M3UPlaylistImpl : public Playlist {
+private:
+    static const size_t CHUNK_SIZE = 64;
+    
+    File file;
+    bool opened = false;
+    uint32_t entry_count = 0;
+    
+    /* Folder of the playlist, used to resolve relative entries */
+    char base_dir[PLAYLIST_PATH_MAX] = "/";
+    
+    /* Sparse index: offsets of entries 0, stride, 2·stride, ... */
+    uint32_t index_offsets[PLAYLIST_INDEX_SLOTS];
+    uint16_t index_used = 0;
+    uint32_t stride = 1;
+    
+    /* Cursor: offset just past the last entry returned (sequential access) */
+    uint32_t cursor_entry = 0;
+    uint32_t cursor_offset = 0;
+    
+    /* Streaming state */
+    uint8_t chunk[CHUNK_SIZE];
+    size_t chunk_len = 0;
+    size_t chunk_pos = 0;
+    uint32_t chunk_base = 0;
+    char line[PLAYLIST_LINE_MAX];
+    
+    bool seek_to(uint32_t offset);
+    int next_byte();
+    bool next_entry(uint32_t& entry_offset);
+    void index_add(uint32_t entry, uint32_t offset);
+    void resolve(const char* entry, char* path, size_t path_len) const;
+
+public:
+    bool open(const char* path) override;
+    void close() override;
+    bool is_open() const override;
+    uint32_t get_count() const override;
+    bool get_entry(uint32_t index, char* path, size_t path_len) override;
+};
+
+bool M3UPlaylistImpl::seek_to(uint32_t offset) {
+    chunk_len = 0;
+    chunk_pos = 0;
+    chunk_base = offset;
+    return file.seek(offset);
+}
+
+int M3UPlaylistImpl::next_byte() {
+    if (chunk_pos >= chunk_len) {
+        chunk_base += chunk_len;
+        int n = file.read(chunk, CHUNK_SIZE);
+        if (n <= 0) {
+            chunk_len = 0;
+            chunk_pos = 0;
+            return -1;
+        }
+        chunk_len = (size_t)n;
+        chunk_pos = 0;
+    }
+    return chunk[chunk_pos++];
+}
+
+/* Read lines until the next track entry; leaves it trimmed in `line` */
+bool M3UPlaylistImpl::next_entry(uint32_t& entry_offset) {
+    while (true) {
+        uint32_t start = chunk_base + chunk_pos;
+        size_t len = 0;
+        bool overflow = false;
+        int c;
+        
+        while ((c = next_byte()) >= 0 && c != '\n') {
+            if (len < sizeof(line) - 1) {
+                line[len++] = (char)c;
+            } else {
+                overflow = true;
+            }
+        }
+        
+        if (c < 0 && len == 0) {
+            return false;  /* End of file */
+        }
+        
+        /* Trim CR and surrounding whitespace */
+        while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == ' ' || line[len - 1] == '\t')) {
+            len--;
+        }
+        line[len] = '\0';
+        
+        char* text = line;
+        if (start == 0 && (uint8_t)text[0] == 0xEF && (uint8_t)text[1] == 0xBB && (uint8_t)text[2] == 0xBF) {
+            text += 3;  /* UTF-8 BOM (M3U8) */
+        }
+        while (*text == ' ' || *text == '\t') text++;
+        
+        /* Skip blanks, #EXTM3U/#EXTINF directives and paths too long to open */
+        if (*text == '\0' || *text == '#' || overflow) {
+            if (c < 0) return false;
+            continue;
+        }
+        
+        if (text != line) {
+            memmove(line, text, strlen(text) + 1);
+        }
+        entry_offset = start;
+        return true;
+    }
+}
+
+void M3UPlaylistImpl::index_add(uint32_t entry, uint32_t offset) {
+    if (entry % stride != 0) return;
+    
+    if (index_used == PLAYLIST_INDEX_SLOTS) {
+        /* Full: keep even slots, double the stride */
+        for (uint16_t i = 0; i < PLAYLIST_INDEX_SLOTS / 2; i++) {
+            index_offsets[i] = index_offsets[i * 2];
+        }
+        index_used = PLAYLIST_INDEX_SLOTS / 2;
+        stride *= 2;
+        if (entry % stride != 0) return;
+    }
+    
+    index_offsets[index_used++] = offset;
+}
+
+void M3UPlaylistImpl::resolve(const char* entry, char* path, size_t path_len) const {
+    if (entry[0] == '.' && (entry[1] == '/' || entry[1] == '\\')) {
+        entry += 2;
+    }
+    
+    size_t n = 0;
+    if (entry[0] != '/' && entry[0] != '\\') {
+        /* Relative: prefix playlist folder (base_dir ends with '/') */
+        for (const char* p = base_dir; *p && n < path_len - 1; p++) {
+            path[n++] = *p;
+        }
+        
+        /* "../" climbs out of the playlist folder (FAT has no ".." in root) */
+        while (entry[0] == '.' && entry[1] == '.' && (entry[2] == '/' || entry[2] == '\\')) {
+            entry += 3;
+            if (n > 1) {
+                n--;
+                while (n > 1 && path[n - 1] != '/') n--;
+            }
+        }
+    }
+    
+    for (const char* p = entry; *p && n < path_len - 1; p++) {
+        path[n++] = (*p == '\\') ? '/' : *p;  /* Windows-style separators */
+    }
+    path[n] = '\0';
+}
+
+bool M3UPlaylistImpl::open(const char* path) {
+    if (!path) return false;
+    
+    SDCardLock hold(create_sd_card());
+    close();
+    file = SD.open(path, FILE_READ);
+    if (!file) {
+        Serial.printf("[PLS] Playlist not found: %s\n", path);
+        return false;
+    }
+    
+    /* Folder part of the path, including the trailing '/' */
+    const char* slash = strrchr(path, '/');
+    size_t dir_len = slash ? (size_t)(slash - path + 1) : 0;
+    if (dir_len == 0 || dir_len >= sizeof(base_dir)) {
+        strcpy(base_dir, "/");
+    } else {
+        memcpy(base_dir, path, dir_len);
+        base_dir[dir_len] = '\0';
+    }
+    
+    /* Single streaming pass: count entries and build the sparse index */
+    entry_count = 0;
+    index_used = 0;
+    stride = 1;
+    seek_to(0);
+    
+    uint32_t offset;
+    while (next_entry(offset)) {
+        index_add(entry_count, offset);
+        entry_count++;
+    }
+    
+    if (entry_count == 0) {
+        Serial.printf("[PLS] Playlist has no entries: %s\n", path);
+        close();
+        return false;
+    }
+    
+    cursor_entry = 0;
+    cursor_offset = index_offsets[0];
+    opened = true;
+    
+    Serial.printf("[PLS] Opened %s: %u entries (index stride %u)\n",
+                 path, (unsigned)entry_count, (unsigned)stride);
+    return true;
+}
+
+void M3UPlaylistImpl::close() {
+    SDCardLock hold(create_sd_card());
+    if (file) {
+        file.close();
+    }
+    opened = false;
+    entry_count = 0;
+    index_used = 0;
+    stride = 1;
+}
+
+bool M3UPlaylistImpl::is_open() const {
+    return opened;
+}
+
+uint32_t M3UPlaylistImpl::get_count() const {
+    return entry_count;
+}
+
+bool M3UPlaylistImpl::get_entry(uint32_t index, char* path, size_t path_len) {
+    if (!opened || !path || path_len == 0 || index >= entry_count) {
+        return false;
+    }
+    
+    /* Start from the cursor when it is closer than the nearest index slot */
+    uint32_t slot = index / stride;
+    uint32_t entry = slot * stride;
+    uint32_t offset = index_offsets[slot];
+    if (cursor_entry <= index && cursor_entry > entry) {
+        entry = cursor_entry;
+        offset = cursor_offset;
+    }
+    
+    SDCardLock hold(create_sd_card());
+    if (!seek_to(offset)) {
+        return false;
+    }
+    
+    uint32_t entry_offset;
+    while (true) {
+        if (!next_entry(entry_offset)) {
+            return false;
+        }
+        if (entry == index) break;
+        entry++;
+    }
+    
+    cursor_entry = index + 1;
+    cursor_offset = chunk_base + chunk_pos;
+    
+    resolve(line, path, path_len);
+    return true;
+}
+
+/* Global singleton */
+static M3UPlaylistImpl g_playlist;
+
+Playlist* create_playlist() {
+    return &g_playlist;
+}
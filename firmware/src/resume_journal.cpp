@@ -0,0 +1,145 @@
+#include "resume_journal.h"
+#include "config.h"
+#include "log.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <cstring>
+
+/* ============================================================================
+ * Resume Journal Implementation
+ * Round-robin over RESUME_SLOTS NVS blobs, each sealed with a sequence
+ * number and CRC32. A write torn by power loss fails its CRC and the
+ * previous slot stays the newest valid one. Boot reads the fixed number
+ * of slots once; no file or log scanning.
+ * ========================================================================== */
+
+#define LOG_MODULE LOG_MOD_PLAYBACK
+
+struct JournalEntry {
+    uint32_t sequence;
+    ResumeRecord record;
+    uint32_t crc;
+};
+
+class ResumeJournalImpl : public ResumeJournal {
+private:
+    Preferences prefs;
+    bool ready = false;
+    
+    JournalEntry newest = {};
+    bool have_newest = false;
+    uint8_t next_slot = 0;
+    
+    ResumeRecord pending = {};
+    bool dirty = false;
+    uint32_t last_commit_ms = 0;
+    
+    static uint32_t crc32(const uint8_t* data, size_t len);
+    static void slot_key(uint8_t slot, char* key);
+
+public:
+    bool init() override;
+    bool load(ResumeRecord& record) override;
+    void record(const ResumeRecord& record) override;
+    void update() override;
+    void commit() override;
+};
+
+uint32_t ResumeJournalImpl::crc32(const uint8_t* data, size_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+void ResumeJournalImpl::slot_key(uint8_t slot, char* key) {
+    key[0] = 'r';
+    key[1] = (char)('0' + slot);
+    key[2] = '\0';
+}
+
+bool ResumeJournalImpl::init() {
+    if (!prefs.begin(RESUME_NVS_NAMESPACE, false)) {
+        Serial.println("[RESUME] Failed to open NVS namespace");
+        return false;
+    }
+    
+    /* Newest valid slot wins; torn or blank slots are ignored */
+    for (uint8_t slot = 0; slot < RESUME_SLOTS; slot++) {
+        char key[4];
+        slot_key(slot, key);
+        
+        JournalEntry entry;
+        if (prefs.getBytes(key, &entry, sizeof(entry)) != sizeof(entry)) continue;
+        if (entry.crc != crc32((const uint8_t*)&entry, offsetof(JournalEntry, crc))) continue;
+        
+        if (!have_newest || entry.sequence > newest.sequence) {
+            newest = entry;
+            have_newest = true;
+            next_slot = (slot + 1) % RESUME_SLOTS;
+        }
+    }
+    
+    ready = true;
+    if (have_newest) {
+        pending = newest.record;
+        Serial.printf("[RESUME] Track %u @ %u ms (seq %u)\n",
+                     (unsigned)newest.record.track_index,
+                     (unsigned)newest.record.position_ms,
+                     (unsigned)newest.sequence);
+    }
+    last_commit_ms = millis();
+    return true;
+}
+
+bool ResumeJournalImpl::load(ResumeRecord& out) {
+    if (!have_newest) return false;
+    out = newest.record;
+    return true;
+}
+
+void ResumeJournalImpl::record(const ResumeRecord& rec) {
+    if (memcmp(&rec, &pending, sizeof(rec)) == 0) return;
+    pending = rec;
+    dirty = true;
+}
+
+void ResumeJournalImpl::update() {
+    if (dirty && (millis() - last_commit_ms) >= RESUME_SAVE_INTERVAL_MS) {
+        commit();
+    }
+}
+
+void ResumeJournalImpl::commit() {
+    if (!ready || !dirty) return;
+    
+    JournalEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.sequence = have_newest ? newest.sequence + 1 : 1;
+    entry.record = pending;
+    entry.crc = crc32((const uint8_t*)&entry, offsetof(JournalEntry, crc));
+    
+    char key[4];
+    slot_key(next_slot, key);
+    if (prefs.putBytes(key, &entry, sizeof(entry)) != sizeof(entry)) {
+        LOG_W("[RESUME] WARNING: Journal write failed");
+        return;
+    }
+    
+    newest = entry;
+    have_newest = true;
+    next_slot = (next_slot + 1) % RESUME_SLOTS;
+    dirty = false;
+    last_commit_ms = millis();
+}
+
+/* Global singleton */
+static ResumeJournalImpl g_resume_journal;
+
+ResumeJournal* create_resume_journal() {
+    return &g_resume_journal;
+}
@@ -3,27 +3,49 @@
 #include <SD.h>
 #include <SPI.h>
 #include <cstring>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 
 #include "config.h"
+#include "trace.h"
+#include "log.h"
+
+#define LOG_MODULE LOG_MOD_SD
 
 class SDCardImpl : public SDCard {
 private:
     bool mounted = false;
     File current_file;
+    SemaphoreHandle_t bus_lock = xSemaphoreCreateRecursiveMutex();
+    
+    /* Sparse index: directory positions of MP3 0, stride, 2·stride, ...
+     * (position = openNextFile() calls before that entry) */
+    uint32_t dir_positions[SD_DIR_INDEX_SLOTS];
+    uint16_t dir_used = 0;
+    uint32_t dir_stride = 1;
+    int indexed_files = -1;  /* MP3s the index covers, -1 = not built */
     
+    void index_add(int file, uint32_t position);
+
 public:
     bool init() override;
     bool is_mounted() const override;
     int list_files(const char** filenames, int max_count) override;
+    int count_files() override;
+    bool get_file_path(int index, char* path, size_t max_len) override;
     bool open_file(const char* filename) override;
+    bool seek(size_t offset) override;
     int read_data(uint8_t* buffer, size_t max_len) override;
     void close_file() override;
     size_t get_file_size() const override;
     void unmount() override;
     const char* get_error_message() const override;
+    void lock() const override;
+    void unlock() const override;
 };
 
 bool SDCardImpl::init() {
+    SDCardLock hold(this);
     // Initialize SPI with conservative clock speed
     SPI.begin(SPI_CLK_PIN, SPI_MISO_PIN, SPI_MOSI_PIN, SPI_CS_PIN);
     
@@ -34,6 +56,7 @@ bool SDCardImpl::init() {
     }
     
     mounted = true;
+    indexed_files = -1;
     Serial.println("[SD] SD card initialized successfully");
     return true;
 }
@@ -43,6 +66,7 @@ bool SDCardImpl::is_mounted() const {
 }
 
 int SDCardImpl::list_files(const char** filenames, int max_count) {
+    SDCardLock hold(this);
     if (!mounted) {
         Serial.println("[SD] Card not mounted");
         return 0;
@@ -81,7 +105,113 @@ int SDCardImpl::list_files(const char** filenames, int max_count) {
     return count;
 }
 
+static bool is_mp3(File& entry) {
+    if (entry.isDirectory()) {
+        return false;
+    }
+    const char* name = entry.name();
+    size_t len = strlen(name);
+    return len > 4 && strcasecmp(name + len - 4, ".mp3") == 0;
+}
+
+void SDCardImpl::index_add(int file, uint32_t position) {
+    if (file % dir_stride != 0) return;
+    
+    if (dir_used == SD_DIR_INDEX_SLOTS) {
+        /* Full: keep even slots, double the stride */
+        for (uint16_t i = 0; i < SD_DIR_INDEX_SLOTS / 2; i++) {
+            dir_positions[i] = dir_positions[i * 2];
+        }
+        dir_used = SD_DIR_INDEX_SLOTS / 2;
+        dir_stride *= 2;
+        if (file % dir_stride != 0) return;
+    }
+    
+    dir_positions[dir_used++] = position;
+}
+
+int SDCardImpl::count_files() {
+    SDCardLock hold(this);
+    indexed_files = -1;
+    if (!mounted) {
+        return 0;
+    }
+    
+    File root = SD.open("/");
+    if (!root) {
+        Serial.println("[SD] Failed to open root directory");
+        return 0;
+    }
+    
+    /* Single pass: count MP3s and build the sparse position index */
+    dir_used = 0;
+    dir_stride = 1;
+    int count = 0;
+    uint32_t position = 0;
+    while (true) {
+        File entry = root.openNextFile();
+        if (!entry) {
+            break;
+        }
+        
+        if (is_mp3(entry)) {
+            index_add(count, position);
+            count++;
+        }
+        entry.close();
+        position++;
+    }
+    
+    root.close();
+    indexed_files = count;
+    return count;
+}
+
+bool SDCardImpl::get_file_path(int index, char* path, size_t max_len) {
+    SDCardLock hold(this);
+    if (!mounted || index < 0 || max_len < 2) {
+        return false;
+    }
+    if (indexed_files < 0) {
+        count_files();
+    }
+    if (index >= indexed_files) {
+        return false;
+    }
+    
+    File root = SD.open("/");
+    if (!root) {
+        return false;
+    }
+    
+    /* Seek to the nearest indexed MP3, then walk at most (stride - 1) more */
+    uint32_t slot = (uint32_t)index / dir_stride;
+    int count = (int)(slot * dir_stride);
+    if (!root.seekDir(dir_positions[slot])) {
+        root.close();
+        return false;
+    }
+    
+    bool found = false;
+    while (!found) {
+        File entry = root.openNextFile();
+        if (!entry) {
+            break;
+        }
+        
+        if (is_mp3(entry) && count++ == index) {
+            snprintf(path, max_len, "/%s", entry.name());
+            found = true;
+        }
+        entry.close();
+    }
+    
+    root.close();
+    return found;
+}
+
 bool SDCardImpl::open_file(const char* filename) {
+    SDCardLock hold(this);
     if (!mounted) {
         Serial.println("[SD] Card not mounted");
         return false;
@@ -91,22 +221,34 @@ bool SDCardImpl::open_file(const char* filename) {
     current_file = SD.open(filename, FILE_READ);
     
     if (!current_file) {
-        Serial.printf("[SD] Failed to open file: %s\n", filename);
+        LOG_W("[SD] Failed to open file");
         return false;
     }
     
-    Serial.printf("[SD] Opened file: %s (size: %d bytes)\n", filename, current_file.size());
+    LOG_D("[SD] Opened file (%u bytes)", (unsigned)current_file.size());
     return true;
 }
 
+bool SDCardImpl::seek(size_t offset) {
+    SDCardLock hold(this);
+    if (!current_file) {
+        return false;
+    }
+    
+    return current_file.seek(offset);
+}
+
 int SDCardImpl::read_data(uint8_t* buffer, size_t max_len) {
+    TRACE_SCOPE(TRACE_SD_READ, max_len);
+    SDCardLock hold(this);
+    
     if (!current_file) {
         return -1;
     }
     
     int bytes_read = current_file.read(buffer, max_len);
     if (bytes_read < 0) {
-        Serial.println("[SD] Error reading file");
+        LOG_E("[SD] Error reading file");
         return -1;
     }
     
@@ -114,12 +256,14 @@ int SDCardImpl::read_data(uint8_t* buffer, size_t max_len) {
 }
 
 void SDCardImpl::close_file() {
+    SDCardLock hold(this);
     if (current_file) {
         current_file.close();
     }
 }
 
 size_t SDCardImpl::get_file_size() const {
+    SDCardLock hold(this);
     if (!current_file) {
         return 0;
     }
@@ -127,9 +271,11 @@ size_t SDCardImpl::get_file_size() const {
 }
 
 void SDCardImpl::unmount() {
+    SDCardLock hold(this);
     close_file();
     SD.end();
     mounted = false;
+    indexed_files = -1;
     Serial.println("[SD] SD card unmounted");
 }
 
@@ -137,6 +283,14 @@ const char* SDCardImpl::get_error_message() const {
     return "SD card error";
 }
 
+void SDCardImpl::lock() const {
+    xSemaphoreTakeRecursive(bus_lock, portMAX_DELAY);
+}
+
+void SDCardImpl::unlock() const {
+    xSemaphoreGiveRecursive(bus_lock);
+}
+
 // Global singleton
 static SDCardImpl g_sd_card;
 
@@ -0,0 +1,90 @@
+#include "shuffle.h"
+
+/* ============================================================================
+ * Shuffle Order Implementation
+ * 4-round balanced Feistel on 2·half_bits bits. The block is at most 4× the
+ * track count, so cycle-walking (re-encrypting until the value falls inside
+ * [0, count)) needs < 4 iterations on average.
+ * ========================================================================== */
+
+/* 32-bit integer finalizer (good avalanche, no tables) */
+static uint32_t mix32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7FEB352D;
+    x ^= x >> 15;
+    x *= 0x846CA68B;
+    x ^= x >> 16;
+    return x;
+}
+
+void ShuffleOrder::reset(uint32_t n, uint32_t s) {
+    count = n;
+    seed = s;
+    cycle = 0;
+    
+    /* Smallest even bit width whose domain covers [0, count) */
+    uint8_t bits = 0;
+    while (bits < 30 && (1UL << bits) < count) bits++;
+    if (bits < 2) bits = 2;
+    if (bits & 1) bits++;
+    
+    half_bits = bits / 2;
+    half_mask = (1UL << half_bits) - 1;
+    derive_keys();
+}
+
+void ShuffleOrder::set_cycle(uint32_t c) {
+    cycle = c;
+    derive_keys();
+}
+
+void ShuffleOrder::derive_keys() {
+    uint32_t k = mix32(seed ^ 0x9E3779B9) ^ mix32(cycle + 0x632BE5AB);
+    for (uint8_t r = 0; r < ROUNDS; r++) {
+        k = mix32(k + r + 1);
+        keys[r] = k;
+    }
+}
+
+uint32_t ShuffleOrder::round_fn(uint32_t half, uint8_t round) const {
+    return mix32(half ^ keys[round]) & half_mask;
+}
+
+uint32_t ShuffleOrder::encrypt(uint32_t x) const {
+    uint32_t left = (x >> half_bits) & half_mask;
+    uint32_t right = x & half_mask;
+    for (uint8_t r = 0; r < ROUNDS; r++) {
+        uint32_t next = left ^ round_fn(right, r);
+        left = right;
+        right = next;
+    }
+    return (left << half_bits) | right;
+}
+
+uint32_t ShuffleOrder::decrypt(uint32_t x) const {
+    uint32_t left = (x >> half_bits) & half_mask;
+    uint32_t right = x & half_mask;
+    for (uint8_t r = ROUNDS; r-- > 0;) {
+        uint32_t prev = right ^ round_fn(left, r);
+        right = left;
+        left = prev;
+    }
+    return (left << half_bits) | right;
+}
+
+uint32_t ShuffleOrder::track_at(uint32_t position) const {
+    if (count < 2 || position >= count) return position;
+    
+    /* Cycle-walk: the permutation restricted to [0, count) stays bijective */
+    uint32_t x = encrypt(position);
+    while (x >= count) x = encrypt(x);
+    return x;
+}
+
+uint32_t ShuffleOrder::position_of(uint32_t track) const {
+    if (count < 2 || track >= count) return track;
+    
+    uint32_t x = decrypt(track);
+    while (x >= count) x = decrypt(x);
+    return x;
+}
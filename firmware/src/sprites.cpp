@@ -0,0 +1,158 @@
+#include "sprites.h"
+
+/* ============================================================================
+ * Sprite Atlas Generator
+ * Source bitmaps are row strings: '#' = on, '.' = off, ' ' = transparent.
+ * Every atlas byte is computed by a constexpr function of its index, so
+ * the packed (image, mask) pairs land in .rodata with no startup work.
+ * Kept to C++11 constexpr (single-return recursion) for the default
+ * toolchain flags.
+ * ========================================================================== */
+
+struct SpriteSource {
+    const char* rows;
+    uint8_t width;
+    uint8_t height;
+};
+
+static constexpr char ICON_PLAY[] =
+    "##    "
+    "####  "
+    "######"
+    "######"
+    "####  "
+    "##    ";
+
+static constexpr char ICON_PAUSE[] =
+    "##..##"
+    "##..##"
+    "##..##"
+    "##..##"
+    "##..##"
+    "##..##";
+
+static constexpr char ICON_LOADING[] =
+    " #### "
+    "#....#"
+    "#....#"
+    "#....#"
+    "#....#"
+    " #### ";
+
+static constexpr char ICON_ERROR[] =
+    "#....#"
+    ".#..#."
+    "..##.."
+    "..##.."
+    ".#..#."
+    "#....#";
+
+static constexpr SpriteSource SOURCES[SPRITE_COUNT] = {
+    {ICON_PLAY,    6, 6},
+    {ICON_PAUSE,   6, 6},
+    {ICON_LOADING, 6, 6},
+    {ICON_ERROR,   6, 6},
+};
+
+/* --- Layout ---------------------------------------------------------------- */
+
+static constexpr uint16_t sprite_pages(uint8_t id) {
+    return (SOURCES[id].height + 7) / 8;
+}
+
+static constexpr uint16_t sprite_bytes(uint8_t id) {
+    return 2 * SOURCES[id].width * sprite_pages(id);
+}
+
+static constexpr uint16_t sprite_offset(uint8_t id) {
+    return id == 0 ? 0 : sprite_offset(id - 1) + sprite_bytes(id - 1);
+}
+
+static constexpr size_t ATLAS_BYTES = sprite_offset(SPRITE_COUNT);
+
+/* --- Validation -------------------------------------------------------------- */
+
+static constexpr size_t str_len(const char* s) {
+    return *s ? 1 + str_len(s + 1) : 0;
+}
+
+static constexpr bool chars_valid(const char* s) {
+    return *s == '\0' || ((*s == '#' || *s == '.' || *s == ' ') && chars_valid(s + 1));
+}
+
+static constexpr bool sources_valid(uint8_t id) {
+    return id == SPRITE_COUNT ||
+           (str_len(SOURCES[id].rows) == (size_t)SOURCES[id].width * SOURCES[id].height &&
+            chars_valid(SOURCES[id].rows) && sources_valid(id + 1));
+}
+
+static_assert(sources_valid(0), "Sprite source size must be width*height of '#', '.', ' '");
+
+/* --- Packing ----------------------------------------------------------------- */
+
+/* Sprite that owns atlas byte `index` */
+static constexpr uint8_t sprite_at(size_t index, uint8_t id) {
+    return (id + 1 == SPRITE_COUNT || index < sprite_offset(id + 1)) ? id : sprite_at(index, id + 1);
+}
+
+static constexpr bool pixel_bit(const SpriteSource& s, uint16_t x, uint16_t row, bool mask) {
+    return row < s.height &&
+           (mask ? s.rows[row * s.width + x] != ' ' : s.rows[row * s.width + x] == '#');
+}
+
+static constexpr uint8_t column_byte(const SpriteSource& s, uint16_t x, uint16_t page, bool mask, uint8_t bit) {
+    return bit == 8 ? 0 :
+           (uint8_t)((pixel_bit(s, x, page * 8 + bit, mask) ? (1u << bit) : 0u) |
+                     column_byte(s, x, page, mask, bit + 1));
+}
+
+/* Local layout: cell = page * width + x, then (image, mask) */
+static constexpr uint8_t sprite_byte(uint8_t id, size_t local) {
+    return column_byte(SOURCES[id], (local / 2) % SOURCES[id].width,
+                       (local / 2) / SOURCES[id].width, (local & 1) != 0, 0);
+}
+
+static constexpr uint8_t atlas_byte(size_t index) {
+    return sprite_byte(sprite_at(index, 0), index - sprite_offset(sprite_at(index, 0)));
+}
+
+/* --- Expansion (log-depth index list, C++11) ----------------------------------- */
+
+template <size_t... I> struct IndexList {};
+
+template <class A, class B> struct ConcatIndex;
+template <size_t... A, size_t... B>
+struct ConcatIndex<IndexList<A...>, IndexList<B...>> {
+    typedef IndexList<A..., (sizeof...(A) + B)...> type;
+};
+
+template <size_t N> struct MakeIndexList {
+    typedef typename ConcatIndex<typename MakeIndexList<N / 2>::type,
+                                 typename MakeIndexList<N - N / 2>::type>::type type;
+};
+template <> struct MakeIndexList<0> { typedef IndexList<> type; };
+template <> struct MakeIndexList<1> { typedef IndexList<0> type; };
+
+template <class L> struct AtlasTable;
+template <size_t... I> struct AtlasTable<IndexList<I...>> {
+    static constexpr uint8_t bytes[sizeof...(I)] = {atlas_byte(I)...};
+};
+template <size_t... I> constexpr uint8_t AtlasTable<IndexList<I...>>::bytes[sizeof...(I)];
+
+template <class L> struct SpriteTable;
+template <size_t... I> struct SpriteTable<IndexList<I...>> {
+    static constexpr Sprite sprites[sizeof...(I)] = {
+        {SOURCES[I].width, SOURCES[I].height, sprite_offset(I)}...
+    };
+};
+template <size_t... I> constexpr Sprite SpriteTable<IndexList<I...>>::sprites[sizeof...(I)];
+
+typedef AtlasTable<MakeIndexList<ATLAS_BYTES>::type> Atlas;
+typedef SpriteTable<MakeIndexList<SPRITE_COUNT>::type> Sprites;
+
+/* Spot-check the generator: play icon column 0 is fully on and opaque */
+static_assert(Atlas::bytes[0] == 0x3F && Atlas::bytes[1] == 0x3F, "Sprite packing broken");
+static_assert(Atlas::bytes[2 * 5] == 0x0C && Atlas::bytes[2 * 5 + 1] == 0x0C, "Sprite mask broken");
+
+const Sprite* const SPRITES = Sprites::sprites;
+const uint8_t* const SPRITE_ATLAS = Atlas::bytes;
@@ -0,0 +1,162 @@
+#include "trace.h"
+#include "config.h"
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <cstring>
+
+/* ============================================================================
+ * Trace Ring Implementation
+ * Each core owns a ring and a free-running head. A writer reserves its slot
+ * with one atomic add, so a task preempted by another task or an ISR on the
+ * same core never shares a slot, and the two cores never touch each other's
+ * cache lines. The cost per record is an inline CCOUNT read, the add and an
+ * 8-byte store, well under 100 cycles.
+ *
+ * The timestamp is read before the slot is reserved, so a record always
+ * carries the time its event happened. A writer preempted between the two
+ * steps can still land after a later record; slot order is therefore only
+ * nearly time order, and tools/trace_to_chrome.py sorts by timestamp.
+ *
+ * Dump format (little-endian):
+ *   "TRC1" | u16 record_size | u16 cores | u32 cpu_hz
+ *   per core: u32 count | count × TraceRecord, oldest first
+ *   "TEND"
+ * ========================================================================== */
+
+#if (TRACE_RING_RECORDS & (TRACE_RING_RECORDS - 1)) != 0
+    #error "TRACE_RING_RECORDS must be a power of 2"
+#endif
+
+#ifndef portNUM_PROCESSORS
+#define portNUM_PROCESSORS 1
+#endif
+
+#if FEATURE_TRACE
+
+static const uint8_t TRACE_MAGIC[4] = {'T', 'R', 'C', '1'};
+static const uint8_t TRACE_TRAILER[4] = {'T', 'E', 'N', 'D'};
+
+struct TraceRing {
+    uint32_t head;
+    TraceRecord records[TRACE_RING_RECORDS];
+};
+
+static DRAM_ATTR TraceRing trace_rings[portNUM_PROCESSORS];
+static volatile bool trace_frozen = false;
+
+static inline uint32_t trace_cycles() {
+#if defined(__XTENSA__)
+    uint32_t ccount;
+    __asm__ __volatile__("rsr %0, ccount" : "=a"(ccount));
+    return ccount;
+#else
+    return ESP.getCycleCount();
+#endif
+}
+
+void IRAM_ATTR trace_record(uint16_t id, uint16_t arg) {
+    if (trace_frozen) return;
+    
+    uint32_t cycles = trace_cycles();
+    TraceRing& ring = trace_rings[xPortGetCoreID()];
+    uint32_t slot = __atomic_fetch_add(&ring.head, 1, __ATOMIC_RELAXED);
+    TraceRecord& rec = ring.records[slot & (TRACE_RING_RECORDS - 1)];
+    rec.cycles = cycles;
+    rec.id = id;
+    rec.arg = arg;
+}
+
+#else
+
+void trace_record(uint16_t id, uint16_t arg) {
+}
+
+#endif  // FEATURE_TRACE
+
+class TracerImpl : public Tracer {
+public:
+    void freeze() override;
+    void resume() override;
+    bool is_frozen() const override;
+    void dump() override;
+};
+
+#if FEATURE_TRACE
+
+void TracerImpl::freeze() {
+    trace_frozen = true;
+}
+
+void TracerImpl::resume() {
+    trace_frozen = false;
+}
+
+bool TracerImpl::is_frozen() const {
+    return trace_frozen;
+}
+
+void TracerImpl::dump() {
+    /* Writers bail out on the flag; give one in flight time to land */
+    trace_frozen = true;
+    delayMicroseconds(10);
+    
+    uint16_t record_size = sizeof(TraceRecord);
+    uint16_t cores = portNUM_PROCESSORS;
+    uint32_t cpu_hz = getCpuFrequencyMhz() * 1000000UL;
+    
+    Serial.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    Serial.write((const uint8_t*)&record_size, sizeof(record_size));
+    Serial.write((const uint8_t*)&cores, sizeof(cores));
+    Serial.write((const uint8_t*)&cpu_hz, sizeof(cpu_hz));
+    
+    for (uint16_t core = 0; core < cores; core++) {
+        const TraceRing& ring = trace_rings[core];
+        uint32_t head = ring.head;
+        uint32_t count = (head < TRACE_RING_RECORDS) ? head : TRACE_RING_RECORDS;
+        uint32_t first = (head - count) & (TRACE_RING_RECORDS - 1);
+        
+        Serial.write((const uint8_t*)&count, sizeof(count));
+        
+        /* Oldest-first: the tail end of the array, then the wrapped start */
+        uint32_t run = TRACE_RING_RECORDS - first;
+        if (run > count) run = count;
+        Serial.write((const uint8_t*)&ring.records[first], run * sizeof(TraceRecord));
+        if (count > run) {
+            Serial.write((const uint8_t*)&ring.records[0], (count - run) * sizeof(TraceRecord));
+        }
+    }
+    
+    Serial.write(TRACE_TRAILER, sizeof(TRACE_TRAILER));
+    Serial.flush();
+    
+    /* Start a fresh window */
+    for (uint16_t core = 0; core < cores; core++) {
+        trace_rings[core].head = 0;
+    }
+    trace_frozen = false;
+}
+
+#else
+
+void TracerImpl::freeze() {
+}
+
+void TracerImpl::resume() {
+}
+
+bool TracerImpl::is_frozen() const {
+    return false;
+}
+
+void TracerImpl::dump() {
+    Serial.println("[TRACE] Tracing compiled out (FEATURE_TRACE = 0)");
+}
+
+#endif  // FEATURE_TRACE
+
+/* Global singleton */
+static TracerImpl g_tracer;
+
+Tracer* create_tracer() {
+    return &g_tracer;
+}
@@ -1,17 +1,46 @@
 #include "ui.h"
 #include "display_ssd1306.h"
 #include "config.h"
+#include "font5x7.h"
+#include "level_meter.h"
+#include "sprites.h"
 #include <Arduino.h>
+#include <cmath>
 #include <cstring>
 
 /* ============================================================================
  * Flipper-Style UI Implementation
  * Minimal monochrome layout: title, artist, progress, volume, state indicator
+ * Retained mode: each widget owns a bounding box and is repainted (box
+ * cleared, content drawn) only when its bound value changes.
+ * Titles wider than the title box are rendered once into a column strip
+ * and scrolled by blitting a moving window of it (marquee); only page 0
+ * of the title box changes per step.
+ * The level meter samples the audio tap's snapshot once per render and
+ * repaints only when a bar moves by a pixel.
  * ========================================================================== */
 
+enum WidgetId {
+    WIDGET_FRAME,      /* Dividers + footer hints (static) */
+    WIDGET_TITLE,
+    WIDGET_ARTIST,
+    WIDGET_PROGRESS,
+    WIDGET_VOLUME,
+    WIDGET_STATE,
+    WIDGET_METER,
+    WIDGET_TOAST,
+    WIDGET_ERROR,
+    WIDGET_COUNT
+};
+
+struct Widget {
+    uint8_t x, y, w, h;
+    bool dirty;
+};
+
 class UIImpl : public UI {
 private:
-    DisplaySSD1306* display;
+    DisplaySSD1306* display = nullptr;
     
     char current_title[64] = "No Track";
     char current_artist[64] = "";
@@ -20,6 +49,26 @@ private:
     uint32_t duration_ms = 0;
     uint8_t volume = 80;
     
+    /* Derived values widgets are bound to */
+    uint8_t progress_px = 0;
+    uint8_t volume_bars = 8;
+    
+    /* Level meter: L/R RMS bars with decaying peak ticks, plus band columns */
+    static const uint8_t METER_X = 0;
+    static const uint8_t METER_Y = 46;
+    static const uint8_t METER_BAR_PX = 80;
+    static const uint8_t METER_BAND_X = 88;
+    static const uint8_t METER_BAND_PX = 10;
+    static const uint8_t METER_FLOOR_DB = 48;        /* Bar spans -48..0 dBFS */
+    static const uint8_t METER_FALL_PX = 4;          /* Per render */
+    static const uint8_t METER_PEAK_HOLD_FRAMES = 8;
+    LevelMeter* meter = nullptr;
+    uint32_t meter_blocks = 0;
+    uint8_t meter_rms_px[2] = {0, 0};
+    uint8_t meter_peak_px[2] = {0, 0};
+    uint8_t meter_peak_hold[2] = {0, 0};
+    uint8_t meter_band_px[LEVEL_METER_BANDS] = {0, 0, 0};
+    
     char error_msg[64] = "";
     uint32_t error_time_ms = 0;
     static const uint32_t ERROR_DISPLAY_TIME = 3000;  /* 3 seconds */
@@ -28,12 +77,50 @@ private:
     uint32_t info_time_ms = 0;
     static const uint32_t INFO_DISPLAY_TIME = 2000;  /* 2 seconds */
     
-    void draw_header();
-    void draw_body();
-    void draw_footer();
+    /* Title strip (pre-rendered) and marquee state */
+    static const uint8_t TITLE_X = 2;
+    static const uint8_t TITLE_VISIBLE_PX = 116;
+    static const uint8_t MARQUEE_GAP_PX = 24;        /* Blank run between repeats */
+    static const uint8_t MARQUEE_STEP_PX = 2;        /* Per render (~20 px/s at 10 Hz) */
+    static const uint8_t MARQUEE_PAUSE_FRAMES = 15;  /* Hold at start of each pass */
+    uint8_t title_strip[63 * FONT5X7_ADVANCE + MARQUEE_GAP_PX];
+    uint16_t title_px = 0;        /* Rendered title width */
+    uint16_t strip_len = 0;       /* Marquee cycle length (0 → title fits) */
+    uint16_t marquee_offset = 0;
+    uint8_t marquee_pause = 0;
+    
+    Widget widgets[WIDGET_COUNT] = {
+        {0,   0,   DISPLAY_WIDTH, DISPLAY_HEIGHT, true},  /* FRAME */
+        {0,   0,   118, 8,  true},   /* TITLE (stops short of the state icon) */
+        {0,   20,  DISPLAY_WIDTH, 8,  true},  /* ARTIST */
+        {0,   40,  DISPLAY_WIDTH, 4,  true},  /* PROGRESS */
+        {110, 44,  18,  8,  true},   /* VOLUME */
+        {120, 2,   6,   6,  true},   /* STATE */
+        {0,   46,  104, 11, true},   /* METER */
+        {10,  2,   DISPLAY_WIDTH - 20, 12, false},  /* TOAST */
+        {0,   0,   DISPLAY_WIDTH, DISPLAY_HEIGHT, false},  /* ERROR */
+    };
+    
+    UIFrameStats stats = {};
+    
+    void invalidate(WidgetId id);
+    void invalidate_all();
+    bool overlaps(WidgetId a, WidgetId b) const;
+    void paint(WidgetId id);
+    void prepare_title();
+    void advance_marquee();
+    void sample_meter();
+    
+    void draw_frame();
+    void draw_title();
+    void draw_artist();
     void draw_progress_bar();
+    void draw_volume();
     void draw_state_indicator();
-    
+    void draw_meter();
+    void draw_toast();
+    void draw_error();
+
 public:
     bool init() override;
     void update_track_info(const char* title, const char* artist) override;
@@ -43,65 +130,215 @@ public:
     void render() override;
     void show_error(const char* message) override;
     void show_info(const char* message) override;
+    const UIFrameStats& get_frame_stats() const override;
 };
 
 bool UIImpl::init() {
     Serial.println("[UI] Initializing Flipper-style UI");
     
-    /* Get display instance */
+    /* Display is brought up by setup(), alongside SD and Bluetooth */
     extern DisplaySSD1306* create_display_ssd1306();
     display = create_display_ssd1306();
     
-    if (!display || !display->init()) {
-        Serial.println("[UI] FATAL: Could not initialize display");
+    if (!display) {
+        Serial.println("[UI] FATAL: No display instance");
         return false;
     }
     
-    /* Clear and show welcome screen */
-    display->clear();
-    display->draw_text(10, 28, "ESP32 MP3", 1);
-    display->update_full();
+    meter = create_level_meter();
+    
+    /* First render() paints the whole layout over the boot screen */
+    prepare_title();
+    invalidate_all();
     
     Serial.println("[UI] UI initialized");
     return true;
 }
 
+void UIImpl::invalidate(WidgetId id) {
+    widgets[id].dirty = true;
+}
+
+void UIImpl::invalidate_all() {
+    for (uint8_t i = 0; i < WIDGET_COUNT; i++) {
+        widgets[i].dirty = (i != WIDGET_TOAST && i != WIDGET_ERROR);
+    }
+}
+
+bool UIImpl::overlaps(WidgetId a, WidgetId b) const {
+    const Widget& wa = widgets[a];
+    const Widget& wb = widgets[b];
+    return wa.x < wb.x + wb.w && wb.x < wa.x + wa.w &&
+           wa.y < wb.y + wb.h && wb.y < wa.y + wa.h;
+}
+
 void UIImpl::update_track_info(const char* title, const char* artist) {
-    if (title) strncpy(current_title, title, sizeof(current_title) - 1);
-    if (artist) strncpy(current_artist, artist, sizeof(current_artist) - 1);
+    if (title && strncmp(title, current_title, sizeof(current_title) - 1) != 0) {
+        strncpy(current_title, title, sizeof(current_title) - 1);
+        prepare_title();
+        invalidate(WIDGET_TITLE);
+    }
+    if (artist && strncmp(artist, current_artist, sizeof(current_artist) - 1) != 0) {
+        strncpy(current_artist, artist, sizeof(current_artist) - 1);
+        invalidate(WIDGET_ARTIST);
+    }
+}
+
+void UIImpl::prepare_title() {
+    /* Render once; scrolling only moves the window over this strip */
+    title_px = font5x7_render(current_title, title_strip, sizeof(title_strip) - MARQUEE_GAP_PX);
+    
+    if (title_px > TITLE_VISIBLE_PX) {
+        memset(&title_strip[title_px], 0, MARQUEE_GAP_PX);
+        strip_len = title_px + MARQUEE_GAP_PX;
+    } else {
+        strip_len = 0;
+    }
+    marquee_offset = 0;
+    marquee_pause = MARQUEE_PAUSE_FRAMES;
+}
+
+void UIImpl::advance_marquee() {
+    if (strip_len == 0) return;
+    
+    if (marquee_pause > 0) {
+        marquee_pause--;
+        return;
+    }
+    
+    marquee_offset += MARQUEE_STEP_PX;
+    if (marquee_offset >= strip_len) {
+        /* Completed a pass: title back at its start position, hold briefly */
+        marquee_offset = 0;
+        marquee_pause = MARQUEE_PAUSE_FRAMES;
+    }
+    invalidate(WIDGET_TITLE);
+}
+
+/* Level (0–32767) → 0..span px on a dBFS scale */
+static uint8_t level_to_px(uint16_t level, uint8_t span, uint8_t floor_db) {
+    if (level == 0) return 0;
+    float db = 20.0f * log10f((float)level / 32767.0f);
+    if (db <= -(float)floor_db) return 0;
+    if (db >= 0.0f) return span;
+    return (uint8_t)((db + floor_db) * span / floor_db);
+}
+
+/* Bars jump up instantly and fall back at METER_FALL_PX per render */
+static uint8_t meter_ballistics(uint8_t shown, uint8_t target, uint8_t fall) {
+    if (target >= shown) return target;
+    return (shown - target > fall) ? shown - fall : target;
+}
+
+void UIImpl::sample_meter() {
+    if (!meter) return;
+    
+    LevelSnapshot snap;
+    meter->read(snap);
+    
+    /* No block since last render (paused, stalled): let the bars fall to zero */
+    bool fresh = snap.blocks != meter_blocks;
+    meter_blocks = snap.blocks;
+    
+    bool changed = false;
+    for (uint8_t ch = 0; ch < 2; ch++) {
+        uint8_t rms = fresh ? level_to_px(snap.rms[ch], METER_BAR_PX, METER_FLOOR_DB) : 0;
+        uint8_t peak = fresh ? level_to_px(snap.peak[ch], METER_BAR_PX, METER_FLOOR_DB) : 0;
+        
+        uint8_t r = meter_ballistics(meter_rms_px[ch], rms, METER_FALL_PX);
+        uint8_t p = meter_peak_px[ch];
+        if (peak >= p) {
+            p = peak;
+            meter_peak_hold[ch] = METER_PEAK_HOLD_FRAMES;
+        } else if (meter_peak_hold[ch] > 0) {
+            meter_peak_hold[ch]--;
+        } else {
+            p = meter_ballistics(p, peak, 1);
+        }
+        
+        if (r != meter_rms_px[ch] || p != meter_peak_px[ch]) changed = true;
+        meter_rms_px[ch] = r;
+        meter_peak_px[ch] = p;
+    }
+    for (uint8_t b = 0; b < LEVEL_METER_BANDS; b++) {
+        uint8_t target = fresh ? level_to_px(snap.band[b], METER_BAND_PX, METER_FLOOR_DB) : 0;
+        uint8_t px = meter_ballistics(meter_band_px[b], target, 1);
+        if (px != meter_band_px[b]) changed = true;
+        meter_band_px[b] = px;
+    }
+    
+    if (changed) {
+        invalidate(WIDGET_METER);
+    }
 }
 
 void UIImpl::update_playback_state(PlayerState s) {
+    if (s == state) return;
     state = s;
+    invalidate(WIDGET_STATE);
 }
 
 void UIImpl::update_progress(uint32_t curr_ms, uint32_t dur_ms) {
     progress_ms = curr_ms;
     duration_ms = dur_ms;
+    
+    /* Repaint only when the filled width actually changes */
+    uint8_t px = 0;
+    if (duration_ms > 0) {
+        uint32_t filled_width = (progress_ms * DISPLAY_WIDTH) / duration_ms;
+        px = (filled_width > DISPLAY_WIDTH) ? DISPLAY_WIDTH : (uint8_t)filled_width;
+    }
+    if (px != progress_px) {
+        progress_px = px;
+        invalidate(WIDGET_PROGRESS);
+    }
 }
 
 void UIImpl::update_volume(uint8_t vol) {
     volume = vol;
+    
+    /* Volume level (0–100) → 0–10 bars (0: muted, no bars) */
+    uint8_t bars = volume / 10;
+    if (bars != volume_bars) {
+        volume_bars = bars;
+        invalidate(WIDGET_VOLUME);
+    }
 }
 
 void UIImpl::draw_state_indicator() {
-    /* Draw state icon in top-right */
+    /* State icon in top-right (idle shows none) */
     uint8_t x = 120, y = 2;
-    uint8_t w = 6, h = 6;
     
     if (state == UI_STATE_PLAYING) {
-        /* Play symbol: right-pointing triangle */
-        display->draw_pixel(x + 1, y + 2, 1);
-        display->draw_pixel(x + 2, y + 1, 1);
-        display->draw_pixel(x + 2, y + 3, 1);
-        display->draw_pixel(x + 3, y + 2, 1);
+        display->draw_sprite(x, y, SPRITE_PLAY);
     } else if (state == UI_STATE_PAUSED) {
-        /* Pause symbol: two vertical bars */
-        display->draw_vline(x + 1, y + 1, 4, 1);
-        display->draw_vline(x + 3, y + 1, 4, 1);
+        display->draw_sprite(x, y, SPRITE_PAUSE);
     } else if (state == UI_STATE_LOADING) {
-        /* Loading symbol: circle outline */
-        display->draw_rect(x, y, 6, 6, 1);
+        display->draw_sprite(x, y, SPRITE_LOADING);
+    } else if (state == UI_STATE_ERROR) {
+        display->draw_sprite(x, y, SPRITE_ERROR);
+    }
+}
+
+void UIImpl::draw_meter() {
+    /* L/R: 3 px RMS bars at y=47 and y=51, peak as a 1 px tick */
+    for (uint8_t ch = 0; ch < 2; ch++) {
+        uint8_t y = METER_Y + 1 + ch * 4;
+        if (meter_rms_px[ch] > 0) {
+            display->draw_filled_rect(METER_X, y, meter_rms_px[ch], 3, 1);
+        }
+        if (meter_peak_px[ch] > 0) {
+            display->draw_vline(METER_X + meter_peak_px[ch] - 1, y, 3, 1);
+        }
+    }
+    
+    /* Bands: low/mid/high columns rising from the widget bottom */
+    uint8_t base = METER_Y + METER_BAND_PX;
+    for (uint8_t b = 0; b < LEVEL_METER_BANDS; b++) {
+        uint8_t h = meter_band_px[b];
+        if (h > 0) {
+            display->draw_filled_rect(METER_BAND_X + b * 5, base - h, 4, h, 1);
+        }
     }
 }
 
@@ -114,86 +351,153 @@ void UIImpl::draw_progress_bar() {
     display->draw_rect(0, y, DISPLAY_WIDTH, bar_height + 2, 1);
     
     /* Progress fill */
-    if (duration_ms > 0) {
-        uint32_t filled_width = (progress_ms * DISPLAY_WIDTH) / duration_ms;
-        if (filled_width > DISPLAY_WIDTH) filled_width = DISPLAY_WIDTH;
-        
-        if (filled_width > 0) {
-            display->draw_filled_rect(1, y + 1, filled_width - 1, bar_height, 1);
-        }
+    if (progress_px > 0) {
+        display->draw_filled_rect(1, y + 1, progress_px - 1, bar_height, 1);
     }
 }
 
-void UIImpl::draw_header() {
-    /* Title (top 8 pixels) */
-    display->draw_text(2, 0, current_title, 1);
-    
+void UIImpl::draw_frame() {
     /* Horizontal divider at y=10 */
     display->draw_hline(0, 10, DISPLAY_WIDTH, 1);
+    
+    /* Button hints at bottom */
+    display->draw_hline(0, 58, DISPLAY_WIDTH, 1);
+    
+    /* Left: <<  Middle: Play  Right: >> */
+    display->draw_text(2, 60, "<<", 1);
+    display->draw_text(60, 60, ">", 1);
+    display->draw_text(118, 60, ">>", 1);
+}
+
+void UIImpl::draw_title() {
+    /* Title (top 8 pixels), clipped to the widget box */
+    if (strip_len == 0) {
+        display->draw_columns(TITLE_X, 0, title_strip, (uint8_t)title_px, 1);
+        return;
+    }
+    
+    /* Marquee: window over the cyclic strip, wrapping to its start */
+    uint16_t first = strip_len - marquee_offset;
+    if (first > TITLE_VISIBLE_PX) first = TITLE_VISIBLE_PX;
+    display->draw_columns(TITLE_X, 0, &title_strip[marquee_offset], (uint8_t)first, 1);
+    if (first < TITLE_VISIBLE_PX) {
+        display->draw_columns(TITLE_X + first, 0, title_strip, (uint8_t)(TITLE_VISIBLE_PX - first), 1);
+    }
 }
 
-void UIImpl::draw_body() {
+void UIImpl::draw_artist() {
     /* Artist (middle section) */
     display->draw_text(2, 20, current_artist, 1);
-    
-    /* Progress bar */
-    draw_progress_bar();
-    
+}
+
+void UIImpl::draw_volume() {
     /* Volume on right side (y=45) */
     uint8_t vol_x = 110;
     display->draw_text(vol_x, 45, "V", 1);
     
-    /* Volume level (0–100) → 1–10 bars */
-    uint8_t bars = (volume / 10);
-    for (uint8_t i = 0; i < bars && i < 10; i++) {
+    for (uint8_t i = 0; i < volume_bars && i < 10; i++) {
         display->draw_vline(vol_x + 6 + i, 50 - (i / 2), 1 + (i / 2), 1);
     }
 }
 
-void UIImpl::draw_footer() {
-    /* Button hints at bottom */
-    display->draw_hline(0, 58, DISPLAY_WIDTH, 1);
+void UIImpl::draw_toast() {
+    /* Info toast over the header */
+    display->draw_filled_rect(10, 2, DISPLAY_WIDTH - 20, 12, 0);
+    display->draw_rect(10, 2, DISPLAY_WIDTH - 20, 12, 1);
+    display->draw_text(15, 4, info_msg, 0);
+}
+
+void UIImpl::draw_error() {
+    /* Error overlay */
+    display->draw_filled_rect(0, 20, DISPLAY_WIDTH, 24, 0);  /* Invert background */
+    display->draw_rect(0, 20, DISPLAY_WIDTH, 24, 1);
+    display->draw_text(5, 28, error_msg, 0);  /* White text on black */
+}
+
+void UIImpl::paint(WidgetId id) {
+    Widget& w = widgets[id];
     
-    /* Left: <<  Middle: Play  Right: >> */
-    display->draw_text(2, 60, "<<", 1);
-    display->draw_text(60, 60, ">", 1);
-    display->draw_text(118, 60, ">>", 1);
+    /* Clear the box, then draw the widget's content */
+    display->draw_filled_rect(w.x, w.y, w.w, w.h, 0);
     
-    /* State indicator in top-right */
-    draw_state_indicator();
+    switch (id) {
+        case WIDGET_FRAME:    draw_frame(); break;
+        case WIDGET_TITLE:    draw_title(); break;
+        case WIDGET_ARTIST:   draw_artist(); break;
+        case WIDGET_PROGRESS: draw_progress_bar(); break;
+        case WIDGET_VOLUME:   draw_volume(); break;
+        case WIDGET_STATE:    draw_state_indicator(); break;
+        case WIDGET_METER:    draw_meter(); break;
+        case WIDGET_TOAST:    draw_toast(); break;
+        case WIDGET_ERROR:    draw_error(); break;
+        default: break;
+    }
+    
+    w.dirty = false;
+    stats.widgets_drawn++;
+    stats.pixels_touched += w.w * w.h;
 }
 
 void UIImpl::render() {
+    if (!display) return;
+    
+    uint32_t start_us = micros();
+    stats.widgets_drawn = 0;
+    stats.pixels_touched = 0;
+    
     /* Check if error or info messages are active */
     uint32_t now = millis();
     
     if (error_msg[0] && (now - error_time_ms) < ERROR_DISPLAY_TIME) {
-        /* Show error overlay */
-        display->clear();
-        display->draw_filled_rect(0, 20, DISPLAY_WIDTH, 24, 0);  /* Invert background */
-        display->draw_rect(0, 20, DISPLAY_WIDTH, 24, 1);
-        display->draw_text(5, 28, error_msg, 0);  /* White text on black */
-        display->update_full();
+        /* Error overlay hides everything else until it expires */
+        if (widgets[WIDGET_ERROR].dirty) {
+            paint(WIDGET_ERROR);
+            display->update();
+        }
+        stats.render_us = micros() - start_us;
         return;
     } else if (error_msg[0]) {
         error_msg[0] = '\0';
+        invalidate_all();
     }
     
-    if (info_msg[0] && (now - info_time_ms) < INFO_DISPLAY_TIME) {
-        /* Show info toast */
-        display->draw_filled_rect(10, 2, DISPLAY_WIDTH - 20, 12, 0);
-        display->draw_rect(10, 2, DISPLAY_WIDTH - 20, 12, 1);
-        display->draw_text(15, 4, info_msg, 0);
-    } else if (info_msg[0]) {
+    advance_marquee();
+    sample_meter();
+    
+    bool toast_active = info_msg[0] && (now - info_time_ms) < INFO_DISPLAY_TIME;
+    if (!toast_active && info_msg[0]) {
+        /* Toast expired: repaint whatever it covered */
         info_msg[0] = '\0';
+        for (uint8_t i = 0; i < WIDGET_COUNT; i++) {
+            if (i != WIDGET_TOAST && overlaps((WidgetId)i, WIDGET_TOAST)) {
+                invalidate((WidgetId)i);
+            }
+        }
+    }
+    
+    /* Frame covers the whole screen: repainting it repaints everything */
+    if (widgets[WIDGET_FRAME].dirty) {
+        invalidate_all();
+        if (toast_active) invalidate(WIDGET_TOAST);
+    }
+    
+    for (uint8_t i = 0; i < WIDGET_COUNT; i++) {
+        WidgetId id = (WidgetId)i;
+        if (!widgets[i].dirty || id == WIDGET_TOAST || id == WIDGET_ERROR) continue;
+        
+        /* Widgets under an active toast stay dirty until it expires */
+        if (toast_active && id != WIDGET_FRAME && overlaps(id, WIDGET_TOAST)) continue;
+        paint(id);
+    }
+    
+    if (toast_active && widgets[WIDGET_TOAST].dirty) {
+        paint(WIDGET_TOAST);
     }
     
-    /* Normal rendering */
-    display->clear();
-    draw_header();
-    draw_body();
-    draw_footer();
-    display->update();  /* Partial update */
+    if (stats.widgets_drawn > 0) {
+        display->update();  /* Partial update */
+    }
+    stats.render_us = micros() - start_us;
 }
 
 void UIImpl::show_error(const char* message) {
@@ -201,6 +505,7 @@ void UIImpl::show_error(const char* message) {
         strncpy(error_msg, message, sizeof(error_msg) - 1);
         error_msg[sizeof(error_msg) - 1] = '\0';
         error_time_ms = millis();
+        invalidate(WIDGET_ERROR);
     }
 }
 
@@ -209,9 +514,14 @@ void UIImpl::show_info(const char* message) {
         strncpy(info_msg, message, sizeof(info_msg) - 1);
         info_msg[sizeof(info_msg) - 1] = '\0';
         info_time_ms = millis();
+        invalidate(WIDGET_TOAST);
     }
 }
 
+const UIFrameStats& UIImpl::get_frame_stats() const {
+    return stats;
+}
+
 /* Global singleton */
 static UIImpl g_ui;
 
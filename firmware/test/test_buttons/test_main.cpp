@@ -0,0 +1,283 @@
+/* ============================================================================
+ * Button Debounce Tests
+ * Replays contact-bounce traces through the GPIO fake into the button ISRs
+ * and checks the gestures the button task posts: one gesture per physical
+ * press whatever the bounce, nothing for a lone glitch, SHORT at the
+ * leading edge of the release (not after the burst settles), DOUBLE on
+ * PLAY, and LONG/REPEAT/HOLD_END. Latency runs from the deciding edge;
+ * PLAY's double-press wait is counted apart.
+ * ========================================================================== */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <cstdio>
+#include <vector>
+#include "button_handler.h"
+#include "event_queue.h"
+#include "latency_monitor.h"
+#include "config.h"
+#include "native_host.h"
+
+extern ButtonHandler* create_button_handler();
+extern EventQueue* create_event_queue();
+
+static ButtonHandler* buttons;
+static EventQueue* events;
+
+/* One edge of a trace: wait `after_us`, then drive the pin to `level` */
+struct Edge {
+    uint32_t after_us;
+    uint8_t level;
+};
+#define EDGES(trace) (sizeof(trace) / sizeof((trace)[0]))
+
+/* Typical tactile switch: a few hundred µs of chatter, well inside BTN_DEBOUNCE_MS */
+static const Edge PRESS_BOUNCE[] = {
+    {0, LOW}, {300, HIGH}, {250, LOW}, {400, HIGH}, {150, LOW}, {600, HIGH}, {200, LOW},
+};
+static const Edge RELEASE_BOUNCE[] = {
+    {0, HIGH}, {200, LOW}, {350, HIGH}, {300, LOW}, {500, HIGH},
+};
+
+/* EMI spike on an idle line: low for 5 µs, never a press */
+static const Edge GLITCH[] = {
+    {0, LOW}, {5, HIGH},
+};
+
+struct Posted {
+    EventType type;
+    uint32_t gesture;
+    uint64_t at_us;
+};
+
+static void replay(uint8_t pin, const Edge* trace, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (trace[i].after_us) native_sleep_us(trace[i].after_us);
+        native_gpio_set(pin, trace[i].level);
+    }
+}
+
+static void press(uint8_t pin) {
+    replay(pin, PRESS_BOUNCE, EDGES(PRESS_BOUNCE));
+}
+
+static void release(uint8_t pin) {
+    replay(pin, RELEASE_BOUNCE, EDGES(RELEASE_BOUNCE));
+}
+
+/* Everything posted until the bus has been quiet for `quiet_ms` */
+static std::vector<Posted> collect(uint32_t quiet_ms) {
+    std::vector<Posted> out;
+    Event event;
+    while (events->wait_and_receive(event, quiet_ms)) {
+        Posted p = {event.type, event.param, native_time_us()};
+        out.push_back(p);
+    }
+    return out;
+}
+
+void setUp() {
+    collect(10);   /* Nothing from the previous test leaks in */
+}
+
+void tearDown() {}
+
+static void test_bouncy_short_press_is_one_short() {
+    uint32_t edges_before = buttons->get_stats().edges;
+    
+    press(BTN_NEXT_PIN);
+    native_sleep_us(120000);
+    uint64_t release_us = native_time_us();
+    release(BTN_NEXT_PIN);
+    
+    std::vector<Posted> got = collect(100);
+    TEST_ASSERT_EQUAL_UINT32(1, got.size());
+    TEST_ASSERT_EQUAL(EVENT_BUTTON_NEXT, got[0].type);
+    TEST_ASSERT_EQUAL_UINT32(GESTURE_SHORT, got[0].gesture);
+    
+    /* Leading edge: posted on the first release edge, not after the chatter */
+    char line[64];
+    snprintf(line, sizeof(line), "release -> SHORT %u us",
+             (unsigned)(got[0].at_us - release_us));
+    TEST_MESSAGE(line);
+    TEST_ASSERT_TRUE_MESSAGE(got[0].at_us - release_us < BTN_DEBOUNCE_MS * 1000UL / 2, line);
+    
+    /* Every bounce reached the ISR; none was lost */
+    const ButtonStats& stats = buttons->get_stats();
+    TEST_ASSERT_EQUAL_UINT32(EDGES(PRESS_BOUNCE) + EDGES(RELEASE_BOUNCE), stats.edges - edges_before);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.edges_dropped);
+}
+
+static void test_repeated_presses_count_once_each() {
+    for (int i = 0; i < 5; i++) {
+        press(BTN_PREV_PIN);
+        native_sleep_us(60000);
+        release(BTN_PREV_PIN);
+        native_sleep_us(60000);
+    }
+    
+    std::vector<Posted> got = collect(100);
+    TEST_ASSERT_EQUAL_UINT32(5, got.size());
+    for (const Posted& p : got) {
+        TEST_ASSERT_EQUAL(EVENT_BUTTON_PREV, p.type);
+        TEST_ASSERT_EQUAL_UINT32(GESTURE_SHORT, p.gesture);
+    }
+}
+
+static void test_play_short_waits_for_double_window() {
+    press(BTN_PLAY_PIN);
+    native_sleep_us(80000);
+    uint64_t release_us = native_time_us();
+    release(BTN_PLAY_PIN);
+    
+    std::vector<Posted> got = collect(BTN_DOUBLE_PRESS_MS + 100);
+    TEST_ASSERT_EQUAL_UINT32(1, got.size());
+    TEST_ASSERT_EQUAL(EVENT_BUTTON_PLAY, got[0].type);
+    TEST_ASSERT_EQUAL_UINT32(GESTURE_SHORT, got[0].gesture);
+    TEST_ASSERT_TRUE(got[0].at_us - release_us >= BTN_DOUBLE_PRESS_MS * 1000UL);
+}
+
+static void test_bouncy_double_press_is_one_double() {
+    press(BTN_PLAY_PIN);
+    native_sleep_us(70000);
+    release(BTN_PLAY_PIN);
+    native_sleep_us(120000);   /* Inside BTN_DOUBLE_PRESS_MS */
+    press(BTN_PLAY_PIN);
+    native_sleep_us(70000);
+    release(BTN_PLAY_PIN);
+    
+    std::vector<Posted> got = collect(BTN_DOUBLE_PRESS_MS + 100);
+    TEST_ASSERT_EQUAL_UINT32(1, got.size());
+    TEST_ASSERT_EQUAL(EVENT_BUTTON_PLAY, got[0].type);
+    TEST_ASSERT_EQUAL_UINT32(GESTURE_DOUBLE, got[0].gesture);
+}
+
+static void test_hold_gives_long_repeats_and_end() {
+    press(BTN_NEXT_PIN);
+    native_sleep_us(1000000);
+    release(BTN_NEXT_PIN);
+    
+    std::vector<Posted> got = collect(100);
+    TEST_ASSERT_TRUE(got.size() >= 2);
+    TEST_ASSERT_EQUAL_UINT32(GESTURE_LONG, got.front().gesture);
+    TEST_ASSERT_EQUAL_UINT32(GESTURE_HOLD_END, got.back().gesture);
+    
+    /* LONG at 600 ms, then one REPEAT every 150 ms: 750 and 900 ms */
+    uint32_t repeats = 0;
+    for (size_t i = 1; i + 1 < got.size(); i++) {
+        TEST_ASSERT_EQUAL_UINT32(GESTURE_REPEAT, got[i].gesture);
+        repeats++;
+    }
+    TEST_ASSERT_UINT32_WITHIN(1, (1000 - BTN_LONG_PRESS_MS) / BTN_REPEAT_MS, repeats);
+    for (const Posted& p : got) {
+        TEST_ASSERT_EQUAL(EVENT_BUTTON_NEXT, p.type);
+    }
+}
+
+static void test_buttons_do_not_interfere() {
+    /* PREV and NEXT chatter at the same time, released in the other order */
+    press(BTN_PREV_PIN);
+    press(BTN_NEXT_PIN);
+    native_sleep_us(80000);
+    release(BTN_NEXT_PIN);
+    native_sleep_us(30000);
+    release(BTN_PREV_PIN);
+    
+    std::vector<Posted> got = collect(100);
+    TEST_ASSERT_EQUAL_UINT32(2, got.size());
+    TEST_ASSERT_EQUAL(EVENT_BUTTON_NEXT, got[0].type);
+    TEST_ASSERT_EQUAL(EVENT_BUTTON_PREV, got[1].type);
+    TEST_ASSERT_EQUAL_UINT32(GESTURE_SHORT, got[0].gesture);
+    TEST_ASSERT_EQUAL_UINT32(GESTURE_SHORT, got[1].gesture);
+}
+
+static void test_idle_glitch_is_not_a_press() {
+    uint32_t gestures = buttons->get_stats().gestures;
+    replay(BTN_NEXT_PIN, GLITCH, EDGES(GLITCH));
+    native_sleep_us(30000);
+    replay(BTN_NEXT_PIN, GLITCH, EDGES(GLITCH));
+    
+    TEST_ASSERT_EQUAL_UINT32(0, collect(100).size());
+    TEST_ASSERT_EQUAL_UINT32(gestures, buttons->get_stats().gestures);
+    
+    /* The line is still usable afterwards */
+    press(BTN_NEXT_PIN);
+    native_sleep_us(60000);
+    release(BTN_NEXT_PIN);
+    std::vector<Posted> got = collect(100);
+    TEST_ASSERT_EQUAL_UINT32(1, got.size());
+    TEST_ASSERT_EQUAL_UINT32(GESTURE_SHORT, got[0].gesture);
+}
+
+static void test_glitch_in_double_window_is_not_a_double() {
+    press(BTN_PLAY_PIN);
+    native_sleep_us(60000);
+    release(BTN_PLAY_PIN);
+    native_sleep_us(100000);
+    replay(BTN_PLAY_PIN, GLITCH, EDGES(GLITCH));
+    
+    std::vector<Posted> got = collect(BTN_DOUBLE_PRESS_MS + 100);
+    TEST_ASSERT_EQUAL_UINT32(1, got.size());
+    TEST_ASSERT_EQUAL_UINT32(GESTURE_SHORT, got[0].gesture);
+}
+
+/* Latency as the player sees it: the action follows the event at once */
+static void act_on_next_event(LatencyMonitor* latency, uint32_t timeout_ms) {
+    Event event;
+    TEST_ASSERT_TRUE(events->wait_and_receive(event, timeout_ms));
+    latency->mark_action();
+}
+
+static void test_latency_from_deciding_edge() {
+    LatencyMonitor* latency = create_latency_monitor();
+    LatencyPercentiles p;
+    latency->get_percentiles(p);
+    uint32_t waits = p.waits;   /* Earlier PLAY taps were never acted on */
+    
+    /* NEXT: the 100 ms hold is not latency, the release decides. Clean
+     * release edges: replaying the chatter would delay the action here */
+    press(BTN_NEXT_PIN);
+    native_sleep_us(100000);
+    native_gpio_set(BTN_NEXT_PIN, HIGH);
+    act_on_next_event(latency, 50);
+    latency->get_percentiles(p);
+    TEST_ASSERT_EQUAL_UINT32(1, p.count);
+    TEST_ASSERT_EQUAL_UINT32(waits, p.waits);
+    
+    /* PLAY: the double-press wait is reported on its own */
+    press(BTN_PLAY_PIN);
+    native_sleep_us(80000);
+    native_gpio_set(BTN_PLAY_PIN, HIGH);
+    act_on_next_event(latency, BTN_DOUBLE_PRESS_MS + 50);
+    latency->get_percentiles(p);
+    TEST_ASSERT_EQUAL_UINT32(2, p.count);
+    TEST_ASSERT_EQUAL_UINT32(waits + 1, p.waits);
+    TEST_ASSERT_TRUE(p.wait_max_us >= BTN_DOUBLE_PRESS_MS * 1000UL);
+    
+    char line[96];
+    snprintf(line, sizeof(line), "edge -> action p50 < %u us, max %u us; double wait %u us",
+             (unsigned)p.p50_us, (unsigned)p.max_us, (unsigned)p.wait_max_us);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_TRUE_MESSAGE(p.max_us < 2000, line);
+    TEST_ASSERT_TRUE_MESSAGE(p.p50_us <= 1000, line);   /* Sub-ms buckets resolve it */
+}
+
+void setup() {
+    events = create_event_queue();
+    buttons = create_button_handler();
+    if (!buttons->init()) native_exit(1);
+    
+    UNITY_BEGIN();
+    RUN_TEST(test_bouncy_short_press_is_one_short);
+    RUN_TEST(test_repeated_presses_count_once_each);
+    RUN_TEST(test_play_short_waits_for_double_window);
+    RUN_TEST(test_bouncy_double_press_is_one_double);
+    RUN_TEST(test_hold_gives_long_repeats_and_end);
+    RUN_TEST(test_buttons_do_not_interfere);
+    RUN_TEST(test_idle_glitch_is_not_a_press);
+    RUN_TEST(test_glitch_in_double_window_is_not_a_double);
+    RUN_TEST(test_latency_from_deciding_edge);
+    native_exit(UNITY_END());
+}
+
+void loop() {}
@@ -0,0 +1,549 @@
+/* ============================================================================
+ * SSD1306 Driver Tests
+ * Drawing is checked against per-pixel reference renderers and against the
+ * panel fake's GDDRAM after a flush, so what reaches the glass is tested,
+ * not just the framebuffer. Bus traffic is counted both by the driver's
+ * flush stats and by the Wire fake. The display is not init()'ed until the
+ * last test: without the flush task, update() flushes in the caller and the
+ * tests are synchronous. The last one compares that with the task.
+ * ========================================================================== */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <Wire.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include "display_ssd1306.h"
+#include "font5x7.h"
+#include "sprites.h"
+#include "config.h"
+#include "native_host.h"
+
+extern DisplaySSD1306* create_display_ssd1306();
+
+static DisplaySSD1306* display;
+
+/* Per-pixel model of the panel, framebuffer layout */
+static uint8_t model[FRAMEBUFFER_SIZE];
+
+static void model_pixel(int x, int y, uint8_t color) {
+    if (x < 0 || y < 0 || x >= DISPLAY_WIDTH || y >= DISPLAY_HEIGHT) return;
+    uint8_t bit = 1 << (y % 8);
+    if (color) {
+        model[(y / 8) * DISPLAY_WIDTH + x] |= bit;
+    } else {
+        model[(y / 8) * DISPLAY_WIDTH + x] &= ~bit;
+    }
+}
+
+/* Reference text renderer: every set font bit is one pixel */
+static void model_text(int x, int y, const char* text, uint8_t color) {
+    for (size_t i = 0; text[i]; i++) {
+        uint8_t c = (uint8_t)text[i];
+        if (c < FONT5X7_FIRST || c > FONT5X7_LAST) c = '?';
+        for (int col = 0; col < FONT5X7_WIDTH; col++) {
+            for (int row = 0; row < 8; row++) {
+                if ((FONT5X7[c - FONT5X7_FIRST][col] >> row) & 1) {
+                    model_pixel(x + (int)i * FONT5X7_ADVANCE + col, y + row, color);
+                }
+            }
+        }
+    }
+}
+
+static void model_rect(int x, int y, int w, int h, uint8_t color) {
+    for (int j = y; j < y + h; j++) {
+        for (int i = x; i < x + w; i++) model_pixel(i, j, color);
+    }
+}
+
+/* Flush (synchronous, see banner) and compare the panel with the model */
+static void assert_panel_matches(const char* what) {
+    display->update();
+    uint8_t gddram[FRAMEBUFFER_SIZE];
+    native_panel_read(gddram);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(model, gddram, FRAMEBUFFER_SIZE, what);
+}
+
+static void reset_all() {
+    display->clear();
+    memset(model, 0, sizeof(model));
+}
+
+void setUp() {
+    reset_all();
+}
+
+void tearDown() {}
+
+/* ----- Font blitter (draw_text) ----- */
+
+/* "Hi! 42" at (0, 0): first 36 columns of page 0, locked as the golden */
+static const uint8_t GOLDEN_HI42[36] = {
+    0x7F, 0x08, 0x08, 0x08, 0x7F, 0x00, 0x00, 0x44, 0x7D, 0x40, 0x00, 0x00,
+    0x00, 0x00, 0x5F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x18, 0x14, 0x12, 0x7F, 0x10, 0x00, 0x42, 0x61, 0x51, 0x49, 0x46, 0x00,
+};
+
+static void test_text_golden_image() {
+    display->draw_text(0, 0, "Hi! 42", 1);
+    display->update();
+    
+    uint8_t gddram[FRAMEBUFFER_SIZE];
+    native_panel_read(gddram);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(GOLDEN_HI42, gddram, sizeof(GOLDEN_HI42));
+    for (size_t i = sizeof(GOLDEN_HI42); i < FRAMEBUFFER_SIZE; i++) {
+        TEST_ASSERT_EQUAL_UINT8(0, gddram[i]);
+    }
+}
+
+static void test_text_matches_per_pixel_reference() {
+    static const char* const samples[] = {
+        "The quick brown fox", "0123456789:;<=>?@", "~{|}`_^]\\[", "\x01\x7F\xFF"
+    };
+    char what[64];
+    
+    /* Every row offset inside a page, clipped at the right and bottom edges */
+    for (int y = 0; y < DISPLAY_HEIGHT; y += 3) {
+        for (const char* text : samples) {
+            reset_all();
+            display->draw_text(y % 11, y, text, 1);
+            model_text(y % 11, y, text, 1);
+            snprintf(what, sizeof(what), "y=%d \"%s\"", y, text);
+            assert_panel_matches(what);
+        }
+    }
+    
+    /* Color 0 clears only the glyph pixels */
+    reset_all();
+    display->draw_filled_rect(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, 1);
+    memset(model, 0xFF, sizeof(model));
+    display->draw_text(5, 13, "Erase me", 0);
+    model_text(5, 13, "Erase me", 0);
+    assert_panel_matches("color 0");
+}
+
+static void test_text_blit_faster_than_per_pixel() {
+    const char* text = "Now Playing: Track 12";
+    const uint32_t runs = 20000;
+    size_t chars = strlen(text);
+    
+    uint64_t start = native_time_us();
+    for (uint32_t r = 0; r < runs; r++) {
+        display->draw_text(1, 27, text, r & 1);
+    }
+    double blit_ns = (native_time_us() - start) * 1000.0 / (runs * chars);
+    
+    /* Baseline: the same glyphs as draw_pixel() calls */
+    start = native_time_us();
+    for (uint32_t r = 0; r < runs; r++) {
+        for (size_t i = 0; i < chars; i++) {
+            const uint8_t* glyph = FONT5X7[(uint8_t)text[i] - FONT5X7_FIRST];
+            for (uint8_t col = 0; col < FONT5X7_WIDTH; col++) {
+                for (uint8_t row = 0; row < FONT5X7_HEIGHT; row++) {
+                    if ((glyph[col] >> row) & 1) {
+                        display->draw_pixel(1 + i * FONT5X7_ADVANCE + col, 27 + row, r & 1);
+                    }
+                }
+            }
+        }
+    }
+    double pixel_ns = (native_time_us() - start) * 1000.0 / (runs * chars);
+    
+    char line[96];
+    snprintf(line, sizeof(line), "draw_text %.1f ns/char, per-pixel %.1f ns/char (%.1fx)",
+             blit_ns, pixel_ns, pixel_ns / blit_ns);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_TRUE_MESSAGE(blit_ns < pixel_ns, line);
+}
+
+/* ----- Windowed bursts (flush_window) ----- */
+
+/* Bus traffic of one update(), from the driver and from the Wire fake */
+struct Flush {
+    DisplayFlushStats driver;
+    NativeI2CStats wire;
+};
+
+static Flush measure_update() {
+    NativeI2CStats before = native_i2c_stats();
+    display->update();
+    Flush f;
+    f.driver = display->get_flush_stats();
+    f.wire = native_i2c_stats();
+    f.wire.transmissions -= before.transmissions;
+    f.wire.bytes -= before.bytes;
+    return f;
+}
+
+static void test_full_flush_fills_wire_buffer() {
+    display->draw_filled_rect(3, 5, 100, 40, 1);
+    model_rect(3, 5, 100, 40, 1);
+    
+    display->update_full();
+    NativeI2CStats before = native_i2c_stats();
+    display->update_full();
+    DisplayFlushStats s = display->get_flush_stats();
+    NativeI2CStats after = native_i2c_stats();
+    
+    /* One window command + 1024 bytes in Wire-buffer-sized bursts */
+    const uint32_t data_bursts = (FRAMEBUFFER_SIZE + I2C_BUFFER_LENGTH - 2) / (I2C_BUFFER_LENGTH - 1);
+    TEST_ASSERT_EQUAL_UINT32(1, s.windows);
+    TEST_ASSERT_EQUAL_UINT32(1 + data_bursts, s.transactions);
+    TEST_ASSERT_EQUAL_UINT32(8 + FRAMEBUFFER_SIZE + 2 * data_bursts, s.i2c_bytes);
+    TEST_ASSERT_EQUAL_UINT32(s.transactions, after.transmissions - before.transmissions);
+    TEST_ASSERT_EQUAL_UINT32(s.i2c_bytes, after.bytes - before.bytes);
+    TEST_ASSERT_EQUAL_UINT32(I2C_BUFFER_LENGTH, after.largest);
+    
+    char line[96];
+    snprintf(line, sizeof(line), "full frame: %u transactions, %u bytes",
+             (unsigned)s.transactions, (unsigned)s.i2c_bytes);
+    TEST_MESSAGE(line);
+    assert_panel_matches("full flush");
+}
+
+static void test_stacked_spans_share_one_window() {
+    display->update_full();
+    
+    /* Same columns on three pages: one window, one data burst */
+    display->draw_filled_rect(40, 8, 20, 24, 1);
+    model_rect(40, 8, 20, 24, 1);
+    Flush f = measure_update();
+    TEST_ASSERT_EQUAL_UINT32(1, f.driver.windows);
+    TEST_ASSERT_EQUAL_UINT32(2, f.driver.transactions);
+    TEST_ASSERT_EQUAL_UINT32(8 + 2 + 60, f.driver.i2c_bytes);
+    TEST_ASSERT_EQUAL_UINT32(f.driver.transactions, f.wire.transmissions);
+    TEST_ASSERT_EQUAL_UINT32(f.driver.i2c_bytes, f.wire.bytes);
+    assert_panel_matches("stacked spans");
+}
+
+static void test_window_merge_gap() {
+    display->update_full();
+    
+    /* 9 unchanged columns cost less to resend than a second window (10) */
+    display->draw_vline(20, 0, 8, 1);
+    display->draw_vline(30, 0, 8, 1);
+    model_rect(20, 0, 1, 8, 1);
+    model_rect(30, 0, 1, 8, 1);
+    Flush near = measure_update();
+    TEST_ASSERT_EQUAL_UINT32(1, near.driver.windows);
+    TEST_ASSERT_EQUAL_UINT32(8 + 2 + 11, near.driver.i2c_bytes);
+    assert_panel_matches("merged");
+    
+    /* Wider gap: two windows */
+    display->draw_vline(60, 0, 8, 1);
+    display->draw_vline(90, 0, 8, 1);
+    model_rect(60, 0, 1, 8, 1);
+    model_rect(90, 0, 1, 8, 1);
+    Flush far = measure_update();
+    TEST_ASSERT_EQUAL_UINT32(2, far.driver.windows);
+    TEST_ASSERT_EQUAL_UINT32(4, far.driver.transactions);
+    TEST_ASSERT_EQUAL_UINT32(2 * (8 + 2 + 1), far.driver.i2c_bytes);
+    TEST_ASSERT_EQUAL_UINT32(far.driver.i2c_bytes, far.wire.bytes);
+    assert_panel_matches("split");
+}
+
+static void test_narrow_window_gathers_pages() {
+    display->update_full();
+    
+    /* 50 columns × 8 pages = 400 bytes: page slices packed into full bursts */
+    display->draw_filled_rect(10, 0, 50, DISPLAY_HEIGHT, 1);
+    model_rect(10, 0, 50, DISPLAY_HEIGHT, 1);
+    Flush f = measure_update();
+    const uint32_t bursts = (400 + I2C_BUFFER_LENGTH - 2) / (I2C_BUFFER_LENGTH - 1);
+    TEST_ASSERT_EQUAL_UINT32(1, f.driver.windows);
+    TEST_ASSERT_EQUAL_UINT32(1 + bursts, f.driver.transactions);
+    TEST_ASSERT_EQUAL_UINT32(8 + 400 + 2 * bursts, f.wire.bytes);
+    assert_panel_matches("narrow window");
+}
+
+/* ----- Shadow diff (flush_diff) ----- */
+
+static void test_unchanged_frame_sends_nothing() {
+    display->draw_text(0, 0, "Shadow", 1);
+    model_text(0, 0, "Shadow", 1);
+    display->update_full();
+    
+    /* Nothing drawn */
+    Flush idle = measure_update();
+    TEST_ASSERT_EQUAL_UINT32(0, idle.wire.transmissions);
+    TEST_ASSERT_EQUAL_UINT32(0, idle.driver.i2c_bytes);
+    
+    /* Dirty blocks whose bytes end up as they were */
+    display->draw_text(0, 0, "Shadow", 1);
+    display->draw_pixel(100, 50, 1);
+    display->draw_pixel(100, 50, 0);
+    Flush redrawn = measure_update();
+    TEST_ASSERT_EQUAL_UINT32(0, redrawn.wire.transmissions);
+    TEST_ASSERT_EQUAL_UINT32(0, redrawn.driver.windows);
+    assert_panel_matches("redrawn");
+}
+
+static void test_single_pixel_sends_one_byte() {
+    display->update_full();
+    
+    display->draw_pixel(77, 42, 1);
+    model_pixel(77, 42, 1);
+    Flush f = measure_update();
+    TEST_ASSERT_EQUAL_UINT32(1, f.driver.windows);
+    TEST_ASSERT_EQUAL_UINT32(8 + 2 + 1, f.wire.bytes);
+    assert_panel_matches("single pixel");
+}
+
+static void test_clock_tick_sends_changed_columns_only() {
+    /* Elapsed-time text, one second later: only the last digit differs */
+    display->draw_text(40, 28, "01:23", 1);
+    display->update_full();
+    
+    display->draw_filled_rect(40, 28, 5 * FONT5X7_ADVANCE, 8, 0);
+    display->draw_text(40, 28, "01:24", 1);
+    model_text(40, 28, "01:24", 1);
+    Flush f = measure_update();
+    
+    /* The text straddles pages 3-4 and touches 4 block columns on each */
+    const uint32_t dirty_block_bytes = 2 * 4 * 8;
+    char line[96];
+    snprintf(line, sizeof(line), "clock tick: %u bytes on the wire, %u data bytes in dirty blocks",
+             (unsigned)f.wire.bytes, (unsigned)dirty_block_bytes);
+    TEST_MESSAGE(line);
+    
+    /* '3' → '4' differs in at most 5 columns on each of the 2 pages */
+    TEST_ASSERT_LESS_OR_EQUAL(2 * (8 + 2 + 5), f.wire.bytes);
+    TEST_ASSERT_LESS_THAN(dirty_block_bytes, f.wire.bytes);
+    assert_panel_matches("clock tick");
+}
+
+/* ----- Span fills (fill_span) ----- */
+
+static uint32_t rng_state = 12345;
+static uint8_t rng(uint8_t range) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (uint8_t)((rng_state >> 16) % range);
+}
+
+static void test_spans_match_per_pixel_reference() {
+    char what[80];
+    
+    for (int round = 0; round < 400; round++) {
+        /* Sizes may run off the right/bottom edges; x + w stays below 256 */
+        uint8_t x = rng(DISPLAY_WIDTH), y = rng(DISPLAY_HEIGHT);
+        uint8_t w = 1 + rng(DISPLAY_WIDTH), h = 1 + rng(DISPLAY_HEIGHT + 8);
+        uint8_t color = rng(2);
+        uint8_t shape = rng(4);
+        
+        switch (shape) {
+            case 0:
+                display->draw_filled_rect(x, y, w, h, color);
+                model_rect(x, y, w, h, color);
+                break;
+            case 1:
+                display->draw_hline(x, y, w, color);
+                model_rect(x, y, w, 1, color);
+                break;
+            case 2:
+                display->draw_vline(x, y, h, color);
+                model_rect(x, y, 1, h, color);
+                break;
+            default:
+                display->draw_rect(x, y, w, h, color);
+                model_rect(x, y, w, 1, color);
+                model_rect(x, y + h - 1, w, 1, color);
+                model_rect(x, y, 1, h, color);
+                model_rect(x + w - 1, y, 1, h, color);
+                break;
+        }
+        
+        /* Compare every few shapes so overlaps and both colors mix */
+        if (round % 8 == 7) {
+            snprintf(what, sizeof(what), "round %d: shape %u at (%u,%u) %ux%u color %u",
+                     round, (unsigned)shape, (unsigned)x, (unsigned)y, (unsigned)w,
+                     (unsigned)h, (unsigned)color);
+            assert_panel_matches(what);
+        }
+    }
+}
+
+static void test_span_fill_faster_than_per_pixel() {
+    const uint32_t runs = 20000;
+    char line[128];
+    
+    /* Unaligned rectangle: partial first/last pages, full pages between */
+    uint64_t start = native_time_us();
+    for (uint32_t r = 0; r < runs; r++) {
+        display->draw_filled_rect(10, 5, 100, 50, r & 1);
+    }
+    double span_ns = (native_time_us() - start) * 1000.0 / runs;
+    
+    start = native_time_us();
+    for (uint32_t r = 0; r < runs; r++) {
+        for (uint8_t y = 5; y < 55; y++) {
+            for (uint8_t x = 10; x < 110; x++) display->draw_pixel(x, y, r & 1);
+        }
+    }
+    double pixel_ns = (native_time_us() - start) * 1000.0 / runs;
+    
+    snprintf(line, sizeof(line), "100x50 rect: fill_span %.0f ns, per-pixel %.0f ns (%.0fx)",
+             span_ns, pixel_ns, pixel_ns / span_ns);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_TRUE_MESSAGE(span_ns * 4 < pixel_ns, line);
+    
+    /* Horizontal line: one masked byte per column either way */
+    start = native_time_us();
+    for (uint32_t r = 0; r < runs; r++) {
+        display->draw_hline(0, 37, DISPLAY_WIDTH, r & 1);
+    }
+    span_ns = (native_time_us() - start) * 1000.0 / runs;
+    
+    start = native_time_us();
+    for (uint32_t r = 0; r < runs; r++) {
+        for (uint8_t x = 0; x < DISPLAY_WIDTH; x++) display->draw_pixel(x, 37, r & 1);
+    }
+    pixel_ns = (native_time_us() - start) * 1000.0 / runs;
+    
+    snprintf(line, sizeof(line), "128 px hline: fill_span %.0f ns, per-pixel %.0f ns (%.0fx)",
+             span_ns, pixel_ns, pixel_ns / span_ns);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_TRUE_MESSAGE(span_ns < pixel_ns, line);
+}
+
+/* ----- Sprites (draw_sprite) ----- */
+
+/* Source art: '#' on, '.' off, ' ' transparent */
+static const char* const SPRITE_ROWS[] = {
+    "##    " "####  " "######" "######" "####  " "##    ",   /* PLAY */
+    "##..##" "##..##" "##..##" "##..##" "##..##" "##..##",   /* PAUSE */
+    " #### " "#....#" "#....#" "#....#" "#....#" " #### ",   /* LOADING */
+};
+
+static void model_sprite_rows(int x, int y, const char* rows, int w, int h) {
+    for (int j = 0; j < h; j++) {
+        for (int i = 0; i < w; i++) {
+            char c = rows[j * w + i];
+            if (c != ' ') model_pixel(x + i, y + j, c == '#');
+        }
+    }
+}
+
+static void test_sprites_match_source_art() {
+    char what[48];
+    for (uint8_t id = SPRITE_PLAY; id <= SPRITE_LOADING; id++) {
+        const Sprite& sprite = SPRITES[id];
+        TEST_ASSERT_EQUAL_UINT8(6, sprite.width);
+        TEST_ASSERT_EQUAL_UINT8(6, sprite.height);
+        
+        /* Over a checkerboard, at every row offset in a page and off the edges */
+        for (int y = 0; y < DISPLAY_HEIGHT; y += 5) {
+            reset_all();
+            for (uint8_t cx = 0; cx < DISPLAY_WIDTH; cx += 2) {
+                display->draw_vline(cx, 0, DISPLAY_HEIGHT, 1);
+                model_rect(cx, 0, 1, DISPLAY_HEIGHT, 1);
+            }
+            int x = (y * 7) % DISPLAY_WIDTH;
+            display->draw_sprite(x, y, id);
+            display->draw_sprite(DISPLAY_WIDTH - 3, y, id);
+            model_sprite_rows(x, y, SPRITE_ROWS[id], sprite.width, sprite.height);
+            model_sprite_rows(DISPLAY_WIDTH - 3, y, SPRITE_ROWS[id], sprite.width, sprite.height);
+            snprintf(what, sizeof(what), "sprite %u at y=%d", (unsigned)id, y);
+            assert_panel_matches(what);
+        }
+    }
+}
+
+static void test_sprite_matches_atlas_decode() {
+    /* Every sprite, including ones without source art here, against its atlas bytes */
+    for (uint8_t id = 0; id < SPRITE_COUNT; id++) {
+        const Sprite& sprite = SPRITES[id];
+        const uint8_t* data = SPRITE_ATLAS + sprite.offset;
+        for (int y = 0; y < 8; y++) {
+            reset_all();
+            display->draw_filled_rect(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT / 2, 1);
+            model_rect(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT / 2, 1);
+            display->draw_sprite(30, 28 + y, id);
+            for (int j = 0; j < sprite.height; j++) {
+                for (int i = 0; i < sprite.width; i++) {
+                    const uint8_t* pair = &data[(j / 8) * sprite.width * 2 + i * 2];
+                    if ((pair[1] >> (j % 8)) & 1) {
+                        model_pixel(30 + i, 28 + y + j, (pair[0] >> (j % 8)) & 1);
+                    }
+                }
+            }
+            assert_panel_matches("atlas decode");
+        }
+    }
+    
+    /* Unknown id draws nothing */
+    reset_all();
+    display->draw_sprite(10, 10, SPRITE_COUNT);
+    assert_panel_matches("unknown id");
+}
+
+/* ----- Display task (runs last: init() starts it for good) ----- */
+
+static void test_task_frees_the_caller() {
+    /* Before: no task, the caller waits out the bus */
+    display->draw_filled_rect(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, 1);
+    display->update_full();
+    uint32_t sync_us = display->get_flush_stats().caller_block_us;
+    
+    /* After: the task flushes, the caller only snapshots and swaps */
+    TEST_ASSERT_TRUE(display->init());
+    display->update_full();
+    delay(200);   /* init sequence + full frame, then let the task finish */
+    
+    display->draw_filled_rect(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, 0);
+    display->update_full();
+    uint32_t task_us = display->get_flush_stats().caller_block_us;
+    delay(200);
+    DisplayFlushStats s = display->get_flush_stats();
+    
+    char line[128];
+    snprintf(line, sizeof(line), "full frame: caller blocked %u us synchronous, %u us with the task "
+             "(bus %u us)", (unsigned)sync_us, (unsigned)task_us, (unsigned)s.bus_time_us);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_LESS_THAN(sync_us / 10, task_us);
+    TEST_ASSERT_GREATER_OR_EQUAL(sync_us / 2, s.bus_time_us);
+    
+    memset(model, 0, sizeof(model));
+    uint8_t gddram[FRAMEBUFFER_SIZE];
+    native_panel_read(gddram);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(model, gddram, FRAMEBUFFER_SIZE);
+}
+
+void setup() {
+    /* Scratch working directory: the panel fake drops display.pbm there */
+    char dir[] = "/tmp/test_display_XXXXXX";
+    if (!mkdtemp(dir) || chdir(dir) != 0) {
+        printf("cannot create the scratch directory\n");
+        native_exit(1);
+    }
+    
+    Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN, I2C_FREQ * 1000);
+    display = create_display_ssd1306();
+    
+    UNITY_BEGIN();
+    RUN_TEST(test_text_golden_image);
+    RUN_TEST(test_text_matches_per_pixel_reference);
+    RUN_TEST(test_text_blit_faster_than_per_pixel);
+    RUN_TEST(test_full_flush_fills_wire_buffer);
+    RUN_TEST(test_stacked_spans_share_one_window);
+    RUN_TEST(test_window_merge_gap);
+    RUN_TEST(test_narrow_window_gathers_pages);
+    RUN_TEST(test_unchanged_frame_sends_nothing);
+    RUN_TEST(test_single_pixel_sends_one_byte);
+    RUN_TEST(test_clock_tick_sends_changed_columns_only);
+    RUN_TEST(test_spans_match_per_pixel_reference);
+    RUN_TEST(test_span_fill_faster_than_per_pixel);
+    RUN_TEST(test_sprites_match_source_art);
+    RUN_TEST(test_sprite_matches_atlas_decode);
+    RUN_TEST(test_task_frees_the_caller);
+    int status = UNITY_END();
+    
+    std::string cleanup = std::string("rm -rf ") + dir;
+    (void)system(cleanup.c_str());
+    native_exit(status);
+}
+
+void loop() {}
@@ -0,0 +1,224 @@
+/* ============================================================================
+ * Equalizer Tests
+ * The quantised cascade must hit the cookbook designs where they are exact
+ * (peaking centre, shelf midpoint, DC, Nyquist) at every supported rate,
+ * every preset measured through process() with sines must match its
+ * response plus preamp, and preset and bypass changes must glide: the
+ * largest sample-to-sample step during a change stays near the steady
+ * state on either side (a click shows up as a step well above both).
+ * Changes land on a crest of the test tone, where a gain change that
+ * snaps instead of gliding jumps the furthest.
+ * ========================================================================== */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "equalizer.h"
+#include "config.h"
+#include "native_host.h"
+
+static const float RESPONSE_TOL_DB = 0.05f;
+static const float SINE_TOL_DB = 0.2f;
+static const float SINE_AMPLITUDE = 4000;
+static const uint32_t SETTLE_MS = 300;        /* Glide plus filter transients */
+static const uint32_t MEASURE_FRAMES = 16384; /* Rounded to whole periods */
+static const float GLIDE_AMPLITUDE = 8000;
+static const float GLIDE_FREQ = 1000;
+static const uint32_t GLIDE_WINDOW_MS = 100;
+static const float GLIDE_RATIO = 1.5f;        /* Allowed step over the steady-state step */
+
+static const uint32_t FRAME_FRAMES = AUDIO_PCM_FRAME_SAMPLES / AUDIO_CHANNELS;
+
+static Equalizer* eq;
+static int16_t work[AUDIO_PCM_FRAME_SAMPLES];
+
+/* Sine on the left, inverted on the right (channels must stay independent) */
+struct Sine {
+    float freq;
+    float amplitude;
+    uint32_t n;
+    
+    void fill(int16_t* pcm, uint32_t frames) {
+        for (uint32_t i = 0; i < frames; i++, n++) {
+            int16_t s = (int16_t)lrintf(amplitude * sinf(2.0f * (float)M_PI * freq * (n % AUDIO_SAMPLE_RATE) / AUDIO_SAMPLE_RATE));
+            pcm[i * AUDIO_CHANNELS] = s;
+            pcm[i * AUDIO_CHANNELS + 1] = (int16_t)-s;
+        }
+    }
+};
+
+/* Run `frames` of the sine through process() in sink-sized chunks */
+static void run_frames(Sine& sine, uint32_t frames, double* in_sq, double* out_sq, int32_t* max_step) {
+    static int16_t prev[AUDIO_CHANNELS];
+    while (frames > 0) {
+        uint32_t n = frames < FRAME_FRAMES ? frames : FRAME_FRAMES;
+        sine.fill(work, n);
+        for (uint32_t i = 0; in_sq && i < n * AUDIO_CHANNELS; i++) {
+            *in_sq += (double)work[i] * work[i];
+        }
+        eq->process(work, n * AUDIO_CHANNELS);
+        for (uint32_t i = 0; i < n * AUDIO_CHANNELS; i++) {
+            if (out_sq) *out_sq += (double)work[i] * work[i];
+            if (max_step) {
+                int32_t step = abs((int32_t)work[i] - prev[i % AUDIO_CHANNELS]);
+                if (step > *max_step) *max_step = step;
+            }
+            prev[i % AUDIO_CHANNELS] = work[i];
+        }
+        frames -= n;
+    }
+}
+
+static uint32_t ms_to_frames(uint32_t ms) {
+    return AUDIO_SAMPLE_RATE * ms / 1000;
+}
+
+/* Largest step over one window of the sine, nothing changing */
+static int32_t steady_step(Sine& sine) {
+    int32_t step = 0;
+    run_frames(sine, ms_to_frames(GLIDE_WINDOW_MS), nullptr, nullptr, &step);
+    return step;
+}
+
+/* Apply `change`, then compare the step during its window with the steady
+ * state before and after */
+static void check_glide(Sine& sine, const char* what, void (*change)()) {
+    int32_t before = steady_step(sine);
+    
+    /* Change at a crest, where an instant gain change jumps the most */
+    uint32_t period = (uint32_t)lrintf(AUDIO_SAMPLE_RATE / sine.freq);
+    uint32_t to_crest = (period / 4 + period - sine.n % period) % period;
+    run_frames(sine, to_crest, nullptr, nullptr, nullptr);
+    change();
+    int32_t during = 0;
+    run_frames(sine, ms_to_frames(GLIDE_WINDOW_MS), nullptr, nullptr, &during);
+    int32_t after = steady_step(sine);
+    
+    int32_t steady = before > after ? before : after;
+    char line[96];
+    snprintf(line, sizeof(line), "%s: step %d, steady %d before / %d after",
+             what, (int)during, (int)before, (int)after);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_TRUE_MESSAGE(during <= GLIDE_RATIO * steady, line);
+}
+
+static void check_point(const char* what, uint32_t rate, float freq, float expected) {
+    float db = eq->get_response_db(freq);
+    char line[96];
+    snprintf(line, sizeof(line), "%s at %u Hz, %.0f Hz: %.4f dB, expected %.2f",
+             what, (unsigned)rate, freq, db, expected);
+    TEST_ASSERT_TRUE_MESSAGE(fabsf(db - expected) <= RESPONSE_TOL_DB, line);
+}
+
+static uint8_t boost_preset() {
+    return 2 % eq->get_preset_count();
+}
+
+static void select_flat() { eq->select_preset(0); }
+static void select_boost() { eq->select_preset(boost_preset()); }
+static void bypass_on() { eq->set_enabled(false); }
+static void bypass_off() { eq->set_enabled(true); }
+
+void setUp() {
+    eq->set_sample_rate(AUDIO_SAMPLE_RATE);
+    eq->set_enabled(true);
+    eq->select_preset(0);
+}
+
+void tearDown() {}
+
+static void test_response_at_exact_points() {
+    static const uint32_t rates[] = {44100, 48000, 22050};
+    static const int16_t gains[] = {60, -90};
+    
+    for (uint8_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        uint32_t rate = rates[r];
+        eq->set_sample_rate(rate);
+        for (uint8_t g = 0; g < sizeof(gains) / sizeof(gains[0]); g++) {
+            float gain = gains[g] / 10.0f;
+            float nyquist = rate / 2.0f;
+            EqBand band;
+            
+            /* Peaking: full gain at the centre, none at DC or Nyquist */
+            eq->select_preset(0);
+            band = {1000, gains[g], 100};
+            eq->set_band(2, band);
+            check_point("peaking centre", rate, 1000, gain);
+            check_point("peaking dc", rate, 0, 0);
+            check_point("peaking nyquist", rate, nyquist, 0);
+            
+            /* Low shelf: full gain at DC, half (in dB) at the midpoint */
+            eq->select_preset(0);
+            band = {200, gains[g], 71};
+            eq->set_band(0, band);
+            check_point("low shelf dc", rate, 0, gain);
+            check_point("low shelf midpoint", rate, 200, gain / 2);
+            check_point("low shelf nyquist", rate, nyquist, 0);
+            
+            /* High shelf: the mirror image */
+            eq->select_preset(0);
+            band = {5000, gains[g], 71};
+            eq->set_band(EQ_BANDS - 1, band);
+            check_point("high shelf dc", rate, 0, 0);
+            check_point("high shelf midpoint", rate, 5000, gain / 2);
+            check_point("high shelf nyquist", rate, nyquist, gain);
+        }
+    }
+}
+
+static void test_presets_match_response_with_sines() {
+    static const float freqs[] = {50, 150, 300, 1000, 3000, 10000};
+    
+    for (uint8_t p = 0; p < eq->get_preset_count(); p++) {
+        eq->select_preset(p);
+        for (uint8_t f = 0; f < sizeof(freqs) / sizeof(freqs[0]); f++) {
+            Sine sine = {freqs[f], SINE_AMPLITUDE, 0};
+            run_frames(sine, ms_to_frames(SETTLE_MS), nullptr, nullptr, nullptr);
+            
+            uint32_t cycles = (uint32_t)(MEASURE_FRAMES * freqs[f] / AUDIO_SAMPLE_RATE);
+            uint32_t frames = (uint32_t)lrintf(cycles * AUDIO_SAMPLE_RATE / freqs[f]);
+            double in_sq = 0, out_sq = 0;
+            run_frames(sine, frames, &in_sq, &out_sq, nullptr);
+            
+            float measured = (float)(10.0 * log10(out_sq / in_sq));
+            float expected = eq->get_response_db(freqs[f]) + eq->get_preamp_db();
+            char line[96];
+            snprintf(line, sizeof(line), "%s at %.0f Hz: %.3f dB, expected %.3f (preamp %.2f)",
+                     eq->get_preset_name(p), freqs[f], measured, expected, eq->get_preamp_db());
+            TEST_ASSERT_TRUE_MESSAGE(fabsf(measured - expected) <= SINE_TOL_DB, line);
+        }
+    }
+}
+
+static void test_preset_changes_glide() {
+    Sine sine = {GLIDE_FREQ, GLIDE_AMPLITUDE, 0};
+    run_frames(sine, ms_to_frames(SETTLE_MS), nullptr, nullptr, nullptr);
+    
+    check_glide(sine, "flat -> boost", select_boost);
+    check_glide(sine, "boost -> flat", select_flat);
+}
+
+static void test_bypass_changes_glide() {
+    Sine sine = {GLIDE_FREQ, GLIDE_AMPLITUDE, 0};
+    eq->select_preset(boost_preset());
+    run_frames(sine, ms_to_frames(SETTLE_MS), nullptr, nullptr, nullptr);
+    
+    check_glide(sine, "disable", bypass_on);
+    check_glide(sine, "enable from bypass", bypass_off);
+}
+
+void setup() {
+    eq = create_equalizer();
+    eq->init();
+    
+    UNITY_BEGIN();
+    RUN_TEST(test_response_at_exact_points);
+    RUN_TEST(test_presets_match_response_with_sines);
+    RUN_TEST(test_preset_changes_glide);
+    RUN_TEST(test_bypass_changes_glide);
+    native_exit(UNITY_END());
+}
+
+void loop() {}
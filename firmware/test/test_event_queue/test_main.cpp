@@ -0,0 +1,202 @@
+/* ============================================================================
+ * Event Bus Tests
+ * Real-time events overtake UI events, coalescing types merge by their
+ * mode, a full lane drops (and recovers) cleanly, a zero timeout polls
+ * everywhere, and under concurrent posting from tasks and ISRs every post
+ * that returned true is delivered exactly once: merged skip counts add up
+ * to the accepted posts even while the lane keeps overflowing.
+ * ========================================================================== */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "event_queue.h"
+#include "button_handler.h"
+#include "config.h"
+#include "native_host.h"
+
+extern EventQueue* create_event_queue();
+
+static EventQueue* bus;
+
+static void post(EventType type, uint32_t param) {
+    Event event = {type, param};
+    TEST_ASSERT_TRUE(bus->post(event));
+}
+
+static std::vector<Event> drain() {
+    std::vector<Event> out;
+    Event event;
+    while (bus->try_receive(event)) out.push_back(event);
+    return out;
+}
+
+void setUp() {
+    drain();
+}
+
+void tearDown() {}
+
+static void test_realtime_lane_first() {
+    post(EVENT_BT_CONNECTED, 0);
+    post(EVENT_SD_ERROR, 0);
+    post(EVENT_BUTTON_PLAY, GESTURE_SHORT);
+    
+    std::vector<Event> got = drain();
+    TEST_ASSERT_EQUAL_UINT32(3, got.size());
+    TEST_ASSERT_EQUAL(EVENT_BUTTON_PLAY, got[0].type);
+    TEST_ASSERT_EQUAL(EVENT_BT_CONNECTED, got[1].type);
+    TEST_ASSERT_EQUAL(EVENT_SD_ERROR, got[2].type);
+}
+
+static void test_coalescing_modes() {
+    uint32_t coalesced = bus->get_stats().coalesced;
+    
+    for (int i = 0; i < 5; i++) post(EVENT_PLAYBACK_NEXT, 1);       /* Sum */
+    for (uint32_t i = 1; i <= 3; i++) post(EVENT_DISPLAY_STATE_CHANGE, i);  /* Latest */
+    for (int i = 0; i < 4; i++) post(EVENT_DISPLAY_REDRAW, 0);      /* Drop */
+    TEST_ASSERT_EQUAL_UINT32(3, bus->pending_count());
+    TEST_ASSERT_EQUAL_UINT32(4 + 2 + 3, bus->get_stats().coalesced - coalesced);
+    
+    std::vector<Event> got = drain();
+    TEST_ASSERT_EQUAL_UINT32(3, got.size());
+    TEST_ASSERT_EQUAL(EVENT_PLAYBACK_NEXT, got[0].type);
+    TEST_ASSERT_EQUAL_UINT32(5, got[0].param);
+    TEST_ASSERT_EQUAL(EVENT_DISPLAY_STATE_CHANGE, got[1].type);
+    TEST_ASSERT_EQUAL_UINT32(3, got[1].param);
+    TEST_ASSERT_EQUAL(EVENT_DISPLAY_REDRAW, got[2].type);
+    
+    /* Received: the next post starts a fresh count */
+    post(EVENT_PLAYBACK_NEXT, 1);
+    got = drain();
+    TEST_ASSERT_EQUAL_UINT32(1, got[0].param);
+}
+
+static void test_full_lane_drops_and_recovers() {
+    uint32_t dropped = bus->get_stats().dropped;
+    
+    for (int i = 0; i < EVENT_QUEUE_SIZE_RT; i++) post(EVENT_AUDIO_BUFFER_READY, i);
+    Event skip = {EVENT_PLAYBACK_NEXT, 1};
+    TEST_ASSERT_FALSE(bus->post(skip));
+    TEST_ASSERT_FALSE(bus->post(skip));   /* Not merged into the dropped one */
+    TEST_ASSERT_EQUAL_UINT32(2, bus->get_stats().dropped - dropped);
+    TEST_ASSERT_EQUAL_UINT16(EVENT_QUEUE_SIZE_RT, bus->get_stats().depth_high_water[LANE_REALTIME]);
+    
+    /* UI lane is independent */
+    post(EVENT_DISPLAY_REDRAW, 0);
+    
+    TEST_ASSERT_EQUAL_UINT32(EVENT_QUEUE_SIZE_RT + 1, drain().size());
+    TEST_ASSERT_TRUE(bus->post(skip));
+    std::vector<Event> got = drain();
+    TEST_ASSERT_EQUAL_UINT32(1, got.size());
+    TEST_ASSERT_EQUAL_UINT32(1, got[0].param);
+}
+
+static void test_zero_timeout_polls() {
+    Event event;
+    uint64_t start = native_time_us();
+    TEST_ASSERT_FALSE(bus->wait_and_receive(event, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, bus->dispatch(0));
+    TEST_ASSERT_TRUE(native_time_us() - start < 5000);
+    
+    /* A real timeout waits for it ... */
+    start = native_time_us();
+    TEST_ASSERT_FALSE(bus->wait_and_receive(event, 30));
+    TEST_ASSERT_TRUE(native_time_us() - start >= 25000);
+    
+    /* ... and EVENT_WAIT_FOREVER until something arrives */
+    std::thread late([]() {
+        native_sleep_us(50000);
+        Event e = {EVENT_BUTTON_NEXT, GESTURE_SHORT};
+        bus->post(e);
+    });
+    TEST_ASSERT_TRUE(bus->wait_and_receive(event, EVENT_WAIT_FOREVER));
+    TEST_ASSERT_EQUAL(EVENT_BUTTON_NEXT, event.type);
+    late.join();
+}
+
+static void on_count(const Event& event, void* context) {
+    (*static_cast<uint32_t*>(context))++;
+}
+
+static void test_dispatch_runs_subscribers() {
+    static uint32_t calls = 0;
+    TEST_ASSERT_TRUE(bus->subscribe(EVENT_SD_FILE_LOADED, on_count, &calls));
+    post(EVENT_SD_FILE_LOADED, 0);
+    post(EVENT_SD_FILE_LOADED, 0);
+    post(EVENT_BUTTON_PREV, GESTURE_SHORT);
+    TEST_ASSERT_EQUAL_UINT32(3, bus->dispatch(0));
+    TEST_ASSERT_EQUAL_UINT32(2, calls);
+}
+
+static void test_concurrent_posts_are_never_lost() {
+    static const int PRODUCERS = 4;
+    static const int POSTS = 20000;
+    
+    EventBusStats before = bus->get_stats();
+    std::atomic<uint32_t> accepted_skips(0), accepted_other(0), rejected(0);
+    std::atomic<bool> producing(true);
+    uint32_t received_skips = 0, received_other = 0;
+    
+    /* Slow consumer: the real-time lane overflows throughout */
+    std::thread consumer([&]() {
+        Event event;
+        while (producing || bus->pending_count() > 0) {
+            if (!bus->wait_and_receive(event, 2)) continue;
+            if (event.type == EVENT_PLAYBACK_NEXT) received_skips += event.param;
+            else received_other++;
+        }
+    });
+    
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < POSTS; i++) {
+                bool skip = (i % 3) != 0;
+                Event event = {skip ? EVENT_PLAYBACK_NEXT : EVENT_AUDIO_BUFFER_READY, 1};
+                int woken = 0;
+                bool ok = (p == 0) ? bus->post_from_isr(event, &woken) : bus->post(event);
+                if (!ok) rejected++;
+                else if (skip) accepted_skips++;
+                else accepted_other++;
+                if ((i & 15) == 0) native_sleep_us(20);   /* Let the consumer in now and then */
+            }
+        });
+    }
+    for (std::thread& t : producers) t.join();
+    producing = false;
+    consumer.join();
+    
+    const EventBusStats& after = bus->get_stats();
+    char line[128];
+    snprintf(line, sizeof(line), "%u skips, %u other accepted; %u dropped; %u coalesced",
+             (unsigned)accepted_skips, (unsigned)accepted_other, (unsigned)rejected,
+             (unsigned)(after.coalesced - before.coalesced));
+    TEST_MESSAGE(line);
+    
+    TEST_ASSERT_EQUAL_UINT32(accepted_skips, received_skips);
+    TEST_ASSERT_EQUAL_UINT32(accepted_other, received_other);
+    TEST_ASSERT_EQUAL_UINT32(accepted_skips + accepted_other, after.posted - before.posted);
+    TEST_ASSERT_EQUAL_UINT32(rejected, after.dropped - before.dropped);
+    TEST_ASSERT_GREATER_THAN(0, rejected);   /* The overflow path was exercised */
+    TEST_ASSERT_TRUE(after.depth_high_water[LANE_REALTIME] <= EVENT_QUEUE_SIZE_RT);
+    TEST_ASSERT_EQUAL_UINT32(0, bus->pending_count());
+}
+
+void setup() {
+    bus = create_event_queue();
+    
+    UNITY_BEGIN();
+    RUN_TEST(test_realtime_lane_first);
+    RUN_TEST(test_coalescing_modes);
+    RUN_TEST(test_full_lane_drops_and_recovers);
+    RUN_TEST(test_zero_timeout_polls);
+    RUN_TEST(test_dispatch_runs_subscribers);
+    RUN_TEST(test_concurrent_posts_are_never_lost);
+    native_exit(UNITY_END());
+}
+
+void loop() {}
@@ -0,0 +1,124 @@
+/* ============================================================================
+ * Level Meter Tests
+ * Peak/RMS and band energies of known signals, linearity up to full scale,
+ * and the tap's cost as a share of one core at the stream's real-time rate.
+ * ========================================================================== */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "level_meter.h"
+#include "config.h"
+#include "native_host.h"
+
+static LevelMeter* meter;
+
+/* Interleaved stereo, both channels equal */
+static std::vector<int16_t> sine(float hz, float amplitude, size_t frames) {
+    std::vector<int16_t> pcm(frames * 2);
+    for (size_t i = 0; i < frames; i++) {
+        int16_t v = (int16_t)lrintf(amplitude * sinf(2.0f * (float)M_PI * hz * i / AUDIO_SAMPLE_RATE));
+        pcm[2 * i] = pcm[2 * i + 1] = v;
+    }
+    return pcm;
+}
+
+static std::vector<int16_t> square(uint32_t period_frames, int16_t amplitude, size_t frames) {
+    std::vector<int16_t> pcm(frames * 2);
+    for (size_t i = 0; i < frames; i++) {
+        int16_t v = ((i % period_frames) < period_frames / 2) ? amplitude : (int16_t)-amplitude;
+        pcm[2 * i] = pcm[2 * i + 1] = v;
+    }
+    return pcm;
+}
+
+/* Feed in sink-sized chunks; snapshot of the last complete block */
+static LevelSnapshot measure(const std::vector<int16_t>& pcm) {
+    for (size_t done = 0; done < pcm.size(); ) {
+        size_t n = pcm.size() - done;
+        if (n > AUDIO_PCM_FRAME_SAMPLES) n = AUDIO_PCM_FRAME_SAMPLES;
+        meter->process(&pcm[done], n);
+        done += n;
+    }
+    LevelSnapshot snap;
+    meter->read(snap);
+    return snap;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_sine_peak_and_rms() {
+    LevelSnapshot s = measure(sine(1000, 16384, LEVEL_METER_BLOCK_FRAMES * 8));
+    for (uint8_t ch = 0; ch < 2; ch++) {
+        TEST_ASSERT_UINT32_WITHIN(2, 16384, s.peak[ch]);
+        TEST_ASSERT_UINT32_WITHIN(120, 11585, s.rms[ch]);   /* A / sqrt(2) */
+    }
+}
+
+static void test_bands_follow_frequency() {
+    /* Each band reads highest for the tone inside it */
+    static const float tones[LEVEL_METER_BANDS] = {80, 800, 4000};
+    LevelSnapshot s[LEVEL_METER_BANDS];
+    for (uint8_t t = 0; t < LEVEL_METER_BANDS; t++) {
+        s[t] = measure(sine(tones[t], 16384, LEVEL_METER_BLOCK_FRAMES * 8));
+        char line[64];
+        snprintf(line, sizeof(line), "%4.0f Hz: low %5u mid %5u high %5u", tones[t],
+                 (unsigned)s[t].band[0], (unsigned)s[t].band[1], (unsigned)s[t].band[2]);
+        TEST_MESSAGE(line);
+    }
+    for (uint8_t b = 0; b < LEVEL_METER_BANDS; b++) {
+        for (uint8_t t = 0; t < LEVEL_METER_BANDS; t++) {
+            if (t != b) TEST_ASSERT_GREATER_THAN(s[t].band[b], s[b].band[b]);
+        }
+    }
+}
+
+static void test_full_scale_stays_linear() {
+    /* Full-scale steps give the largest band excursions (mid ~0.65 × 65535) */
+    LevelSnapshot half = measure(square(64, 16383, LEVEL_METER_BLOCK_FRAMES * 8));
+    LevelSnapshot full = measure(square(64, 32766, LEVEL_METER_BLOCK_FRAMES * 8));
+    
+    char what[96];
+    snprintf(what, sizeof(what), "half %u %u %u, full %u %u %u",
+             (unsigned)half.band[0], (unsigned)half.band[1], (unsigned)half.band[2],
+             (unsigned)full.band[0], (unsigned)full.band[1], (unsigned)full.band[2]);
+    TEST_MESSAGE(what);
+    for (uint8_t b = 0; b < LEVEL_METER_BANDS; b++) {
+        uint32_t expected = 2u * half.band[b];
+        if (expected > 32767) expected = 32767;
+        TEST_ASSERT_UINT32_WITHIN_MESSAGE(expected / 50 + 2, expected, full.band[b], what);
+    }
+}
+
+static void test_cost_under_one_percent_of_a_core() {
+    const size_t frames = AUDIO_SAMPLE_RATE * 20;   /* 20 s of audio */
+    std::vector<int16_t> pcm = sine(440, 12000, frames);
+    
+    uint64_t start = native_time_us();
+    measure(pcm);
+    uint64_t elapsed_us = native_time_us() - start;
+    
+    double ns_per_frame = elapsed_us * 1000.0 / frames;
+    double load_pct = 100.0 * elapsed_us / (frames * 1000000.0 / AUDIO_SAMPLE_RATE);
+    char line[96];
+    snprintf(line, sizeof(line), "%.1f ns per stereo frame: %.3f%% of a host core at %d Hz",
+             ns_per_frame, load_pct, AUDIO_SAMPLE_RATE);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_TRUE_MESSAGE(load_pct < 1.0, line);
+}
+
+void setup() {
+    meter = create_level_meter();
+    
+    UNITY_BEGIN();
+    RUN_TEST(test_sine_peak_and_rms);
+    RUN_TEST(test_bands_follow_frequency);
+    RUN_TEST(test_full_scale_stays_linear);
+    RUN_TEST(test_cost_under_one_percent_of_a_core);
+    native_exit(UNITY_END());
+}
+
+void loop() {}
@@ -0,0 +1,85 @@
+/* ============================================================================
+ * Memory Telemetry Tests
+ * The RTC record must carry a valid CRC after every change: a reset right
+ * after a task registers or retires would otherwise throw the whole
+ * record away on the next boot.
+ * ========================================================================== */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <cstddef>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "memory_telemetry.h"
+#include "config.h"
+#include "native_host.h"
+
+static MemoryTelemetry* telemetry;
+
+/* Same CRC-32 (reflected, 0xEDB88320) the record is sealed with */
+static uint32_t crc32(const uint8_t* data, size_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static bool sealed(const MemoryRecord& r) {
+    return r.crc == crc32((const uint8_t*)&r, offsetof(MemoryRecord, crc));
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_register_reseals() {
+    MemoryRecord r;
+    telemetry->register_task(MEM_TASK_LOOP, xTaskGetCurrentTaskHandle(), 8192);
+    telemetry->get_record(r);
+    TEST_ASSERT_EQUAL_UINT32(8192, r.stack_size[MEM_TASK_LOOP]);
+    TEST_ASSERT_TRUE(sealed(r));
+}
+
+static volatile bool retired = false;
+
+static void boot_task(void* arg) {
+    telemetry->register_task(MEM_TASK_SD_BOOT, xTaskGetCurrentTaskHandle(), 4096);
+    volatile uint8_t scratch[512];
+    for (size_t i = 0; i < sizeof(scratch); i++) scratch[i] = (uint8_t)i;
+    telemetry->retire_task(MEM_TASK_SD_BOOT);
+    retired = true;
+    vTaskDelete(nullptr);
+}
+
+static void test_retired_task_keeps_its_mark() {
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(boot_task, "boot", 4096, nullptr, 1, nullptr));
+    while (!retired) delay(1);
+    
+    MemoryRecord r;
+    telemetry->get_record(r);
+    TEST_ASSERT_TRUE(sealed(r));
+    TEST_ASSERT_EQUAL_UINT32(4096, r.stack_size[MEM_TASK_SD_BOOT]);
+    TEST_ASSERT_TRUE(r.stack_free_min[MEM_TASK_SD_BOOT] < 4096);   /* Final mark taken */
+    
+    /* The handle is gone: sampling must not touch it, and reseals */
+    uint32_t mark = r.stack_free_min[MEM_TASK_SD_BOOT];
+    telemetry->sample();
+    telemetry->get_record(r);
+    TEST_ASSERT_TRUE(sealed(r));
+    TEST_ASSERT_EQUAL_UINT32(mark, r.stack_free_min[MEM_TASK_SD_BOOT]);
+}
+
+void setup() {
+    telemetry = create_memory_telemetry();
+    if (!telemetry->init()) native_exit(1);
+    
+    UNITY_BEGIN();
+    RUN_TEST(test_register_reseals);
+    RUN_TEST(test_retired_task_keeps_its_mark);
+    native_exit(UNITY_END());
+}
+
+void loop() {}
@@ -0,0 +1,168 @@
+/* ============================================================================
+ * Playlist Tests
+ * A 10,000-entry M3U must count exactly, resolve every entry in and out of
+ * order, and keep the read cost of a random access within the sparse-index
+ * bound (one seek plus at most stride - 1 skipped entries). Playlists that
+ * fail to open must leave nothing open behind them.
+ * ========================================================================== */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+#include "playlist.h"
+#include "shuffle.h"
+#include "config.h"
+#include "native_host.h"
+
+static const uint32_t ENTRIES = 10000;
+static const uint32_t CHUNK_BYTES = 64;   /* M3UPlaylistImpl read granularity */
+
+/* Fixed-width lines so the per-entry size is known: 41 + 23 bytes */
+#define EXTINF_FMT "#EXTINF:180,Artist %05u - Title %05u\r\n"
+#define ENTRY_FMT  "music/track_%05u.mp3\r\n"
+static const uint32_t ENTRY_BYTES = 41 + 23;
+
+static std::string sd_root;
+
+static bool write_file(const char* volume_path, const std::string& text) {
+    std::string host = sd_root + volume_path;
+    FILE* f = fopen(host.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(text.data(), 1, text.size(), f) == text.size();
+    return fclose(f) == 0 && ok;
+}
+
+/* Scratch card in /tmp served through NATIVE_SD_ROOT */
+static bool make_card() {
+    char dir[] = "/tmp/test_playlist_XXXXXX";
+    if (!mkdtemp(dir)) return false;
+    sd_root = dir;
+    setenv("NATIVE_SD_ROOT", dir, 1);
+    if (mkdir((sd_root + "/lists").c_str(), 0755) != 0) return false;
+    
+    std::string big = "\xEF\xBB\xBF#EXTM3U\r\n";
+    char buf[96];
+    for (uint32_t i = 0; i < ENTRIES; i++) {
+        snprintf(buf, sizeof(buf), EXTINF_FMT, (unsigned)i, (unsigned)i);
+        big += buf;
+        snprintf(buf, sizeof(buf), ENTRY_FMT, (unsigned)i);
+        big += buf;
+    }
+    return write_file("/lists/big.m3u", big) &&
+           write_file("/lists/empty.m3u", "#EXTM3U\r\n\r\n# nothing here\r\n");
+}
+
+static void expected_path(uint32_t index, char* path, size_t len) {
+    snprintf(path, len, "/lists/music/track_%05u.mp3", (unsigned)index);
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_counts_ten_thousand_entries() {
+    Playlist* pls = create_playlist();
+    TEST_ASSERT_TRUE(pls->open("/lists/big.m3u"));
+    TEST_ASSERT_TRUE(pls->is_open());
+    TEST_ASSERT_EQUAL_UINT32(ENTRIES, pls->get_count());
+    pls->close();
+}
+
+static void test_in_order_reads_one_entry_each() {
+    Playlist* pls = create_playlist();
+    TEST_ASSERT_TRUE(pls->open("/lists/big.m3u"));
+    
+    char path[PLAYLIST_PATH_MAX], want[PLAYLIST_PATH_MAX];
+    uint64_t worst = 0;
+    for (uint32_t i = 0; i < ENTRIES; i++) {
+        uint64_t before = native_sd_bytes_read();
+        TEST_ASSERT_TRUE(pls->get_entry(i, path, sizeof(path)));
+        uint64_t cost = native_sd_bytes_read() - before;
+        if (cost > worst) worst = cost;
+        expected_path(i, want, sizeof(want));
+        TEST_ASSERT_EQUAL_STRING(want, path);
+    }
+    
+    char line[96];
+    snprintf(line, sizeof(line), "in order: worst %u bytes per entry", (unsigned)worst);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_LESS_OR_EQUAL(ENTRY_BYTES + CHUNK_BYTES, worst);
+    pls->close();
+}
+
+static void test_random_access_within_index_bound() {
+    Playlist* pls = create_playlist();
+    TEST_ASSERT_TRUE(pls->open("/lists/big.m3u"));
+    
+    /* Smallest power of two that fits the entries into the index */
+    uint32_t stride = 1;
+    while ((ENTRIES + stride - 1) / stride > PLAYLIST_INDEX_SLOTS) stride *= 2;
+    uint64_t bound = (uint64_t)stride * ENTRY_BYTES + CHUNK_BYTES;
+    
+    ShuffleOrder order;
+    order.reset(ENTRIES, SHUFFLE_SEED);
+    char path[PLAYLIST_PATH_MAX], want[PLAYLIST_PATH_MAX];
+    uint64_t worst = 0, total = 0;
+    for (uint32_t pos = 0; pos < ENTRIES; pos++) {
+        uint32_t i = order.track_at(pos);
+        uint64_t before = native_sd_bytes_read();
+        TEST_ASSERT_TRUE(pls->get_entry(i, path, sizeof(path)));
+        uint64_t cost = native_sd_bytes_read() - before;
+        total += cost;
+        if (cost > worst) worst = cost;
+        expected_path(i, want, sizeof(want));
+        TEST_ASSERT_EQUAL_STRING(want, path);
+    }
+    
+    char line[128];
+    snprintf(line, sizeof(line), "random: stride %u, avg %u bytes, worst %u bytes (bound %u)",
+             (unsigned)stride, (unsigned)(total / ENTRIES), (unsigned)worst, (unsigned)bound);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_LESS_OR_EQUAL(64, stride);
+    TEST_ASSERT_LESS_OR_EQUAL(bound, worst);
+    
+    TEST_ASSERT_FALSE(pls->get_entry(ENTRIES, path, sizeof(path)));
+    pls->close();
+}
+
+static void test_empty_playlist_leaves_nothing_open() {
+    Playlist* pls = create_playlist();
+    TEST_ASSERT_FALSE(pls->open("/lists/empty.m3u"));
+    TEST_ASSERT_FALSE(pls->is_open());
+    TEST_ASSERT_EQUAL_UINT32(0, pls->get_count());
+    
+    char path[PLAYLIST_PATH_MAX];
+    TEST_ASSERT_FALSE(pls->get_entry(0, path, sizeof(path)));
+}
+
+static void test_missing_playlist_closes_previous() {
+    Playlist* pls = create_playlist();
+    TEST_ASSERT_TRUE(pls->open("/lists/big.m3u"));
+    TEST_ASSERT_FALSE(pls->open("/lists/missing.m3u"));
+    TEST_ASSERT_FALSE(pls->is_open());
+    TEST_ASSERT_EQUAL_UINT32(0, pls->get_count());
+}
+
+void setup() {
+    if (!make_card()) {
+        printf("cannot create the scratch card\n");
+        native_exit(1);
+    }
+    
+    UNITY_BEGIN();
+    RUN_TEST(test_counts_ten_thousand_entries);
+    RUN_TEST(test_in_order_reads_one_entry_each);
+    RUN_TEST(test_random_access_within_index_bound);
+    RUN_TEST(test_empty_playlist_leaves_nothing_open);
+    RUN_TEST(test_missing_playlist_closes_previous);
+    int status = UNITY_END();
+    
+    std::string cleanup = "rm -rf " + sd_root;
+    (void)system(cleanup.c_str());
+    native_exit(status);
+}
+
+void loop() {}
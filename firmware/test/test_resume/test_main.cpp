@@ -0,0 +1,119 @@
+/* ============================================================================
+ * Resume Journal Tests
+ * The journaled byte offset is only valid for the file it was taken in.
+ * Power-up resumes mid-track when the track index still names that file,
+ * and starts the track from 0 when the card changed underneath it.
+ * ========================================================================== */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include "playback_control.h"
+#include "sd_card.h"
+#include "config.h"
+#include "native_host.h"
+
+extern SDCard* create_sd_card();
+
+static const uint32_t FRAME_BYTES = 384;   /* 128 kbps at 48 kHz, no padding */
+static const uint32_t FRAMES = 2500;       /* 60 s */
+
+static std::string scratch;
+static PlaybackController* playback;
+static uint32_t paused_at_ms = 0;
+
+/* Synthetic stream behind an ID3v2 tag of `tag_bytes` (the size differs) */
+static bool write_track(uint32_t tag_bytes) {
+    FILE* f = fopen("sdcard/book.mp3", "wb");
+    if (!f) return false;
+    
+    for (uint32_t i = 0; i < tag_bytes; i++) {
+        static const uint8_t header[10] = {'I', 'D', '3', 3, 0, 0, 0, 0, 0, 0};
+        uint8_t byte = (i < 10) ? header[i] : 0;
+        if (i == 8) byte = (uint8_t)((tag_bytes - 10) >> 7);
+        if (i == 9) byte = (uint8_t)((tag_bytes - 10) & 0x7F);
+        fputc(byte, f);
+    }
+    
+    uint8_t frame[FRAME_BYTES] = {0xFF, 0xFB, 0x94, 0x00};   /* MPEG-1 L3, stereo */
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        fwrite(frame, 1, sizeof(frame), f);
+    }
+    return fclose(f) == 0;
+}
+
+/* Scratch dir holding the card (NATIVE_SD_ROOT) and NVS */
+static bool make_card() {
+    char dir[] = "/tmp/test_resume_XXXXXX";
+    if (!mkdtemp(dir) || chdir(dir) != 0) return false;
+    scratch = dir;
+    setenv("NATIVE_SD_ROOT", (scratch + "/sdcard").c_str(), 1);
+    if (system("mkdir -p sdcard nvs") != 0) return false;
+    return write_track(1024);
+}
+
+/* Power cycle as far as playback sees it: journal reloaded, library rescanned */
+static void reboot() {
+    TEST_ASSERT_TRUE(playback->init());
+    playback->set_library(1, false);
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_pause_journals_the_point() {
+    playback->set_library(1, false);
+    playback->execute_command(CMD_TOGGLE_PLAY_PAUSE);
+    TEST_ASSERT_EQUAL(STATE_PLAYING, playback->get_state());
+    playback->execute_command(CMD_TOGGLE_PLAY_PAUSE);
+    for (int i = 0; i < 6; i++) playback->execute_command(CMD_SCAN_FORWARD);
+    playback->execute_command(CMD_SCAN_STOP);
+    playback->execute_command(CMD_TOGGLE_PLAY_PAUSE);
+    playback->execute_command(CMD_TOGGLE_PLAY_PAUSE);   /* Paused: committed */
+    TEST_ASSERT_EQUAL(STATE_PAUSED, playback->get_state());
+    
+    paused_at_ms = playback->get_current_position_ms();
+    TEST_ASSERT_TRUE(paused_at_ms >= 10000);
+}
+
+static void test_same_file_resumes_mid_track() {
+    reboot();
+    playback->execute_command(CMD_TOGGLE_PLAY_PAUSE);
+    TEST_ASSERT_EQUAL(STATE_PLAYING, playback->get_state());
+    TEST_ASSERT_UINT32_WITHIN(50, paused_at_ms, playback->get_current_position_ms());
+    playback->execute_command(CMD_TOGGLE_PLAY_PAUSE);
+}
+
+static void test_changed_file_starts_at_zero() {
+    /* Same name and index, different file: the old offset means nothing here */
+    TEST_ASSERT_TRUE(write_track(2048 + 7));
+    reboot();
+    playback->execute_command(CMD_TOGGLE_PLAY_PAUSE);
+    TEST_ASSERT_EQUAL(STATE_PLAYING, playback->get_state());
+    TEST_ASSERT_UINT32_WITHIN(50, 0, playback->get_current_position_ms());
+    playback->execute_command(CMD_STOP);
+}
+
+void setup() {
+    if (!make_card() || !create_sd_card()->init()) {
+        printf("cannot create the scratch card\n");
+        native_exit(1);
+    }
+    playback = create_playback_controller();
+    if (!playback->init()) native_exit(1);
+    
+    UNITY_BEGIN();
+    RUN_TEST(test_pause_journals_the_point);
+    RUN_TEST(test_same_file_resumes_mid_track);
+    RUN_TEST(test_changed_file_starts_at_zero);
+    int status = UNITY_END();
+    
+    std::string cleanup = "rm -rf " + scratch;
+    (void)system(cleanup.c_str());
+    native_exit(status);
+}
+
+void loop() {}
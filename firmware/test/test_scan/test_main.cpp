@@ -0,0 +1,176 @@
+/* ============================================================================
+ * Hold-to-Scan Tests
+ * A seek must land on a real frame start near its target after reading a
+ * single window (nothing skipped is decoded), and holding NEXT/PREV must
+ * step 2 s → 5 s → 15 s every SCAN_STEPS_PER_STAGE jumps, clamped to the
+ * track, with the polled position following each jump.
+ *
+ * The card holds a synthetic 10-minute MPEG-1 Layer III stream, 128 kbps
+ * at 48 kHz (384-byte frames, 24 ms each, no padding) behind an ID3v2 tag.
+ * Frame payloads are random, so false sync words occur as on real files.
+ * ========================================================================== */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include "playback_control.h"
+#include "audio_decoder.h"
+#include "audio_arena.h"
+#include "sd_card.h"
+#include "config.h"
+#include "native_host.h"
+
+extern AudioDecoder* create_audio_decoder();
+extern SDCard* create_sd_card();
+
+static const uint32_t FRAME_BYTES = 384;
+static const uint32_t FRAME_MS = 24;
+static const uint32_t FRAMES = 25000;          /* 600 s */
+static const uint32_t TAG_BYTES = 10 + 1014;   /* ID3v2 header + body */
+static const uint32_t TRACK_MS = FRAMES * FRAME_MS;
+
+static std::string scratch;
+
+/* Scratch dir holding the card (NATIVE_SD_ROOT), NVS and display.pbm */
+static bool make_card() {
+    char dir[] = "/tmp/test_scan_XXXXXX";
+    if (!mkdtemp(dir) || chdir(dir) != 0) return false;
+    scratch = dir;
+    setenv("NATIVE_SD_ROOT", (scratch + "/sdcard").c_str(), 1);
+    if (system("mkdir -p sdcard nvs") != 0) return false;
+    
+    FILE* f = fopen("sdcard/book.mp3", "wb");
+    if (!f) return false;
+    
+    uint8_t tag[TAG_BYTES] = {'I', 'D', '3', 3, 0, 0, 0, 0, (TAG_BYTES - 10) >> 7, (TAG_BYTES - 10) & 0x7F};
+    fwrite(tag, 1, sizeof(tag), f);
+    
+    uint32_t rng = 12345;
+    uint8_t frame[FRAME_BYTES] = {0xFF, 0xFB, 0x94, 0x00};   /* 128 kbps, 48 kHz, stereo */
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        for (uint32_t k = 4; k < FRAME_BYTES; k++) {
+            rng = rng * 1103515245u + 12345u;
+            frame[k] = (uint8_t)(rng >> 16);
+        }
+        fwrite(frame, 1, sizeof(frame), f);
+    }
+    return fclose(f) == 0;
+}
+
+/* Where a jump to `target_ms` must land: the first frame at or after it */
+static uint32_t landing_ms(uint32_t target_ms) {
+    return (target_ms + FRAME_MS - 1) / FRAME_MS * FRAME_MS;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_seek_lands_on_frame_after_one_window() {
+    AudioDecoder* decoder = create_audio_decoder();
+    TEST_ASSERT_TRUE(decoder->open("/book.mp3"));
+    TEST_ASSERT_UINT32_WITHIN(FRAME_MS, TRACK_MS, decoder->get_duration_ms());
+    
+    DecoderStats before;
+    decoder->get_stats(before);
+    
+    char what[64];
+    uint32_t seeks = 0;
+    uint64_t elapsed_us = 0;
+    for (uint32_t target = 0; target < TRACK_MS - 1000; target += 1733) {
+        snprintf(what, sizeof(what), "target %u ms", (unsigned)target);
+        uint64_t bytes = native_sd_bytes_read();
+        uint64_t start = native_time_us();
+        TEST_ASSERT_TRUE_MESSAGE(decoder->seek(target), what);
+        elapsed_us += native_time_us() - start;
+        seeks++;
+        
+        uint32_t offset = decoder->get_byte_offset();
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, (offset - TAG_BYTES) % FRAME_BYTES, what);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(landing_ms(target), decoder->get_current_position_ms(), what);
+        TEST_ASSERT_TRUE_MESSAGE(native_sd_bytes_read() - bytes <= sizeof(AudioArena::decoder_input), what);
+    }
+    
+    /* Seeking skipped everything without decoding a frame */
+    DecoderStats after;
+    decoder->get_stats(after);
+    TEST_ASSERT_EQUAL_UINT32(before.frames, after.frames);
+    
+    snprintf(what, sizeof(what), "%u seeks, %.1f us each", (unsigned)seeks, (double)elapsed_us / seeks);
+    TEST_MESSAGE(what);
+    decoder->close();
+}
+
+static void test_scan_accelerates_and_follows_position() {
+    PlaybackController* playback = create_playback_controller();
+    TEST_ASSERT_TRUE(playback->init());
+    playback->set_library(1, false);
+    
+    /* Start, then pause: the play clock stands still between jumps */
+    playback->execute_command(CMD_TOGGLE_PLAY_PAUSE);
+    TEST_ASSERT_EQUAL(STATE_PLAYING, playback->get_state());
+    playback->execute_command(CMD_TOGGLE_PLAY_PAUSE);
+    TEST_ASSERT_EQUAL(STATE_PAUSED, playback->get_state());
+    TEST_ASSERT_EQUAL_UINT32(0, playback->get_current_position_ms());
+    
+    /* Forward to 5:00: 4 × 2 s, 4 × 5 s, then 15 s steps */
+    uint32_t expect = 0;
+    uint32_t jumps = 0;
+    char what[64];
+    while (expect < 300000) {
+        uint32_t step = (jumps < SCAN_STEPS_PER_STAGE) ? SCAN_STEP_1_MS :
+                        (jumps < 2 * SCAN_STEPS_PER_STAGE) ? SCAN_STEP_2_MS : SCAN_STEP_3_MS;
+        expect = landing_ms(expect + step);
+        playback->execute_command(CMD_SCAN_FORWARD);
+        jumps++;
+        snprintf(what, sizeof(what), "jump %u", (unsigned)jumps);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(expect, playback->get_current_position_ms(), what);
+    }
+    TEST_ASSERT_EQUAL_UINT32(27, jumps);
+    snprintf(what, sizeof(what), "5:00 after %u jumps (%u ms held)", (unsigned)jumps,
+             (unsigned)(BTN_LONG_PRESS_MS + (jumps - 1) * BTN_REPEAT_MS));
+    TEST_MESSAGE(what);
+    
+    /* Release, then PREV: the stage restarts at 2 s in the new direction */
+    playback->execute_command(CMD_SCAN_STOP);
+    playback->execute_command(CMD_SCAN_BACKWARD);
+    TEST_ASSERT_EQUAL_UINT32(landing_ms(expect - SCAN_STEP_1_MS), playback->get_current_position_ms());
+    
+    /* Clamped at the start ... */
+    for (int i = 0; i < 40; i++) playback->execute_command(CMD_SCAN_BACKWARD);
+    TEST_ASSERT_EQUAL_UINT32(0, playback->get_current_position_ms());
+    
+    /* ... and a second before the end, without leaving the track */
+    for (int i = 0; i < 60; i++) playback->execute_command(CMD_SCAN_FORWARD);
+    TEST_ASSERT_EQUAL_UINT32(landing_ms(TRACK_MS - 1000), playback->get_current_position_ms());
+    TEST_ASSERT_EQUAL(STATE_PAUSED, playback->get_state());
+    playback->execute_command(CMD_SCAN_STOP);
+    
+    /* Scanning while playing keeps playing */
+    playback->execute_command(CMD_TOGGLE_PLAY_PAUSE);
+    playback->execute_command(CMD_SCAN_BACKWARD);
+    TEST_ASSERT_EQUAL(STATE_PLAYING, playback->get_state());
+    TEST_ASSERT_UINT32_WITHIN(FRAME_MS + 50, TRACK_MS - 1000 - SCAN_STEP_1_MS,
+                              playback->get_current_position_ms());
+    playback->execute_command(CMD_STOP);
+}
+
+void setup() {
+    if (!make_card() || !create_sd_card()->init()) {
+        printf("cannot create the scratch card\n");
+        native_exit(1);
+    }
+    
+    UNITY_BEGIN();
+    RUN_TEST(test_seek_lands_on_frame_after_one_window);
+    RUN_TEST(test_scan_accelerates_and_follows_position);
+    int status = UNITY_END();
+    
+    std::string cleanup = "rm -rf " + scratch;
+    (void)system(cleanup.c_str());
+    native_exit(status);
+}
+
+void loop() {}
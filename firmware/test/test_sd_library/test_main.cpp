@@ -0,0 +1,144 @@
+/* ============================================================================
+ * Root-Directory Library Tests
+ * count_files() must count only the MP3s in the root directory, and
+ * get_file_path() must resolve every index to the file a full directory
+ * walk finds there, in any order, while opening at most one stride of
+ * entries past its index slot instead of walking from the first entry.
+ * A remount rebuilds the index for the card as it is now.
+ * ========================================================================== */
+
+#include <Arduino.h>
+#include <SD.h>
+#include <unity.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include "sd_card.h"
+#include "shuffle.h"
+#include "config.h"
+#include "native_host.h"
+
+extern SDCard* create_sd_card();
+
+static const uint32_t TRACKS = 2000;
+static const uint32_t OTHERS_EVERY = 50;   /* A cover or a folder among the MP3s */
+
+static std::string sd_root;
+static SDCard* sd;
+
+static bool touch(const std::string& volume_path) {
+    FILE* f = fopen((sd_root + volume_path).c_str(), "wb");
+    return f && fclose(f) == 0;
+}
+
+/* Scratch card in /tmp served through NATIVE_SD_ROOT */
+static bool make_card() {
+    char dir[] = "/tmp/test_sd_library_XXXXXX";
+    if (!mkdtemp(dir)) return false;
+    sd_root = dir;
+    setenv("NATIVE_SD_ROOT", dir, 1);
+    
+    char name[64];
+    for (uint32_t i = 0; i < TRACKS; i++) {
+        snprintf(name, sizeof(name), "/track_%04u.MP3", (unsigned)i);
+        if (!touch(name)) return false;
+        if (i % OTHERS_EVERY != 0) continue;
+        snprintf(name, sizeof(name), "/cover_%04u.jpg", (unsigned)i);
+        if (!touch(name)) return false;
+        snprintf(name, sizeof(name), "/album_%04u.mp3", (unsigned)i);
+        if (mkdir((sd_root + name).c_str(), 0755) != 0) return false;
+    }
+    return true;
+}
+
+/* The MP3s in directory order, as a full walk of the root sees them */
+static std::vector<std::string> walk_root() {
+    std::vector<std::string> paths;
+    File root = SD.open("/");
+    for (File entry = root.openNextFile(); entry; entry = root.openNextFile()) {
+        const char* name = entry.name();
+        size_t len = strlen(name);
+        if (!entry.isDirectory() && len > 4 && strcasecmp(name + len - 4, ".mp3") == 0) {
+            paths.push_back(std::string("/") + name);
+        }
+    }
+    return paths;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_counts_only_mp3_files() {
+    TEST_ASSERT_EQUAL_INT((int)TRACKS, sd->count_files());
+}
+
+static void test_random_access_within_index_bound() {
+    std::vector<std::string> want = walk_root();
+    TEST_ASSERT_EQUAL_UINT32(TRACKS, want.size());
+    
+    /* Smallest power of two that fits the tracks into the index */
+    uint32_t stride = 1;
+    while ((TRACKS + stride - 1) / stride > SD_DIR_INDEX_SLOTS) stride *= 2;
+    /* Root, up to stride entries to the track, and the others among them */
+    uint64_t bound = 1 + stride + 2 * ((stride + OTHERS_EVERY - 1) / OTHERS_EVERY);
+    
+    ShuffleOrder order;
+    order.reset(TRACKS, SHUFFLE_SEED);
+    char path[PLAYLIST_PATH_MAX];
+    uint64_t worst = 0, total = 0;
+    for (uint32_t pos = 0; pos < TRACKS; pos++) {
+        uint32_t i = order.track_at(pos);
+        uint64_t before = native_sd_opens();
+        TEST_ASSERT_TRUE(sd->get_file_path((int)i, path, sizeof(path)));
+        uint64_t cost = native_sd_opens() - before;
+        total += cost;
+        if (cost > worst) worst = cost;
+        TEST_ASSERT_EQUAL_STRING(want[i].c_str(), path);
+    }
+    
+    char line[128];
+    snprintf(line, sizeof(line), "random: stride %u, avg %u opens, worst %u opens (bound %u)",
+             (unsigned)stride, (unsigned)(total / TRACKS), (unsigned)worst, (unsigned)bound);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_LESS_OR_EQUAL(bound, worst);
+    
+    TEST_ASSERT_FALSE(sd->get_file_path((int)TRACKS, path, sizeof(path)));
+    TEST_ASSERT_FALSE(sd->get_file_path(-1, path, sizeof(path)));
+}
+
+static void test_remount_rebuilds_index() {
+    TEST_ASSERT_TRUE(touch("/zz_added.mp3"));
+    sd->unmount();
+    TEST_ASSERT_TRUE(sd->init());
+    
+    /* No count_files() in between: the first lookup indexes the new card */
+    std::vector<std::string> want = walk_root();
+    TEST_ASSERT_EQUAL_UINT32(TRACKS + 1, want.size());
+    char path[PLAYLIST_PATH_MAX];
+    TEST_ASSERT_TRUE(sd->get_file_path((int)TRACKS, path, sizeof(path)));
+    TEST_ASSERT_EQUAL_STRING(want[TRACKS].c_str(), path);
+    TEST_ASSERT_EQUAL_INT((int)TRACKS + 1, sd->count_files());
+}
+
+void setup() {
+    sd = create_sd_card();
+    if (!make_card() || !sd->init()) {
+        printf("cannot create the scratch card\n");
+        native_exit(1);
+    }
+    
+    UNITY_BEGIN();
+    RUN_TEST(test_counts_only_mp3_files);
+    RUN_TEST(test_random_access_within_index_bound);
+    RUN_TEST(test_remount_rebuilds_index);
+    int status = UNITY_END();
+    
+    std::string cleanup = "rm -rf " + sd_root;
+    (void)system(cleanup.c_str());
+    native_exit(status);
+}
+
+void loop() {}
@@ -0,0 +1,118 @@
+/* ============================================================================
+ * Shuffle Order Tests
+ * The Feistel cycle-walk must be a bijection on [0, N) for every N (each
+ * track exactly once per cycle), position_of() must invert track_at(), and
+ * a step must cost the same whatever the library size.
+ * ========================================================================== */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <cstdio>
+#include <vector>
+#include "shuffle.h"
+#include "config.h"
+#include "native_host.h"
+
+/* 1, 2, primes and 2^k ± 1 around every domain-width change */
+static const uint32_t COUNTS[] = {
+    1, 2, 3, 4, 5, 7, 8, 9, 13, 15, 16, 17, 31, 32, 33, 63, 64, 65, 97,
+    127, 128, 129, 251, 255, 256, 257, 1000, 1021, 1023, 1024, 1025, 4093,
+    4095, 4096, 4097, 10007, 65535, 65536, 65537, (1u << 20) - 1, 1u << 20,
+    (1u << 20) + 1
+};
+static const uint32_t SEEDS[] = {0, SHUFFLE_SEED, 0xFFFFFFFFu};
+
+void setUp() {}
+void tearDown() {}
+
+static void check_bijection(uint32_t count, uint32_t seed, uint32_t cycle) {
+    ShuffleOrder order;
+    order.reset(count, seed);
+    order.set_cycle(cycle);
+    
+    std::vector<bool> seen(count, false);
+    char what[96];
+    for (uint32_t pos = 0; pos < count; pos++) {
+        uint32_t track = order.track_at(pos);
+        snprintf(what, sizeof(what), "N=%u seed=%08x cycle=%u pos=%u", (unsigned)count,
+                 (unsigned)seed, (unsigned)cycle, (unsigned)pos);
+        TEST_ASSERT_TRUE_MESSAGE(track < count, what);
+        TEST_ASSERT_FALSE_MESSAGE(seen[track], what);
+        seen[track] = true;
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(pos, order.position_of(track), what);
+    }
+}
+
+static void test_every_index_once() {
+    for (uint32_t count : COUNTS) {
+        for (uint32_t seed : SEEDS) {
+            check_bijection(count, seed, 0);
+        }
+    }
+}
+
+static void test_every_index_once_across_cycles() {
+    for (uint32_t count : {2u, 3u, 17u, 1000u, 65537u}) {
+        for (uint32_t cycle = 1; cycle < 4; cycle++) {
+            check_bijection(count, SHUFFLE_SEED, cycle);
+        }
+    }
+}
+
+static void test_same_seed_same_order() {
+    ShuffleOrder a, b;
+    a.reset(1000, SHUFFLE_SEED);
+    b.reset(1000, SHUFFLE_SEED);
+    uint32_t moved = 0;
+    for (uint32_t pos = 0; pos < 1000; pos++) {
+        TEST_ASSERT_EQUAL_UINT32(a.track_at(pos), b.track_at(pos));
+        if (a.track_at(pos) != pos) moved++;
+    }
+    TEST_ASSERT_GREATER_THAN(900, moved);   /* Actually shuffled */
+}
+
+/* Average ns per track_at() over the whole range */
+static double ns_per_step(uint32_t count) {
+    ShuffleOrder order;
+    order.reset(count, SHUFFLE_SEED);
+    uint32_t steps = count < 200000 ? 200000 : count;
+    volatile uint32_t sink = 0;
+    
+    uint64_t start = native_time_us();
+    for (uint32_t i = 0; i < steps; i++) {
+        sink += order.track_at(i % count);
+    }
+    (void)sink;
+    return (native_time_us() - start) * 1000.0 / steps;
+}
+
+static void test_step_cost_independent_of_count() {
+    /* Exact even powers of two (no walking) and 4^k + 1 (worst walk ratio) */
+    static const uint32_t exact[] = {16, 256, 4096, 65536, 1u << 20};
+    static const uint32_t worst[] = {17, 257, 4097, 65537, (1u << 20) + 1};
+    char line[96];
+    double exact_ns[5], worst_ns[5];
+    
+    for (uint8_t i = 0; i < 5; i++) {
+        exact_ns[i] = ns_per_step(exact[i]);
+        worst_ns[i] = ns_per_step(worst[i]);
+        snprintf(line, sizeof(line), "N=%-8u %6.1f ns/step   N=%-8u %6.1f ns/step",
+                 (unsigned)exact[i], exact_ns[i], (unsigned)worst[i], worst_ns[i]);
+        TEST_MESSAGE(line);
+    }
+    
+    /* O(1): 65536× more tracks may not cost more than 2× per step */
+    TEST_ASSERT_LESS_THAN(2.0 * exact_ns[0] + 50, exact_ns[4]);
+    TEST_ASSERT_LESS_THAN(2.0 * worst_ns[0] + 50, worst_ns[4]);
+}
+
+void setup() {
+    UNITY_BEGIN();
+    RUN_TEST(test_every_index_once);
+    RUN_TEST(test_every_index_once_across_cycles);
+    RUN_TEST(test_same_seed_same_order);
+    RUN_TEST(test_step_cost_independent_of_count);
+    native_exit(UNITY_END());
+}
+
+void loop() {}
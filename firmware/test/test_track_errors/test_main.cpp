@@ -0,0 +1,138 @@
+/* ============================================================================
+ * Unplayable Track Tests
+ * A playlist entry that names a missing file, or a file with no MPEG frame
+ * in it, must fail to open: the decoder is left closed and the player goes
+ * to STATE_ERROR instead of "playing" a dead track. A good track opened
+ * afterwards plays normally.
+ * ========================================================================== */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include "playback_control.h"
+#include "audio_decoder.h"
+#include "playlist.h"
+#include "sd_card.h"
+#include "config.h"
+#include "native_host.h"
+
+extern AudioDecoder* create_audio_decoder();
+extern SDCard* create_sd_card();
+
+static const uint32_t FRAME_BYTES = 384;   /* 128 kbps at 48 kHz, no padding */
+static const uint32_t FRAMES = 250;        /* 6 s */
+
+static std::string scratch;
+static PlaybackController* playback;
+
+static bool write_file(const char* volume_path, const void* data, size_t len) {
+    FILE* f = fopen(("sdcard" + std::string(volume_path)).c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(data, 1, len, f) == len;
+    return fclose(f) == 0 && ok;
+}
+
+static bool write_text(const char* volume_path, const std::string& text) {
+    return write_file(volume_path, text.data(), text.size());
+}
+
+/* Scratch dir holding the card (NATIVE_SD_ROOT), NVS and display.pbm */
+static bool make_card() {
+    char dir[] = "/tmp/test_track_errors_XXXXXX";
+    if (!mkdtemp(dir) || chdir(dir) != 0) return false;
+    scratch = dir;
+    setenv("NATIVE_SD_ROOT", (scratch + "/sdcard").c_str(), 1);
+    if (system("mkdir -p sdcard nvs") != 0) return false;
+    
+    /* Garbage: text with no sync word anywhere */
+    std::string garbage(8192, 'x');
+    
+    std::string good;
+    uint8_t frame[FRAME_BYTES] = {0xFF, 0xFB, 0x94, 0x00};   /* MPEG-1 L3, stereo */
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        good.append((const char*)frame, sizeof(frame));
+    }
+    
+    return write_text("/garbage.mp3", garbage) &&
+           write_text("/good.mp3", good) &&
+           write_text("/missing.m3u", "#EXTM3U\r\nnot_there.mp3\r\ngood.mp3\r\n") &&
+           write_text("/garbage.m3u", "#EXTM3U\r\ngarbage.mp3\r\ngood.mp3\r\n") &&
+           write_text("/good.m3u", "#EXTM3U\r\ngood.mp3\r\n");
+}
+
+/* Open `list` and hand it to the idle player as the library */
+static void use_playlist(const char* list) {
+    Playlist* pls = create_playlist();
+    TEST_ASSERT_TRUE(pls->open(list));
+    playback->set_library(pls->get_count(), true);
+}
+
+void setUp() {}
+
+void tearDown() {
+    playback->execute_command(CMD_STOP);
+}
+
+static void test_decoder_refuses_missing_and_garbage() {
+    AudioDecoder* decoder = create_audio_decoder();
+    int16_t pcm[AUDIO_PCM_FRAME_SAMPLES];
+    
+    TEST_ASSERT_FALSE(decoder->open("/not_there.mp3"));
+    TEST_ASSERT_EQUAL_INT(-1, decoder->decode_frame(pcm, AUDIO_PCM_FRAME_SAMPLES));
+    
+    TEST_ASSERT_FALSE(decoder->open("/garbage.mp3"));
+    TEST_ASSERT_EQUAL_INT(-1, decoder->decode_frame(pcm, AUDIO_PCM_FRAME_SAMPLES));
+    TEST_ASSERT_FALSE(decoder->seek(1000));
+    TEST_ASSERT_EQUAL_UINT32(0, decoder->get_sample_rate());
+    
+    /* A failed open leaves nothing behind that spoils the next one */
+    TEST_ASSERT_TRUE(decoder->open("/good.mp3"));
+    TEST_ASSERT_EQUAL_UINT32(48000, decoder->get_sample_rate());
+    TEST_ASSERT_TRUE(decoder->decode_frame(pcm, AUDIO_PCM_FRAME_SAMPLES) > 0);
+    decoder->close();
+}
+
+static void test_missing_entry_is_an_error() {
+    use_playlist("/missing.m3u");
+    playback->execute_command(CMD_TOGGLE_PLAY_PAUSE);
+    TEST_ASSERT_EQUAL(STATE_ERROR, playback->get_state());
+}
+
+static void test_garbage_entry_is_an_error() {
+    use_playlist("/garbage.m3u");
+    playback->execute_command(CMD_TOGGLE_PLAY_PAUSE);
+    TEST_ASSERT_EQUAL(STATE_ERROR, playback->get_state());
+    TEST_ASSERT_EQUAL_UINT32(0, playback->get_total_duration_ms());
+}
+
+static void test_good_entry_plays_after_errors() {
+    use_playlist("/good.m3u");
+    playback->execute_command(CMD_TOGGLE_PLAY_PAUSE);
+    TEST_ASSERT_EQUAL(STATE_PLAYING, playback->get_state());
+    TEST_ASSERT_UINT32_WITHIN(24, FRAMES * 24, playback->get_total_duration_ms());
+}
+
+void setup() {
+    if (!make_card() || !create_sd_card()->init()) {
+        printf("cannot create the scratch card\n");
+        native_exit(1);
+    }
+    playback = create_playback_controller();
+    if (!playback->init()) native_exit(1);
+    
+    UNITY_BEGIN();
+    RUN_TEST(test_decoder_refuses_missing_and_garbage);
+    RUN_TEST(test_missing_entry_is_an_error);
+    RUN_TEST(test_garbage_entry_is_an_error);
+    RUN_TEST(test_good_entry_plays_after_errors);
+    int status = UNITY_END();
+    
+    std::string cleanup = "rm -rf " + scratch;
+    (void)system(cleanup.c_str());
+    native_exit(status);
+}
+
+void loop() {}
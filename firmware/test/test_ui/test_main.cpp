@@ -0,0 +1,224 @@
+/* ============================================================================
+ * Retained-Mode UI Tests
+ * A render() repaints exactly the widgets whose bound value changed, and
+ * an idle render puts nothing on the bus. Player state changes only mark
+ * the state widget; drawing waits for the refresh tick. The display is not
+ * init()'ed, so each render() flushes synchronously before returning.
+ * ========================================================================== */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <Wire.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include "ui.h"
+#include "playback_control.h"
+#include "config.h"
+#include "native_host.h"
+
+static UI* ui;
+
+/* Widgets drawn and I2C bytes sent by one render() */
+struct Frame {
+    UIFrameStats stats;
+    uint32_t i2c_bytes;
+};
+
+static Frame render() {
+    NativeI2CStats before = native_i2c_stats();
+    ui->render();
+    Frame f;
+    f.stats = ui->get_frame_stats();
+    f.i2c_bytes = native_i2c_stats().bytes - before.bytes;
+    return f;
+}
+
+void setUp() {
+    render();   /* Settle whatever the previous test left dirty */
+}
+
+void tearDown() {}
+
+static void test_first_render_paints_layout() {
+    /* Runs first: init() invalidated everything but the overlays */
+    TEST_ASSERT_TRUE(ui->init());
+    Frame f = render();
+    TEST_ASSERT_EQUAL_UINT8(7, f.stats.widgets_drawn);
+    TEST_ASSERT_GREATER_THAN(0, f.i2c_bytes);
+}
+
+static void test_idle_render_draws_nothing() {
+    for (int i = 0; i < 5; i++) {
+        Frame f = render();
+        TEST_ASSERT_EQUAL_UINT8(0, f.stats.widgets_drawn);
+        TEST_ASSERT_EQUAL_UINT16(0, f.stats.pixels_touched);
+        TEST_ASSERT_EQUAL_UINT32(0, f.i2c_bytes);
+    }
+}
+
+static void test_progress_repaints_on_pixel_change_only() {
+    ui->update_progress(0, 128000);
+    render();
+    
+    /* 1 px of bar per 1000 ms: 400 ms later the bar has not grown */
+    ui->update_progress(400, 128000);
+    TEST_ASSERT_EQUAL_UINT8(0, render().stats.widgets_drawn);
+    
+    ui->update_progress(5000, 128000);
+    Frame f = render();
+    TEST_ASSERT_EQUAL_UINT8(1, f.stats.widgets_drawn);
+    TEST_ASSERT_EQUAL_UINT16(DISPLAY_WIDTH * 4, f.stats.pixels_touched);
+    
+    /* Only the newly filled columns reach the panel */
+    TEST_ASSERT_LESS_THAN(60, f.i2c_bytes);
+}
+
+static void test_volume_repaints_on_bar_change_only() {
+    ui->update_volume(80);
+    render();
+    
+    ui->update_volume(85);
+    TEST_ASSERT_EQUAL_UINT8(0, render().stats.widgets_drawn);
+    
+    ui->update_volume(30);
+    Frame f = render();
+    TEST_ASSERT_EQUAL_UINT8(1, f.stats.widgets_drawn);
+    TEST_ASSERT_EQUAL_UINT16(18 * 8, f.stats.pixels_touched);
+    
+    /* Muted: no bars, still a repaint */
+    ui->update_volume(0);
+    TEST_ASSERT_EQUAL_UINT8(1, render().stats.widgets_drawn);
+}
+
+static void test_each_binding_touches_its_widget() {
+    ui->update_playback_state(UI_STATE_PLAYING);
+    Frame f = render();
+    TEST_ASSERT_EQUAL_UINT8(1, f.stats.widgets_drawn);
+    TEST_ASSERT_EQUAL_UINT16(6 * 6, f.stats.pixels_touched);
+    
+    ui->update_playback_state(UI_STATE_PLAYING);
+    TEST_ASSERT_EQUAL_UINT8(0, render().stats.widgets_drawn);
+    
+    /* Same title, new artist: artist row only */
+    ui->update_track_info("No Track", "Someone");
+    f = render();
+    TEST_ASSERT_EQUAL_UINT8(1, f.stats.widgets_drawn);
+    TEST_ASSERT_EQUAL_UINT16(DISPLAY_WIDTH * 8, f.stats.pixels_touched);
+    
+    ui->update_track_info("Short", "Someone");
+    f = render();
+    TEST_ASSERT_EQUAL_UINT8(1, f.stats.widgets_drawn);
+    TEST_ASSERT_EQUAL_UINT16(118 * 8, f.stats.pixels_touched);
+}
+
+static void test_toast_defers_covered_widgets() {
+    ui->show_info("Connected");
+    Frame f = render();
+    TEST_ASSERT_EQUAL_UINT8(1, f.stats.widgets_drawn);
+    
+    /* Title sits under the toast: it waits, state icon does not */
+    ui->update_track_info("Another", nullptr);
+    ui->update_playback_state(UI_STATE_PAUSED);
+    f = render();
+    TEST_ASSERT_EQUAL_UINT8(1, f.stats.widgets_drawn);
+    TEST_ASSERT_EQUAL_UINT16(6 * 6, f.stats.pixels_touched);
+    
+    /* Expiry repaints everything the toast covered (title, state, frame) */
+    delay(2100);
+    f = render();
+    TEST_ASSERT_GREATER_OR_EQUAL(2, f.stats.widgets_drawn);
+    TEST_ASSERT_EQUAL_UINT8(0, render().stats.widgets_drawn);
+}
+
+/* Marquee: hold 15 frames, step 2 px per render, wrap, hold again */
+static void test_marquee_timing() {
+    const char* title = "A Title Far Too Long For The Box";   /* 32 chars */
+    const uint16_t strip = 32 * 6 + 24;                       /* + gap */
+    const uint16_t steps = strip / 2;
+    
+    /* New title: painted at its start, which is the first hold frame */
+    ui->update_track_info(title, nullptr);
+    Frame f = render();
+    TEST_ASSERT_EQUAL_UINT8(1, f.stats.widgets_drawn);
+    
+    for (int pass = 0; pass < 2; pass++) {
+        /* Hold at the start position */
+        for (int i = (pass == 0) ? 1 : 0; i < 15; i++) {
+            TEST_ASSERT_EQUAL_UINT8_MESSAGE(0, render().stats.widgets_drawn, "hold");
+        }
+        
+        /* Every render scrolls; the last step wraps back to the start */
+        for (uint16_t i = 0; i < steps; i++) {
+            f = render();
+            TEST_ASSERT_EQUAL_UINT8_MESSAGE(1, f.stats.widgets_drawn, "scroll");
+            TEST_ASSERT_EQUAL_UINT16(118 * 8, f.stats.pixels_touched);
+            
+            /* One page of the title box at most: window + 116 columns */
+            TEST_ASSERT_LESS_OR_EQUAL(8 + 2 + 116, f.i2c_bytes);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT8(0, render().stats.widgets_drawn);
+    
+    char line[96];
+    snprintf(line, sizeof(line), "marquee pass: 15 hold + %u scroll frames = %.1f s at %d Hz",
+             (unsigned)steps, (15 + steps) / (float)DISPLAY_REFRESH_HZ, DISPLAY_REFRESH_HZ);
+    TEST_MESSAGE(line);
+    
+    /* A title that fits stays put */
+    ui->update_track_info("Short", nullptr);
+    render();
+    for (int i = 0; i < 40; i++) {
+        TEST_ASSERT_EQUAL_UINT8(0, render().stats.widgets_drawn);
+    }
+}
+
+/* Transitions must not render: extra frames would speed up the marquee */
+static void test_state_changes_wait_for_refresh_tick() {
+    PlaybackController* playback = create_playback_controller();
+    TEST_ASSERT_TRUE(playback->init());
+    render();
+    
+    /* No card: PLAY goes IDLE → LOADING → ERROR, STOP back to IDLE */
+    NativeI2CStats before = native_i2c_stats();
+    for (int i = 0; i < 5; i++) {
+        playback->execute_command(CMD_TOGGLE_PLAY_PAUSE);
+        TEST_ASSERT_EQUAL(STATE_ERROR, playback->get_state());
+        playback->execute_command(CMD_STOP);
+    }
+    TEST_ASSERT_EQUAL_UINT32(before.transmissions, native_i2c_stats().transmissions);
+    
+    /* The next tick draws the state widget once */
+    TEST_ASSERT_EQUAL_UINT8(1, render().stats.widgets_drawn);
+    TEST_ASSERT_EQUAL_UINT8(0, render().stats.widgets_drawn);
+}
+
+void setup() {
+    /* Scratch working directory: the panel fake drops display.pbm there */
+    char dir[] = "/tmp/test_ui_XXXXXX";
+    if (!mkdtemp(dir) || chdir(dir) != 0) {
+        printf("cannot create the scratch directory\n");
+        native_exit(1);
+    }
+    
+    Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN, I2C_FREQ * 1000);
+    ui = create_ui();
+    
+    UNITY_BEGIN();
+    RUN_TEST(test_first_render_paints_layout);
+    RUN_TEST(test_idle_render_draws_nothing);
+    RUN_TEST(test_progress_repaints_on_pixel_change_only);
+    RUN_TEST(test_volume_repaints_on_bar_change_only);
+    RUN_TEST(test_each_binding_touches_its_widget);
+    RUN_TEST(test_toast_defers_covered_widgets);
+    RUN_TEST(test_marquee_timing);
+    RUN_TEST(test_state_changes_wait_for_refresh_tick);
+    int status = UNITY_END();
+    
+    std::string cleanup = std::string("rm -rf ") + dir;
+    (void)system(cleanup.c_str());
+    native_exit(status);
+}
+
+void loop() {}
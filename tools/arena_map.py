@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""
+Print the audio arena map (firmware/include/audio_arena.h) of a build.
+
+audio_arena.cpp records every slice's offset, size and alignment in the
+.audio_arena_map ELF section, which is never loaded onto the chip. This
+reads it back and shows the layout against AUDIO_ARENA_BUDGET:
+
+    python3 tools/arena_map.py firmware/.pio/build/esp32-dev/firmware.elf
+
+It also runs as a PlatformIO post-link script (see platformio.ini), so
+every build prints the map. The budgets themselves are enforced by
+static_assert; this is the report, not the check.
+"""
+
+import struct
+import sys
+
+SECTION = b".audio_arena_map"
+RECORD = struct.Struct("<III")   # offset, size, align
+RING = "bt_ring"                 # Outside AUDIO_ARENA_WORK_BUDGET
+
+
+def read_section(path, wanted):
+    """Raw contents of a named section of a little-endian ELF32/ELF64 file."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"\x7fELF" or data[5] != 1:
+        raise ValueError("%s is not a little-endian ELF file" % path)
+    if data[4] == 1:
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+        header = "<II8xII"              # name, type, (flags, addr), offset, size
+    else:
+        shoff, = struct.unpack_from("<Q", data, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x3A)
+        header = "<II16xQQ"
+    sections = [struct.unpack_from(header, data, shoff + i * shentsize) for i in range(shnum)]
+    names = sections[shstrndx][2]
+    for name, _, offset, size in sections:
+        if data[names + name:names + name + len(wanted) + 1] == wanted + b"\x00":
+            return data[offset:offset + size]
+    return None
+
+
+def parse(raw):
+    records = []
+    pos = 0
+    while pos + RECORD.size < len(raw):
+        offset, size, align = RECORD.unpack_from(raw, pos)
+        end = raw.index(b"\x00", pos + RECORD.size)
+        records.append((raw[pos + RECORD.size:end].decode(), offset, size, align))
+        pos = (end + 1 + 3) & ~3
+    return records
+
+
+def report(path, out=sys.stdout):
+    raw = read_section(path, SECTION)
+    if raw is None:
+        out.write("Audio arena map: no %s section in %s\n" % (SECTION.decode(), path))
+        return False
+    records = parse(raw)
+    slices = [r for r in records if not r[0].startswith("(")]
+    totals = {r[0]: r[2] for r in records if r[0].startswith("(")}
+    arena, budget, work_budget = totals["(arena)"], totals["(budget)"], totals["(work-budget)"]
+    ring = sum(r[2] for r in slices if r[0] == RING)
+
+    out.write("Audio arena map (%s)\n" % path)
+    out.write("  %-8s %8s %6s  %s\n" % ("offset", "bytes", "align", "slice"))
+    for name, offset, size, align in slices:
+        out.write("  0x%06x %8d %6d  %s\n" % (offset, size, align, name))
+    used = sum(r[2] for r in slices)
+    out.write("  total %d / %d B (%d%%), padding %d B; working buffers %d / %d B\n" % (
+        arena, budget, 100 * arena // budget, arena - used, arena - ring, work_budget))
+    return True
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("usage: %s firmware.elf" % sys.argv[0])
+    sys.exit(0 if report(sys.argv[1]) else 1)
+
+
+try:
+    Import("env")  # noqa: F821 - PlatformIO extra script
+except NameError:
+    env = None
+
+if env is not None:
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}${PROGSUFFIX}",
+                      lambda target, source, env: report(str(target[0])) and None)
+elif __name__ == "__main__":
+    main()
@@ -0,0 +1,332 @@
+#!/usr/bin/env python3
+"""
+Decoder conformance and throughput bench: corpus, runner and verdicts.
+
+Builds a card image with an MP3 corpus and reference PCM, runs the
+decoder bench sketch (firmware/bench/decoder_bench.cpp) on it, and
+grades every file:
+
+    cd firmware && pio run -e native_decoder_bench && cd ..
+    python3 tools/decoder_bench.py -o decoder.json
+
+On the device, copy <card>/corpus to the SD card, flash the
+`decoder_bench` environment and grade the serial capture instead:
+
+    python3 tools/decoder_bench.py --make-card card/
+    python3 tools/decoder_bench.py --capture monitor.log --card card/
+
+The generated corpus covers MPEG-1 CBR (stereo, joint stereo, mono),
+VBR, MPEG-2 mono, an ID3v2 tag hiding a false sync word, bit-reservoir
+use (main_data_begin at its maximum) and three kinds of corrupt frames.
+Frames carry empty side information, which every Layer III decoder
+renders as digital silence, so the reference PCM is exact without an
+encoder. A silent reference only checks the frame walk (frame count,
+output length, timing): a decoder that outputs zeros matches it too, so
+those files are reported as "frame walk only", never graded. Real
+recordings can be added as <name>.mp3 plus <name>.pcm (s16le, stereo, at
+the file's rate, e.g. from a reference decoder:
+`ffmpeg -i x.mp3 -f s16le -ac 2 x.pcm`); they are what gets graded.
+
+Accuracy follows ISO/IEC 11172-4: "full" when the RMS error is below
+2^-15/sqrt(12) of full scale and no sample differs by more than 2^-14,
+"limited" when the RMS error is below 2^-11/sqrt(12). When the bench
+reports a decoder without synthesis (the placeholder), nothing is graded
+and a warning is printed. Worst frame time
+is compared with the frame's play time: above it the pump underruns.
+Frame times and stack peak are only meaningful from the device; the host
+build scales its stack figure (see native_freertos.cpp).
+"""
+
+import argparse
+import json
+import math
+import os
+import random
+import signal
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_PROGRAM = os.path.join(ROOT, "firmware", ".pio", "build", "native_decoder_bench", "program")
+DEFAULT_CARD = os.path.join(ROOT, "firmware", ".pio", "decoder_card")
+
+OUT_CHANNELS = 2          # AUDIO_CHANNELS: decoder output is interleaved stereo
+SECONDS = 3
+
+# ISO/IEC 11172-4 limits in 16-bit LSBs (1 LSB = 2^-15 of full scale)
+FULL_RMS_LSB = 1 / math.sqrt(12)
+FULL_MAX_LSB = 2
+LIMITED_RMS_LSB = 16 / math.sqrt(12)
+
+BITRATES = {1: [0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320],
+            2: [0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160]}
+RATES = {1: [44100, 48000, 32000], 2: [22050, 24000, 16000]}
+MODE_STEREO, MODE_JOINT, MODE_MONO = 0, 1, 3
+
+
+class Stream:
+    """Layer III frames with empty side info (decode to silence)."""
+
+    def __init__(self, version, rate_idx, mode, mode_ext=0):
+        self.version = version
+        self.rate_idx = rate_idx
+        self.rate = RATES[version][rate_idx]
+        self.mode = mode
+        self.mode_ext = mode_ext
+        self.spf = 1152 if version == 1 else 576
+        mono = mode == MODE_MONO
+        self.side_len = (17 if mono else 32) if version == 1 else (9 if mono else 17)
+        self.frac = 0.0
+        self.reservoir = 0
+
+    def frame(self, br_idx, reservoir=False):
+        kbps = BITRATES[self.version][br_idx]
+        exact = (144000 if self.version == 1 else 72000) * kbps / self.rate
+        base = int(exact)
+        self.frac += exact - base
+        pad = 1 if self.frac >= 1 else 0
+        self.frac -= pad
+        length = base + pad
+
+        b1 = 0xE0 | ((3 if self.version == 1 else 2) << 3) | (1 << 1) | 1   # Layer III, no CRC
+        b2 = (br_idx << 4) | (self.rate_idx << 2) | (pad << 1)
+        b3 = (self.mode << 6) | (self.mode_ext << 4)
+        side = bytearray(self.side_len)
+        if reservoir:
+            # main_data_begin: 9 bits (MPEG-1) or 8 bits (MPEG-2), bounded by what came before
+            limit = 511 if self.version == 1 else 255
+            begin = min(limit, self.reservoir)
+            if self.version == 1:
+                side[0], side[1] = begin >> 1, (begin & 1) << 7
+            else:
+                side[0] = begin
+        main = length - 4 - self.side_len
+        self.reservoir += main
+        return bytes([0xFF, b1, b2, b3]) + bytes(side) + bytes(main)
+
+    def frames_for(self, seconds):
+        return int(seconds * self.rate / self.spf)
+
+    def silence(self, frames):
+        return bytes(frames * self.spf * OUT_CHANNELS * 2)
+
+
+def id3_tag(size, rng):
+    """ID3v2 header plus a body that contains a plausible-looking sync word."""
+    body = bytearray(rng.randrange(256) for _ in range(size))
+    body[100:104] = bytes([0xFF, 0xFB, 0x90, 0x00])
+    syncsafe = bytes([(size >> 21) & 0x7F, (size >> 14) & 0x7F, (size >> 7) & 0x7F, size & 0x7F])
+    return b"ID3\x04\x00\x00" + syncsafe + bytes(body)
+
+
+def make_corpus(out_dir):
+    """Write <out_dir>/*.mp3 + *.pcm and manifest.json; returns the manifest."""
+    os.makedirs(out_dir, exist_ok=True)
+    rng = random.Random(11172)
+    manifest = {}
+
+    def emit(name, data, pcm, frames, what):
+        with open(os.path.join(out_dir, name + ".mp3"), "wb") as f:
+            f.write(data)
+        with open(os.path.join(out_dir, name + ".pcm"), "wb") as f:
+            f.write(pcm)
+        manifest[name + ".mp3"] = {"frames": frames, "covers": what}
+
+    def plain(name, version, rate_idx, mode, br_idx, what, mode_ext=0, reservoir=False, prefix=b""):
+        s = Stream(version, rate_idx, mode, mode_ext)
+        n = s.frames_for(SECONDS)
+        data = prefix + b"".join(s.frame(br_idx, reservoir and i > 0) for i in range(n))
+        emit(name, data, s.silence(n), n, what)
+
+    plain("cbr128_stereo", 1, 0, MODE_STEREO, 9, "MPEG-1 CBR 128 kbps stereo, 44.1 kHz")
+    plain("cbr320_joint", 1, 0, MODE_JOINT, 14, "MPEG-1 CBR 320 kbps joint stereo (MS+IS)", mode_ext=3)
+    plain("cbr96_mono48", 1, 1, MODE_MONO, 7, "MPEG-1 CBR 96 kbps mono, 48 kHz")
+    plain("mpeg2_mono22", 2, 0, MODE_MONO, 8, "MPEG-2 LSF 64 kbps mono, 22.05 kHz")
+    plain("reservoir", 1, 0, MODE_JOINT, 9, "main_data_begin at its maximum every frame",
+          mode_ext=2, reservoir=True)
+    plain("id3_false_sync", 1, 0, MODE_STEREO, 9, "4 KB ID3v2 tag containing a sync word",
+          prefix=id3_tag(4096, rng))
+
+    s = Stream(1, 0, MODE_JOINT, 2)
+    n = s.frames_for(SECONDS)
+    data = b"".join(s.frame(rng.randrange(1, 15)) for _ in range(n))
+    emit("vbr_random", data, s.silence(n), n, "VBR, bitrate index random per frame (no Xing TOC)")
+
+    # Damage: garbage between frames (nothing lost), broken headers and
+    # truncated frames (those frames are lost; the reference omits them)
+    s = Stream(1, 0, MODE_STEREO)
+    n = s.frames_for(SECONDS)
+    data = bytearray()
+    for i in range(n):
+        data += s.frame(9)
+        if i % 20 == 10:
+            data += bytes(rng.randrange(256) for _ in range(rng.randrange(50, 400)))
+    emit("corrupt_garbage", bytes(data), s.silence(n), n, "random bytes between frames")
+
+    s = Stream(1, 0, MODE_STEREO)
+    n = s.frames_for(SECONDS)
+    data, lost = bytearray(), 0
+    for i in range(n):
+        frame = bytearray(s.frame(9))
+        if i % 25 == 12:
+            frame[2] |= 0xF0      # Bitrate index 15: invalid header
+            lost += 1
+        data += frame
+    emit("corrupt_header", bytes(data), s.silence(n - lost), n - lost, "invalid headers (frame dropped)")
+
+    s = Stream(1, 0, MODE_STEREO)
+    n = s.frames_for(SECONDS)
+    data, lost = bytearray(), 0
+    for i in range(n):
+        frame = s.frame(9)
+        if i % 25 == 7:
+            frame = frame[:len(frame) // 2]
+            lost += 1
+        data += frame
+    emit("corrupt_truncated", bytes(data), s.silence(n - lost), n - lost, "truncated frames (frame dropped)")
+
+    with open(os.path.join(out_dir, "manifest.json"), "w") as f:
+        json.dump(manifest, f, indent=2)
+    return manifest
+
+
+def run_host(program, card):
+    env = dict(os.environ, NATIVE_SD_ROOT=card, NATIVE_NVS_DIR=os.path.join(card, ".nvs"))
+    proc = subprocess.Popen([program], env=env, cwd=card, stdout=subprocess.PIPE,
+                            stderr=subprocess.DEVNULL, universal_newlines=True)
+    lines = []
+    try:
+        for line in proc.stdout:
+            lines.append(line)
+            if line.startswith("BENCH_END"):
+                break
+    finally:
+        proc.send_signal(signal.SIGTERM)
+        proc.wait(timeout=30)
+    return lines
+
+
+def parse(lines):
+    inside, records = False, []
+    for line in lines:
+        line = line.strip()
+        if line == "BENCH_BEGIN":
+            inside, records = True, []
+        elif line == "BENCH_END":
+            inside = False
+        elif line.startswith("BENCH_ERROR"):
+            sys.exit(line)
+        elif inside and line.startswith("{"):
+            records.append(json.loads(line))
+    if not records:
+        sys.exit("no BENCH_BEGIN/BENCH_END block found")
+    return records[0], records[1:]
+
+
+def silent_reference(corpus, name):
+    """True when <name>.pcm exists and is all zeros (None: not on this card)."""
+    path = os.path.join(corpus, name[:-4] + ".pcm")
+    if not os.path.exists(path):
+        return None
+    with open(path, "rb") as f:
+        return not f.read().strip(b"\0")
+
+
+def grade(rec, expected, rate, synthesis, silent):
+    frame_us = 1e6 * (1152 if rate >= 32000 else 576) / rate if rate else None
+    out = dict(rec)
+    if rec.get("ref_samples") is None:
+        out["accuracy"] = "no reference"
+    elif rec["samples"] != rec["ref_samples"]:
+        out["accuracy"] = "fail (length %+d samples)" % (rec["samples"] - rec["ref_samples"])
+    elif silent is None:
+        out["accuracy"] = "not graded (reference not in --card)"
+    elif silent:
+        out["accuracy"] = "frame walk only"
+    elif not synthesis:
+        out["accuracy"] = "not graded (no synthesis)"
+    elif rec["rms_lsb"] < FULL_RMS_LSB and rec["max_abs_lsb"] <= FULL_MAX_LSB:
+        out["accuracy"] = "full"
+    elif rec["rms_lsb"] < LIMITED_RMS_LSB:
+        out["accuracy"] = "limited"
+    else:
+        out["accuracy"] = "fail"
+    if expected:
+        out["expected_frames"] = expected["frames"]
+        out["covers"] = expected["covers"]
+    if frame_us:
+        out["frame_budget_us"] = round(frame_us, 1)
+        out["worst_frame_load"] = round(rec["worst_frame_us"] / frame_us, 4)
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--program", default=DEFAULT_PROGRAM, help="host bench build (default: %(default)s)")
+    parser.add_argument("--capture", help="grade a device serial capture instead of running the host build")
+    parser.add_argument("--card", default=DEFAULT_CARD, help="card image directory (default: %(default)s)")
+    parser.add_argument("--make-card", metavar="DIR", help="only write the corpus card image to DIR")
+    parser.add_argument("-o", "--output", help="JSON report (default: stdout)")
+    args = parser.parse_args()
+
+    if args.make_card:
+        make_corpus(os.path.join(args.make_card, "corpus"))
+        return
+
+    corpus = os.path.join(args.card, "corpus")
+    manifest_path = os.path.join(corpus, "manifest.json")
+    if os.path.exists(manifest_path):
+        with open(manifest_path) as f:
+            manifest = json.load(f)
+    else:
+        manifest = make_corpus(corpus)
+
+    if args.capture:
+        with open(args.capture, errors="replace") as f:
+            lines = f.readlines()
+    else:
+        if not os.access(args.program, os.X_OK):
+            sys.exit("%s not found; build it with `pio run -e native_decoder_bench` in firmware/" % args.program)
+        lines = run_host(os.path.abspath(args.program), os.path.abspath(args.card))
+
+    header, records = parse(lines)
+    synthesis = header.get("synthesis", True)
+    if not synthesis:
+        sys.stderr.write("warning: the decoder under test has no synthesis (output is silence); "
+                         "accuracy is not graded, only the frame walk\n")
+    files = []
+    for rec in sorted(records, key=lambda r: r["file"]):
+        # Output rate from samples and play time (stereo output)
+        rate = round(rec["samples"] / OUT_CHANNELS * 1000 / rec["audio_ms"] / 50) * 50 if rec["audio_ms"] else 0
+        files.append(grade(rec, manifest.get(rec["file"]), rate, synthesis,
+                           silent_reference(corpus, rec["file"])))
+
+    decoded = [f for f in files if f["frames"]]
+    report = {
+        "schema": 1,
+        "cpu_mhz": header["cpu_mhz"],
+        "decoder_synthesis": synthesis,
+        "summary": {
+            "files": len(files),
+            "accuracy": {k: sum(1 for f in files if f["accuracy"].startswith(k))
+                         for k in ("full", "limited", "fail", "frame walk only", "not graded")},
+            "frame_count_mismatches": [f["file"] for f in files
+                                       if "expected_frames" in f and f["frames"] != f["expected_frames"]],
+            "min_frames_per_s": min((f["frames_per_s"] for f in decoded), default=0),
+            "worst_frame_us": max((f["worst_frame_us"] for f in files), default=0),
+            "worst_frame_load": max((f.get("worst_frame_load", 0) for f in files), default=0),
+            "stack_peak_bytes": max((f["stack_peak_bytes"] for f in files), default=0),
+            "stack_budget_bytes": header["stack_budget_bytes"],
+        },
+        "files": files,
+    }
+    text = json.dumps(report, indent=2) + "\n"
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()
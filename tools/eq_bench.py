@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""
+Equalizer bench: runner and verdicts.
+
+Runs the equalizer bench sketch (firmware/bench/eq_bench.cpp) and
+summarises it:
+
+    cd firmware && pio run -e native_eq_bench && cd ..
+    python3 tools/eq_bench.py -o eq.json
+
+On the device, flash the `eq_bench` environment and summarise the serial
+capture instead:
+
+    python3 tools/eq_bench.py --capture monitor.log
+
+The sketch times process() with 0..EQ_BANDS bands active; this script
+derives the cost per band. Frequency response, presets and click-free
+changes are checked by the host tests (`pio test -e native_test -f
+test_equalizer`), not here. The equalizer fits when all bands together stay within
+EQ_CPU_BUDGET_PCT of a frame's play time and, given the decoder's average
+frame time (`--decode-us`, from tools/decoder_bench.py on the same
+target), within the headroom the decoder leaves. Cost figures are only
+meaningful from the device.
+"""
+
+import argparse
+import json
+import os
+import signal
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_PROGRAM = os.path.join(ROOT, "firmware", ".pio", "build", "native_eq_bench", "program")
+
+
+def run_host(program):
+    with tempfile.TemporaryDirectory() as scratch:
+        proc = subprocess.Popen([program], cwd=scratch, stdout=subprocess.PIPE,
+                                stderr=subprocess.DEVNULL, universal_newlines=True)
+        lines = []
+        try:
+            for line in proc.stdout:
+                lines.append(line)
+                if line.startswith("BENCH_END"):
+                    break
+        finally:
+            proc.send_signal(signal.SIGTERM)
+            proc.wait(timeout=30)
+    return lines
+
+
+def parse(lines):
+    inside, records = False, []
+    for line in lines:
+        line = line.strip()
+        if line == "BENCH_BEGIN":
+            inside, records = True, []
+        elif line == "BENCH_END":
+            inside = False
+        elif line.startswith("BENCH_ERROR"):
+            sys.exit(line)
+        elif inside and line.startswith("{"):
+            records.append(json.loads(line))
+    if not records:
+        sys.exit("no BENCH_BEGIN/BENCH_END block found")
+    return records[0], records[1:]
+
+
+def summarise_cost(header, cost, decode_us):
+    cost = sorted(cost, key=lambda r: r["bands"])
+    base, full = cost[0], cost[-1]
+    per_band = (full["avg_us"] - base["avg_us"]) / full["bands"] if full["bands"] else 0
+    frame_us = header["frame_us"]
+    out = {
+        "frame_us": frame_us,
+        "avg_us_per_band": round(per_band, 2),
+        "bypass_avg_us": base["avg_us"],
+        "all_bands_avg_us": full["avg_us"],
+        "all_bands_worst_us": full["worst_us"],
+        "all_bands_worst_load_pct": round(100 * full["worst_us"] / frame_us, 3),
+        "budget_pct": header["budget_pct"],
+        "within_budget": 100 * full["worst_us"] / frame_us <= header["budget_pct"],
+        "by_bands": cost,
+    }
+    if decode_us is not None:
+        headroom = frame_us - decode_us
+        out["decode_avg_us"] = decode_us
+        out["decode_headroom_us"] = round(headroom, 1)
+        out["headroom_used_pct"] = round(100 * full["worst_us"] / headroom, 2) if headroom > 0 else None
+        out["within_headroom"] = headroom > 0 and full["worst_us"] <= headroom
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--program", default=DEFAULT_PROGRAM, help="host bench build (default: %(default)s)")
+    parser.add_argument("--capture", help="summarise a device serial capture instead of running the host build")
+    parser.add_argument("--decode-us", type=float, help="decoder average frame time on the same target")
+    parser.add_argument("-o", "--output", help="JSON report (default: stdout)")
+    args = parser.parse_args()
+
+    if args.capture:
+        with open(args.capture, errors="replace") as f:
+            lines = f.readlines()
+    else:
+        if not os.access(args.program, os.X_OK):
+            sys.exit("%s not found; build it with `pio run -e native_eq_bench` in firmware/" % args.program)
+        lines = run_host(os.path.abspath(args.program))
+
+    header, records = parse(lines)
+    by_kind = {}
+    for rec in records:
+        by_kind.setdefault(rec["kind"], []).append(rec)
+
+    cost = summarise_cost(header, by_kind.get("cost", []), args.decode_us)
+    ok = cost["within_budget"] and cost.get("within_headroom", True)
+
+    report = {
+        "schema": 2,
+        "cpu_mhz": header["cpu_mhz"],
+        "sample_rate": header["sample_rate"],
+        "bands": header["bands"],
+        "block_frames": header["block_frames"],
+        "ramp_ms": header["ramp_ms"],
+        "ok": ok,
+        "cost": cost,
+    }
+    text = json.dumps(report, indent=2) + "\n"
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,282 @@
+#!/usr/bin/env python3
+"""
+End-to-end latency benchmark on the native host build.
+
+Runs the unmodified firmware (setup(), PlaybackController, UI) from the
+`native` PlatformIO environment with scripted button presses, simulated
+SD and Bluetooth timing, and reports what a listener would feel:
+
+    time_to_first_audio  power-on → first audio, PLAY pressed when ready
+    next_to_audio        NEXT pressed → next track audible
+    pause_to_silence     PLAY pressed while playing → silence
+    resume_to_audio      PLAY pressed while paused → audible again
+    seek_to_audio        NEXT held past BTN_LONG_PRESS_MS → new position audible
+    boot_to_ready        power-on → setup() returned
+
+as p50/p95/p99 over all runs, in JSON, along with the [BOOT] phase
+profile setup() prints (duration and completion time of each phase):
+
+    cd firmware && pio run -e native && cd ..
+    python3 tools/latency_bench.py -o before.json
+
+Latencies are measured from the button edge (or the long-press threshold
+for seeks) on the virtual clock to the audible onset/silence reported by
+the A2DP sink model, so gesture timing and BT latency are included. Each
+run boots once, so time_to_first_audio has --runs samples; the others
+have --runs x --cycles. See firmware/native/include/native_host.h for the
+timing models.
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_PROGRAM = os.path.join(ROOT, "firmware", ".pio", "build", "native", "program")
+CONFIG_H = os.path.join(ROOT, "firmware", "include", "config.h")
+
+# MPEG-1 Layer III, 128 kbps, 44.1 kHz, stereo: 417-byte frames of 26.1 ms
+FRAME_HEADER = bytes([0xFF, 0xFB, 0x90, 0x00])
+FRAME_BYTES = 417
+FRAME_MS = 1152 * 1000.0 / 44100
+
+TAP_MS = 80          # Short press length
+CYCLE_MS = 4000      # One next / pause / resume / seek round
+FIRST_CYCLE_MS = 3000
+MATCH_WINDOW_MS = 3000
+
+BOOT_PHASE = re.compile(r"^\[BOOT\] (\S+)\s+([\d.]+)\s+([\d.]+) ms$")
+
+METRICS = ["time_to_first_audio", "next_to_audio", "pause_to_silence",
+           "resume_to_audio", "seek_to_audio", "boot_to_ready"]
+
+
+def config_value(name, default):
+    """Integer #define from config.h (gesture timing the script depends on)."""
+    try:
+        with open(CONFIG_H) as f:
+            m = re.search(r"#define\s+%s\s+(\d+)" % name, f.read())
+            return int(m.group(1)) if m else default
+    except OSError:
+        return default
+
+
+def write_track(path, seconds):
+    frames = int(seconds * 1000 / FRAME_MS)
+    frame = FRAME_HEADER + bytes(FRAME_BYTES - len(FRAME_HEADER))
+    with open(path, "wb") as f:
+        f.write(frame * frames)
+
+
+def write_script(path, cycles, long_ms):
+    """Button script (times from ready) and the operations it performs."""
+    lines = ["0 PLAY down", "%d PLAY up" % TAP_MS]
+    ops = []
+    for c in range(cycles):
+        t = FIRST_CYCLE_MS + c * CYCLE_MS
+        lines += ["%d NEXT down" % t, "%d NEXT up" % (t + TAP_MS)]
+        ops.append(("next_to_audio", "NEXT", t, "audio"))
+        lines += ["%d PLAY down" % (t + 1000), "%d PLAY up" % (t + 1000 + TAP_MS)]
+        ops.append(("pause_to_silence", "PLAY", t + 1000, "silence"))
+        lines += ["%d PLAY down" % (t + 2000), "%d PLAY up" % (t + 2000 + TAP_MS)]
+        ops.append(("resume_to_audio", "PLAY", t + 2000, "audio"))
+        # Released before the first repeat: exactly one scan jump
+        lines += ["%d NEXT down" % (t + 3000), "%d NEXT up" % (t + 3000 + long_ms + 100)]
+        ops.append(("seek_to_audio", "NEXT", t + 3000, "audio"))
+    with open(path, "w") as f:
+        f.write("\n".join(lines) + "\n")
+    return ops, FIRST_CYCLE_MS + cycles * CYCLE_MS
+
+
+def read_timeline(path):
+    events = []
+    with open(path) as f:
+        for line in f:
+            parts = line.split()
+            if len(parts) >= 2:
+                events.append((int(parts[0]) / 1000.0, parts[1], parts[2:]))
+    events.sort(key=lambda e: e[0])
+    return events
+
+
+def first_after(events, kind, t_ms):
+    for t, name, _ in events:
+        if name == kind and t >= t_ms:
+            return t if t - t_ms <= MATCH_WINDOW_MS else None
+    return None
+
+
+def run_once(args, workdir, run, ops, run_ms, long_ms):
+    timeline = os.path.join(workdir, "timeline.txt")
+    env = dict(os.environ)
+    env.update({
+        "NATIVE_TIME_SCALE": str(args.time_scale),
+        "NATIVE_RUN_MS": str(run_ms),
+        "NATIVE_SD_ROOT": os.path.join(workdir, "sdcard"),
+        "NATIVE_NVS_DIR": os.path.join(workdir, "nvs_%d" % run),
+        "NATIVE_WAV_PATH": os.path.join(workdir, "a2dp_out.wav"),
+        "NATIVE_BUTTONS": os.path.join(workdir, "buttons.txt"),
+        "NATIVE_EVENT_LOG": timeline,
+        "NATIVE_SEED": str(args.seed + run),
+        "NATIVE_SD_MOUNT_MS": str(args.sd_mount_ms),
+        "NATIVE_SD_ACCESS_US": str(args.sd_access_us),
+        "NATIVE_SD_KBPS": str(args.sd_kbps),
+        "NATIVE_SD_JITTER_US": str(args.sd_jitter_us),
+        "NATIVE_BT_INIT_MS": str(args.bt_init_ms),
+        "NATIVE_BT_CONNECT_MS": str(args.bt_connect_ms),
+        "NATIVE_BT_LATENCY_MS": str(args.bt_latency_ms),
+        "NATIVE_BT_JITTER_MS": str(args.bt_jitter_ms),
+    })
+    log_path = os.path.join(workdir, "run_%d.log" % run)
+    with open(log_path, "w") as log:
+        subprocess.run([args.program], env=env, cwd=workdir, stdout=log,
+                       stderr=subprocess.STDOUT, check=True, timeout=600)
+
+    events = read_timeline(timeline)
+    ready = first_after(events, "ready", 0)
+    if ready is None:
+        raise RuntimeError("run %d: setup() never returned" % run)
+
+    samples = {m: [] for m in METRICS}
+    missed = {m: 0 for m in METRICS}
+    samples["boot_to_ready"].append(ready)
+    first_audio = first_after(events, "audio", ready)
+    if first_audio is None:
+        missed["time_to_first_audio"] += 1
+    else:
+        samples["time_to_first_audio"].append(first_audio)
+
+    # Press times come from the timeline (actual edge), not the script
+    downs = {}
+    for t, name, detail in events:
+        if name == "button" and len(detail) == 2 and detail[1] == "down":
+            downs.setdefault(detail[0], []).append(t)
+    for metric, button, script_ms, kind in ops:
+        pressed = [t for t in downs.get(button, []) if t >= ready + script_ms - 1]
+        if not pressed:
+            missed[metric] += 1
+            continue
+        start = pressed[0] + (long_ms if metric == "seek_to_audio" else 0)
+        end = first_after(events, kind, start)
+        if end is None:
+            missed[metric] += 1
+        else:
+            samples[metric].append(end - start)
+    return samples, missed, read_boot_phases(log_path)
+
+
+def read_boot_phases(log_path):
+    """{phase: (start_ms, end_ms)} from the [BOOT] lines of a run log."""
+    phases = {}
+    with open(log_path, errors="replace") as f:
+        for line in f:
+            m = BOOT_PHASE.match(line.strip())
+            if m:
+                phases[m.group(1)] = (float(m.group(2)), float(m.group(3)))
+    return phases
+
+
+def percentile(values, pct):
+    """Nearest-rank percentile of a sorted list."""
+    rank = max(1, -(-len(values) * pct // 100))
+    return values[int(rank) - 1]
+
+
+def summarize(values, missed):
+    values = sorted(values)
+    out = {"n": len(values), "missed": missed}
+    if values:
+        out.update({
+            "p50": round(percentile(values, 50), 1),
+            "p95": round(percentile(values, 95), 1),
+            "p99": round(percentile(values, 99), 1),
+            "max": round(values[-1], 1),
+            "mean": round(sum(values) / len(values), 1),
+        })
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--program", default=DEFAULT_PROGRAM, help="native build (default: %(default)s)")
+    parser.add_argument("-o", "--output", help="JSON report (default: stdout)")
+    parser.add_argument("--runs", type=int, default=10, help="boots (default: %(default)s)")
+    parser.add_argument("--cycles", type=int, default=4, help="operation rounds per boot (default: %(default)s)")
+    parser.add_argument("--time-scale", type=float, default=4.0,
+                        help="virtual clock speed-up; higher is faster but noisier (default: %(default)s)")
+    parser.add_argument("--seed", type=int, default=1, help="jitter seed of the first run")
+    parser.add_argument("--tracks", type=int, default=4, help="synthetic tracks on the card")
+    parser.add_argument("--sd-mount-ms", type=int, default=200, help="SD card identification and mount")
+    parser.add_argument("--sd-access-us", type=int, default=500, help="SD command latency")
+    parser.add_argument("--sd-kbps", type=int, default=1500, help="SD read throughput, KB/s")
+    parser.add_argument("--sd-jitter-us", type=int, default=1000, help="SD latency jitter")
+    parser.add_argument("--bt-init-ms", type=int, default=700, help="BT controller and stack bring-up")
+    parser.add_argument("--bt-connect-ms", type=int, default=1500, help="init() → speaker accepts audio")
+    parser.add_argument("--bt-latency-ms", type=int, default=150, help="feed → heard")
+    parser.add_argument("--bt-jitter-ms", type=int, default=40, help="BT latency jitter")
+    parser.add_argument("--keep", help="keep the work directory (card image, logs) here")
+    args = parser.parse_args()
+
+    if not os.access(args.program, os.X_OK):
+        sys.exit("%s not found; build it with `pio run -e native` in firmware/" % args.program)
+
+    long_ms = config_value("BTN_LONG_PRESS_MS", 600)
+    workdir = args.keep or tempfile.mkdtemp(prefix="latency_bench_")
+    os.makedirs(os.path.join(workdir, "sdcard"), exist_ok=True)
+    for i in range(args.tracks):
+        write_track(os.path.join(workdir, "sdcard", "track%02d.mp3" % i), 60)
+    ops, script_ms = write_script(os.path.join(workdir, "buttons.txt"), args.cycles, long_ms)
+
+    samples = {m: [] for m in METRICS}
+    missed = {m: 0 for m in METRICS}
+    boot = {}
+    try:
+        for run in range(args.runs):
+            # Boot, connect and the script, plus slack for the last operation
+            run_ms = args.bt_init_ms + 2 * args.bt_connect_ms + script_ms + 6000
+            got, lost, phases = run_once(args, workdir, run, ops, run_ms, long_ms)
+            for m in METRICS:
+                samples[m] += got[m]
+                missed[m] += lost[m]
+            for name, (start, end) in phases.items():
+                boot.setdefault(name, ([], []))
+                boot[name][0].append(end - start)
+                boot[name][1].append(end)
+            print("run %d/%d done" % (run + 1, args.runs), file=sys.stderr)
+    finally:
+        if not args.keep:
+            shutil.rmtree(workdir, ignore_errors=True)
+
+    report = {
+        "schema": 2,
+        "unit": "ms",
+        "program": os.path.relpath(args.program, ROOT),
+        "runs": args.runs,
+        "cycles": args.cycles,
+        "time_scale": args.time_scale,
+        "models": {
+            "sd": {"mount_ms": args.sd_mount_ms, "access_us": args.sd_access_us, "kbps": args.sd_kbps,
+                   "jitter_us": args.sd_jitter_us},
+            "bt": {"init_ms": args.bt_init_ms, "connect_ms": args.bt_connect_ms,
+                   "latency_ms": args.bt_latency_ms, "jitter_ms": args.bt_jitter_ms},
+        },
+        "metrics": {m: summarize(samples[m], missed[m]) for m in METRICS},
+        "boot_phases": {name: {"duration": summarize(d, args.runs - len(d)),
+                               "done_at": summarize(e, args.runs - len(e))}
+                        for name, (d, e) in boot.items()},
+    }
+    text = json.dumps(report, indent=2) + "\n"
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""
+Expand deferred binary log frames (firmware/src/log.cpp, LOG_BINARY = 1).
+
+Frames carry the address of the format string and raw 32-bit arguments;
+this tool looks both up in the firmware ELF and prints the text. Ordinary
+serial output between frames is passed through unchanged, so it works as
+a live filter:
+
+    pio device monitor --raw | python3 tools/log_expand.py .pio/build/esp32-dev/firmware.elf
+
+or on a saved capture:
+
+    python3 tools/log_expand.py firmware.elf capture.bin
+
+The ELF must be the exact build that produced the capture.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+SYNC = b"\x00\xa5L"
+HEADER = struct.Struct("<IIBBB")   # fmt address, micros, module, level, arg count
+MAX_ARGS = 8                       # sanity bound; firmware uses LOG_MAX_ARGS
+
+MODULES = ["MAIN", "AUDIO", "BT", "DISPLAY", "BUTTON", "SD", "PLAYBACK", "EVENT"]
+LEVELS = ["NONE", "E", "W", "I", "D"]
+
+SPEC = re.compile(r"%([-+ #0]*)(\d+|\*)?(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcsp%])")
+
+
+class Elf32:
+    """Loadable sections of a little-endian ELF32 image, addressable by VMA."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1:
+            raise ValueError("%s is not a 32-bit ELF file" % path)
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", self.data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            (_, sh_type, flags, addr, offset, size) = struct.unpack_from(
+                "<IIIIII", self.data, shoff + i * shentsize)
+            # PROGBITS with SHF_ALLOC: rodata, DROM, DRAM initialised data
+            if sh_type == 1 and flags & 0x2 and addr and size:
+                self.sections.append((addr, addr + size, offset))
+
+    def string(self, addr):
+        for start, end, offset in self.sections:
+            if start <= addr < end:
+                pos = offset + (addr - start)
+                stop = self.data.find(b"\x00", pos, offset + (end - start))
+                if stop < 0:
+                    stop = offset + (end - start)
+                return self.data[pos:stop].decode("utf-8", "replace")
+        return None
+
+
+def expand(elf, fmt, args):
+    args = list(args)
+
+    def one(match):
+        flags, width, precision, _, conv = match.groups()
+        if conv == "%":
+            return "%"
+        value = args.pop(0) if args else 0
+        spec = "%" + (flags or "") + (width or "") + ("." + precision if precision else "")
+        if conv in "di":
+            value = value - (1 << 32) if value & 0x80000000 else value
+            return (spec + "d") % value
+        if conv in "ouxX":
+            return (spec + conv.replace("u", "d")) % value
+        if conv == "c":
+            return (spec + "c") % chr(value & 0xFF)
+        if conv == "p":
+            return "0x%08x" % value
+        text = elf.string(value)
+        return (spec + "s") % (text if text is not None else "<0x%08x>" % value)
+
+    return SPEC.sub(one, fmt)
+
+
+def run(elf, stream, out, show_time):
+    buf = b""
+    while True:
+        chunk = stream.read1(4096) if hasattr(stream, "read1") else stream.read(4096)
+        if not chunk:
+            break
+        buf += chunk
+        while True:
+            pos = buf.find(SYNC)
+            if pos < 0:
+                # Keep a possible partial sync at the end
+                keep = 2 if buf.endswith(SYNC[:2]) else 1 if buf.endswith(SYNC[:1]) else 0
+                out.write(buf[:len(buf) - keep])
+                buf = buf[len(buf) - keep:]
+                break
+            out.write(buf[:pos])
+            buf = buf[pos:]
+
+            body = len(SYNC) + HEADER.size
+            if len(buf) < body:
+                break
+            fmt_addr, time_us, module, level, count = HEADER.unpack_from(buf, len(SYNC))
+            if count > MAX_ARGS:
+                out.write(buf[:1])   # Not a frame after all
+                buf = buf[1:]
+                continue
+            if len(buf) < body + 4 * count:
+                break
+            args = struct.unpack_from("<%dI" % count, buf, body)
+            buf = buf[body + 4 * count:]
+
+            fmt = elf.string(fmt_addr)
+            if fmt is None:
+                line = "<unknown format 0x%08x> %s" % (fmt_addr, " ".join("0x%x" % a for a in args))
+            else:
+                line = expand(elf, fmt, args)
+            if show_time:
+                tag = "%s/%s" % (LEVELS[level] if level < len(LEVELS) else level,
+                                 MODULES[module] if module < len(MODULES) else module)
+                line = "%10.6f %-10s %s" % (time_us / 1e6, tag, line)
+            out.write((line + "\n").encode("utf-8"))
+        out.flush()
+    out.write(buf)
+    out.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("elf", help="firmware.elf of the running build")
+    parser.add_argument("capture", nargs="?", help="raw capture (default: stdin)")
+    parser.add_argument("-t", "--time", action="store_true",
+                        help="prefix expanded lines with device time, level and module")
+    args = parser.parse_args()
+
+    elf = Elf32(args.elf)
+    stream = open(args.capture, "rb") if args.capture else sys.stdin.buffer
+    try:
+        run(elf, stream, sys.stdout.buffer, args.time)
+    finally:
+        if args.capture:
+            stream.close()
+
+
+if __name__ == "__main__":
+    main()
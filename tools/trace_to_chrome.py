@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""
+Convert a firmware trace dump to Chrome / Perfetto JSON.
+
+Capture the serial output while pressing 't' (TRACE_DUMP_KEY), e.g.
+
+    pio device monitor --raw | tee capture.bin
+
+then run
+
+    python3 tools/trace_to_chrome.py capture.bin trace.json
+
+and open trace.json in chrome://tracing or https://ui.perfetto.dev.
+Text log lines around the dump are skipped; the newest dump in the file
+is converted unless --index is given. See firmware/src/trace.cpp for the
+binary layout.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = b"TRC1"
+TRAILER = b"TEND"
+
+# Must match TraceEvent in firmware/include/trace.h
+EVENT_NAMES = {
+    1: "sd_read",
+    2: "decode_frame",
+    3: "feed_audio",
+    4: "display_flush",
+    5: "state_transition",
+    6: "audio_overflow",
+}
+
+# PlaybackState order in firmware/include/playback_control.h
+STATE_NAMES = ["IDLE", "LOADING", "PLAYING", "PAUSED", "ERROR"]
+
+PHASE_MASK = 0xC000
+PHASES = {0x0000: "B", 0x4000: "E", 0x8000: "i"}
+
+
+def parse_dump(data, start):
+    """Parse one dump starting at `start`; returns (cpu_hz, [records per core])."""
+    pos = start + len(MAGIC)
+    record_size, cores, cpu_hz = struct.unpack_from("<HHI", data, pos)
+    pos += 8
+    if record_size != 8:
+        raise ValueError("unsupported record size %d" % record_size)
+
+    per_core = []
+    for _ in range(cores):
+        (count,) = struct.unpack_from("<I", data, pos)
+        pos += 4
+        records = [struct.unpack_from("<IHH", data, pos + i * record_size) for i in range(count)]
+        pos += count * record_size
+        per_core.append(records)
+
+    if data[pos:pos + len(TRAILER)] != TRAILER:
+        raise ValueError("dump at offset %d is truncated or interleaved with text" % start)
+    return cpu_hz, per_core
+
+
+def unwrap(records):
+    """Extend the 32-bit cycle counter to 64 bits and sort by time.
+
+    Slot order is only nearly time order: a writer preempted between reading
+    the counter and reserving its slot lands after a later record. Each
+    record is placed by its signed 32-bit distance from the previous one, so
+    a small step back is not taken for a wrap. Gaps over 2^31 cycles (about
+    9 s at 240 MHz) without a record cannot be told apart from a wrap.
+    """
+    out = []
+    prev_low = prev = None
+    for cycles, ident, arg in records:
+        if prev is None:
+            prev = cycles
+        else:
+            delta = (cycles - prev_low) & 0xFFFFFFFF
+            if delta >= 1 << 31:
+                delta -= 1 << 32
+            prev += delta
+        prev_low = cycles
+        out.append((prev, ident, arg))
+    # Stable: records with equal timestamps keep their slot order (B before E)
+    out.sort(key=lambda r: r[0])
+    return out
+
+
+def to_chrome(cpu_hz, per_core):
+    cores = [unwrap(r) for r in per_core]
+    origin = min((c[0][0] for c in cores if c), default=0)
+    events = []
+
+    for core, records in enumerate(cores):
+        events.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": core,
+                       "args": {"name": "core %d" % core}})
+        open_spans = {}
+        for cycles, ident, arg in records:
+            event = ident & ~PHASE_MASK & 0xFFFF
+            phase = PHASES.get(ident & PHASE_MASK)
+            if phase is None:
+                continue
+
+            # An end whose begin was overwritten by the ring would make the
+            # viewer close the wrong span: drop it
+            if phase == "B":
+                open_spans[event] = open_spans.get(event, 0) + 1
+            elif phase == "E":
+                if open_spans.get(event, 0) == 0:
+                    continue
+                open_spans[event] -= 1
+
+            name = EVENT_NAMES.get(event, "event_%d" % event)
+            if event == 5 and phase == "B" and arg < len(STATE_NAMES):
+                name = "state -> %s" % STATE_NAMES[arg]
+            entry = {
+                "name": name,
+                "ph": phase,
+                "ts": (cycles - origin) * 1e6 / cpu_hz,
+                "pid": 0,
+                "tid": core,
+            }
+            if phase == "i":
+                entry["s"] = "t"
+            if phase != "E" or arg:
+                entry["args"] = {"arg": arg}
+            events.append(entry)
+
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("capture", help="raw serial capture containing a trace dump")
+    parser.add_argument("output", nargs="?", help="JSON output (default: stdout)")
+    parser.add_argument("--index", type=int, default=-1,
+                        help="which dump in the capture to convert (default: last)")
+    args = parser.parse_args()
+
+    with open(args.capture, "rb") as f:
+        data = f.read()
+
+    starts = []
+    pos = data.find(MAGIC)
+    while pos >= 0:
+        starts.append(pos)
+        pos = data.find(MAGIC, pos + 1)
+    if not starts:
+        sys.exit("no trace dump (TRC1) found in %s" % args.capture)
+
+    cpu_hz, per_core = parse_dump(data, starts[args.index])
+    trace = to_chrome(cpu_hz, per_core)
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+    counts = ", ".join("core %d: %d" % (i, len(r)) for i, r in enumerate(per_core))
+    print("%d records (%s) at %d MHz" % (sum(len(r) for r in per_core), counts, cpu_hz // 1000000),
+          file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()